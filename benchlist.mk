@@ -0,0 +1 @@
+BENCH_LIST = $(notdir $(patsubst %/rules.mk,%,$(wildcard $(ROOT_DIR)/tests/bench/*/rules.mk)))
@@ -0,0 +1,9 @@
+# Builds one benchmark suite from tests/bench/$(BENCH) for the host.
+#
+# A suite is laid out like a full keyboard test (config.h, rules.mk, keymap.c
+# and *.cpp files) and is built with the same machinery, see build_test.mk.
+TEST := bench_$(BENCH)
+TEST_PATH := tests/bench/$(BENCH)
+FULL_TESTS := $(TEST)
+
+include build_test.mk
@@ -15,7 +15,7 @@
 
 #include $(TMK_PATH)/protocol.mk
 
-TEST_PATH=tests/$(TEST)
+TEST_PATH ?= tests/$(TEST)
 
 $(TEST)_SRC= \
 	$(TEST_PATH)/keymap.c \
@@ -25,8 +25,12 @@ $(TEST)_SRC= \
 	tests/test_common/matrix.c \
 	tests/test_common/test_driver.cpp \
 	tests/test_common/keyboard_report_util.cpp \
-	tests/test_common/test_fixture.cpp
+	tests/test_common/test_fixture.cpp \
+	tests/test_common/replay.cpp
 $(TEST)_SRC += $(patsubst $(ROOTDIR)/%,%,$(wildcard $(TEST_PATH)/*.cpp))
+ifdef BENCH
+$(TEST)_SRC += tests/test_common/bench.cpp
+endif
 
 $(TEST)_DEFS=$(TMK_COMMON_DEFS) $(OPT_DEFS)
 $(TEST)_CONFIG=$(TEST_PATH)/config.h
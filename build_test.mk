@@ -8,6 +8,8 @@ include common.mk
 
 TARGET=test/$(TEST)
 
+TEST_PATH ?= tests/$(TEST)
+
 GTEST_OUTPUT = $(BUILD_DIR)/gtest
 
 TEST_OBJ = $(BUILD_DIR)/test_obj
@@ -44,13 +46,14 @@ PLATFORM:=TEST
 PLATFORM_KEY:=test
 
 ifneq ($(filter $(FULL_TESTS),$(TEST)),)
-include tests/$(TEST)/rules.mk
+include $(TEST_PATH)/rules.mk
 endif
 
 include common_features.mk
 include $(TMK_PATH)/common.mk
 include $(QUANTUM_PATH)/sequencer/tests/rules.mk
 include $(QUANTUM_PATH)/serial_link/tests/rules.mk
+include $(TMK_PATH)/protocol/arm_atsam/tests/rules.mk
 ifneq ($(filter $(FULL_TESTS),$(TEST)),)
 include build_full_test.mk
 endif
@@ -47,7 +47,15 @@ ifeq ($(strip $(AUDIO_ENABLE)), yes)
     MUSIC_ENABLE = yes
     SRC += $(QUANTUM_DIR)/process_keycode/process_audio.c
     SRC += $(QUANTUM_DIR)/process_keycode/process_clicky.c
-    SRC += $(QUANTUM_DIR)/audio/audio_$(PLATFORM_KEY).c
+    ifeq ($(strip $(AUDIO_WAVETABLE_ENABLE)), yes)
+        ifneq ($(PLATFORM),CHIBIOS)
+            $(error AUDIO_WAVETABLE_ENABLE is only supported on ChibiOS)
+        endif
+        OPT_DEFS += -DAUDIO_WAVETABLE_ENABLE
+        SRC += $(QUANTUM_DIR)/audio/audio_chibios_wavetable.c
+    else
+        SRC += $(QUANTUM_DIR)/audio/audio_$(PLATFORM_KEY).c
+    endif
     SRC += $(QUANTUM_DIR)/audio/voices.c
     SRC += $(QUANTUM_DIR)/audio/luts.c
 endif
@@ -298,7 +306,7 @@ ifeq ($(strip $(BACKLIGHT_CUSTOM_DRIVER)), yes)
     BACKLIGHT_DRIVER := custom
 endif
 
-VALID_BACKLIGHT_TYPES := pwm timer software custom
+VALID_BACKLIGHT_TYPES := pwm timer software bam custom
 
 BACKLIGHT_ENABLE ?= no
 BACKLIGHT_DRIVER ?= pwm
@@ -431,6 +439,30 @@ ifneq ($(strip $(CUSTOM_MATRIX)), yes)
     endif
 endif
 
+ifeq ($(strip $(MATRIX_THREAD_SCAN_ENABLE)), yes)
+    ifneq ($(strip $(CUSTOM_MATRIX)), no)
+        $(error MATRIX_THREAD_SCAN_ENABLE requires the standard matrix, CUSTOM_MATRIX="$(CUSTOM_MATRIX)" is not supported)
+    endif
+    ifeq ($(strip $(SPLIT_KEYBOARD)), yes)
+        $(error MATRIX_THREAD_SCAN_ENABLE is not supported on split keyboards)
+    endif
+    # On AVR the scan would run inside the 1ms timer interrupt, with its busy waits
+    ifneq ($(PLATFORM),CHIBIOS)
+        $(error MATRIX_THREAD_SCAN_ENABLE is only supported on ChibiOS)
+    endif
+    OPT_DEFS += -DMATRIX_THREAD_SCAN
+endif
+
+ifeq ($(strip $(GENERATED_MATRIX_SCANNER)), yes)
+    ifneq ($(strip $(CUSTOM_MATRIX)), no)
+        $(error GENERATED_MATRIX_SCANNER requires the standard matrix, CUSTOM_MATRIX="$(CUSTOM_MATRIX)" is not supported)
+    endif
+    ifeq ($(strip $(SPLIT_KEYBOARD)), yes)
+        $(error GENERATED_MATRIX_SCANNER is not supported on split keyboards)
+    endif
+    OPT_DEFS += -DMATRIX_SCANNER_GENERATED
+endif
+
 # Support for translating old names to new names:
 ifeq ($(strip $(DEBOUNCE_TYPE)),sym_g)
     DEBOUNCE_TYPE:=sym_defer_g
@@ -531,6 +563,10 @@ endif
 
 ifeq ($(strip $(UNICODE_COMMON)), yes)
     SRC += $(QUANTUM_DIR)/process_keycode/process_unicode_common.c
+    ifeq ($(strip $(UNICODE_BULK_ENABLE)), yes)
+        OPT_DEFS += -DUNICODE_BULK_ENABLE
+        SRC += $(QUANTUM_DIR)/process_keycode/process_unicode_bulk.c
+    endif
 endif
 
 SPACE_CADET_ENABLE ?= yes
@@ -18,6 +18,18 @@
 #include "quantum.h"
 #include "timer.h"
 
+#if SPI_USE_MUTUAL_EXCLUSION
+// The bus is held from spi_start() to spi_stop(), so the main thread and the effects thread can share it
+#    define spi_acquire() spiAcquireBus(&SPI_DRIVER)
+#    define spi_release() spiReleaseBus(&SPI_DRIVER)
+#else
+#    ifdef EFFECTS_THREAD_ENABLE
+#        error "EFFECTS_THREAD_ENABLE requires SPI_USE_MUTUAL_EXCLUSION in halconf.h"
+#    endif
+#    define spi_acquire()
+#    define spi_release()
+#endif
+
 static pin_t     currentSlavePin = NO_PIN;
 static SPIConfig spiConfig       = {false, NULL, 0, 0, 0, 0};
 
@@ -49,7 +61,7 @@ __attribute__((weak)) void spi_init(void) {
 }
 
 bool spi_start(pin_t slavePin, bool lsbFirst, uint8_t mode, uint16_t divisor) {
-    if (currentSlavePin != NO_PIN || slavePin == NO_PIN) {
+    if (slavePin == NO_PIN) {
         return false;
     }
 
@@ -62,6 +74,12 @@ bool spi_start(pin_t slavePin, bool lsbFirst, uint8_t mode, uint16_t divisor) {
         return false;
     }
 
+    spi_acquire();
+    if (currentSlavePin != NO_PIN) {
+        spi_release();
+        return false;
+    }
+
 #if defined(HT32_SPI_USE_SPI1) || defined(HT32_SPI_USE_SPI2)
     spiConfig.cr0 = SPI_CR0_SELOEN;
     spiConfig.cr1 = SPI_CR1_MODE | 8; // 8 bits and in master mode
@@ -173,5 +191,6 @@ void spi_stop(void) {
         spiUnselect(&SPI_DRIVER);
         spiStop(&SPI_DRIVER);
         currentSlavePin = NO_PIN;
+        spi_release();
     }
 }
@@ -20,8 +20,9 @@
 #include <stdio.h>
 #include <math.h>
 
-uint8_t DRV2605L_transfer_buffer[2];
-uint8_t DRV2605L_read_register;
+uint8_t        DRV2605L_transfer_buffer[2];
+uint8_t        DRV2605L_read_register;
+static uint8_t DRV2605L_sequence;
 
 void DRV_write(uint8_t drv_register, uint8_t settings) {
     DRV2605L_transfer_buffer[0] = drv_register;
@@ -102,6 +103,7 @@ void DRV_init(void) {
     DRV_write(DRV_GO, 0x00);
     DRV_write(DRV_WAVEFORM_SEQ_1, DRV_GREETING);
     DRV_write(DRV_GO, 0x01);
+    DRV2605L_sequence = DRV_GREETING;
 }
 
 void DRV_rtp_init(void) {
@@ -115,6 +117,10 @@ void DRV_amplitude(uint8_t amplitude) { DRV_write(DRV_RTP_INPUT, amplitude); }
 
 void DRV_pulse(uint8_t sequence) {
     DRV_write(DRV_GO, 0x00);
-    DRV_write(DRV_WAVEFORM_SEQ_1, sequence);
+    // Most pulses repeat the sequence already in the waveform slot
+    if (sequence != DRV2605L_sequence) {
+        DRV_write(DRV_WAVEFORM_SEQ_1, sequence);
+        DRV2605L_sequence = sequence;
+    }
     DRV_write(DRV_GO, 0x01);
 }
@@ -18,6 +18,11 @@
 #include "eeconfig.h"
 #include "progmem.h"
 #include "debug.h"
+#include "timer.h"
+#if defined(PROTOCOL_CHIBIOS) && defined(DRV2605L)
+#    include <ch.h>
+#    define HAPTIC_THREAD
+#endif
 #ifdef DRV2605L
 #    include "DRV2605L.h"
 #endif
@@ -27,6 +32,118 @@
 
 haptic_config_t haptic_config;
 
+/* Haptic event queue
+ *
+ * process_haptic() used to play feedback right away, so the DRV2605L I2C
+ * writes came before the report of the key that triggered them. Now it only
+ * queues an event. On ChibiOS with a DRV2605L the events are played by a
+ * thread of their own, woken when one is queued, so the blocking I2C writes
+ * never hold up the main loop; the I2C driver holds the bus for each transfer.
+ * Elsewhere haptic_queue_task() plays one event per call from haptic_task(),
+ * after the report has gone out. A pulse triggered within
+ * HAPTIC_COALESCE_WINDOW ms of the last one is merged into it: the extra pulse
+ * is not played, only counted.
+ */
+typedef enum {
+    HAPTIC_EVENT_PULSE,
+    HAPTIC_EVENT_AMPLITUDE,
+    HAPTIC_EVENT_CONTINUOUS_ON,
+    HAPTIC_EVENT_CONTINUOUS_OFF,
+} haptic_event_type_t;
+
+typedef struct {
+    uint8_t type;
+    uint8_t value;
+} haptic_event_t;
+
+static volatile haptic_event_t haptic_queue[HAPTIC_QUEUE_SIZE];
+static volatile uint8_t        haptic_queue_head = 0;  // only moved by the player
+static volatile uint8_t        haptic_queue_tail = 0;  // only moved by the producer
+static bool                    haptic_pulsed     = false;
+static uint16_t                haptic_pulse_timer;
+static uint16_t                haptic_coalesced  = 0;
+static uint16_t                haptic_dropped    = 0;
+
+#ifdef HAPTIC_THREAD
+#    ifndef HAPTIC_THREAD_PRIORITY
+#        define HAPTIC_THREAD_PRIORITY (NORMALPRIO + 1)
+#    endif
+
+static binary_semaphore_t haptic_wakeup;
+#endif
+
+static bool haptic_queue_push(uint8_t type, uint8_t value) {
+    uint8_t next = (haptic_queue_tail + 1) % HAPTIC_QUEUE_SIZE;
+    if (next == haptic_queue_head) {
+        haptic_dropped++;
+        dprintf("haptic queue full, dropped %u\n", haptic_dropped);
+        return false;
+    }
+
+    haptic_queue[haptic_queue_tail].type  = type;
+    haptic_queue[haptic_queue_tail].value = value;
+    haptic_queue_tail                     = next;
+#ifdef HAPTIC_THREAD
+    chBSemSignal(&haptic_wakeup);
+#endif
+    return true;
+}
+
+static void haptic_queue_play(haptic_event_t event) {
+    switch (event.type) {
+        case HAPTIC_EVENT_PULSE:
+#ifdef DRV2605L
+            DRV_pulse(event.value);
+#endif
+#ifdef SOLENOID_ENABLE
+            solenoid_fire();
+#endif
+            break;
+#ifdef DRV2605L
+        case HAPTIC_EVENT_AMPLITUDE:
+            DRV_amplitude(event.value);
+            break;
+        case HAPTIC_EVENT_CONTINUOUS_ON:
+            DRV_rtp_init();
+            break;
+        case HAPTIC_EVENT_CONTINUOUS_OFF:
+            DRV_write(DRV_MODE, 0x00);
+            break;
+#endif
+    }
+}
+
+void haptic_queue_task(void) {
+    uint8_t head = haptic_queue_head;
+    if (head == haptic_queue_tail) {
+        return;
+    }
+
+    haptic_event_t event = {.type = haptic_queue[head].type, .value = haptic_queue[head].value};
+    haptic_queue_head    = (head + 1) % HAPTIC_QUEUE_SIZE;
+    haptic_queue_play(event);
+}
+
+#ifdef HAPTIC_THREAD
+static THD_WORKING_AREA(waHapticThread, 256);
+static THD_FUNCTION(HapticThread, arg) {
+    (void)arg;
+    chRegSetThreadName("haptic");
+
+    while (true) {
+        chBSemWait(&haptic_wakeup);
+        // The I2C transfers sleep on the driver, the main thread runs meanwhile
+        while (haptic_queue_head != haptic_queue_tail) {
+            haptic_queue_task();
+        }
+    }
+}
+#endif
+
+uint16_t haptic_queue_coalesced(void) { return haptic_coalesced; }
+
+uint16_t haptic_queue_dropped(void) { return haptic_dropped; }
+
 void haptic_init(void) {
     debug_enable = 1;  // Debug is ON!
     if (!eeconfig_is_enabled()) {
@@ -54,11 +171,18 @@ void haptic_init(void) {
 #ifdef DRV2605L
     DRV_init();
     dprintf("DRV2605 driver initialized\n");
+#endif
+#ifdef HAPTIC_THREAD
+    chBSemObjectInit(&haptic_wakeup, true);
+    chThdCreateStatic(waHapticThread, sizeof(waHapticThread), HAPTIC_THREAD_PRIORITY, HapticThread, NULL);
 #endif
     eeconfig_debug_haptic();
 }
 
 void haptic_task(void) {
+#ifndef HAPTIC_THREAD
+    haptic_queue_task();
+#endif
 #ifdef SOLENOID_ENABLE
     solenoid_check();
 #endif
@@ -198,7 +322,7 @@ void haptic_set_amplitude(uint8_t amp) {
     eeconfig_update_haptic(haptic_config.raw);
     xprintf("haptic_config.amplitude = %u\n", haptic_config.amplitude);
 #ifdef DRV2605L
-    DRV_amplitude(amp);
+    haptic_queue_push(HAPTIC_EVENT_AMPLITUDE, amp);
 #endif
 }
 
@@ -240,7 +364,7 @@ void haptic_enable_continuous(void) {
     xprintf("haptic_config.cont = %u\n", haptic_config.cont);
     eeconfig_update_haptic(haptic_config.raw);
 #ifdef DRV2605L
-    DRV_rtp_init();
+    haptic_queue_push(HAPTIC_EVENT_CONTINUOUS_ON, 0);
 #endif
 }
 
@@ -249,7 +373,7 @@ void haptic_disable_continuous(void) {
     xprintf("haptic_config.cont = %u\n", haptic_config.cont);
     eeconfig_update_haptic(haptic_config.raw);
 #ifdef DRV2605L
-    DRV_write(DRV_MODE, 0x00);
+    haptic_queue_push(HAPTIC_EVENT_CONTINUOUS_OFF, 0);
 #endif
 }
 
@@ -281,14 +405,15 @@ void haptic_cont_decrease(void) {
 }
 
 void haptic_play(void) {
-#ifdef DRV2605L
-    uint8_t play_eff = 0;
-    play_eff         = haptic_config.mode;
-    DRV_pulse(play_eff);
-#endif
-#ifdef SOLENOID_ENABLE
-    solenoid_fire();
-#endif
+    if (haptic_pulsed && timer_elapsed(haptic_pulse_timer) < HAPTIC_COALESCE_WINDOW) {
+        haptic_coalesced++;
+        return;
+    }
+
+    if (haptic_queue_push(HAPTIC_EVENT_PULSE, haptic_config.mode)) {
+        haptic_pulsed      = true;
+        haptic_pulse_timer = timer_read();
+    }
 }
 
 bool process_haptic(uint16_t keycode, keyrecord_t *record) {
@@ -30,6 +30,16 @@
 #    define HAPTIC_MODE_DEFAULT DRV_MODE_DEFAULT
 #endif
 
+/* Number of haptic events that can wait to be played */
+#ifndef HAPTIC_QUEUE_SIZE
+#    define HAPTIC_QUEUE_SIZE 8
+#endif
+
+/* A pulse triggered within this many ms of the previous one is merged into it */
+#ifndef HAPTIC_COALESCE_WINDOW
+#    define HAPTIC_COALESCE_WINDOW 10
+#endif
+
 /* EEPROM config settings */
 typedef union {
     uint32_t raw;
@@ -52,9 +62,14 @@ typedef enum HAPTIC_FEEDBACK {
     HAPTIC_FEEDBACK_MAX,
 } HAPTIC_FEEDBACK;
 
+/* Pulses merged into an earlier one, and events lost to a full queue */
+uint16_t haptic_queue_coalesced(void);
+uint16_t haptic_queue_dropped(void);
+
 bool    process_haptic(uint16_t keycode, keyrecord_t *record);
 void    haptic_init(void);
 void    haptic_task(void);
+void    haptic_queue_task(void);
 void    eeconfig_debug_haptic(void);
 void    haptic_enable(void);
 void    haptic_disable(void);
@@ -19,10 +19,14 @@
 #include "solenoid.h"
 #include "haptic.h"
 
-bool     solenoid_on      = false;
-bool     solenoid_buzzing = false;
-uint16_t solenoid_start   = 0;
-uint8_t  solenoid_dwell   = SOLENOID_DEFAULT_DWELL;
+#ifdef PROTOCOL_CHIBIOS
+#    include <ch.h>
+#endif
+
+volatile bool solenoid_on      = false;
+volatile bool solenoid_buzzing = false;
+uint16_t      solenoid_start   = 0;
+uint8_t       solenoid_dwell   = SOLENOID_DEFAULT_DWELL;
 
 extern haptic_config_t haptic_config;
 
@@ -34,6 +38,71 @@ void solenoid_set_buzz(int buzz) { haptic_set_buzz(buzz); }
 
 void solenoid_set_dwell(uint8_t dwell) { solenoid_dwell = dwell; }
 
+#ifdef PROTOCOL_CHIBIOS
+/* On ChibiOS the dwell and the buzz phases are timed by a virtual timer, so a
+ * busy main loop does not stretch them. Everything below runs with the system
+ * locked. */
+static virtual_timer_t solenoid_timer;
+static uint8_t         solenoid_left;  // ms of the dwell not scheduled yet
+
+static void solenoid_timer_cb(void *arg);
+
+static void solenoid_schedule(uint8_t phase) {
+    if (phase > solenoid_left) {
+        phase = solenoid_left;
+    }
+    solenoid_left -= phase;
+    chVTSetI(&solenoid_timer, TIME_MS2I(phase), solenoid_timer_cb, NULL);
+}
+
+static void solenoid_stop_locked(void) {
+    chVTResetI(&solenoid_timer);
+    writePinLow(SOLENOID_PIN);
+    solenoid_on      = false;
+    solenoid_buzzing = false;
+}
+
+static void solenoid_timer_cb(void *arg) {
+    (void)arg;
+
+    chSysLockFromISR();
+    if (solenoid_left == 0) {
+        solenoid_stop_locked();
+    } else if (solenoid_buzzing) {
+        solenoid_buzzing = false;
+        writePinLow(SOLENOID_PIN);
+        solenoid_schedule(SOLENOID_BUZZ_NONACTUATED);
+    } else {
+        solenoid_buzzing = true;
+        writePinHigh(SOLENOID_PIN);
+        solenoid_schedule(SOLENOID_BUZZ_ACTUATED);
+    }
+    chSysUnlockFromISR();
+}
+
+void solenoid_stop(void) {
+    chSysLock();
+    solenoid_stop_locked();
+    chSysUnlock();
+}
+
+void solenoid_fire(void) {
+    chSysLock();
+    if ((!haptic_config.buzz && solenoid_on) || (haptic_config.buzz && solenoid_buzzing)) {
+        chSysUnlock();
+        return;
+    }
+
+    solenoid_on      = true;
+    solenoid_buzzing = true;
+    solenoid_left    = solenoid_dwell + 1;
+    writePinHigh(SOLENOID_PIN);
+    solenoid_schedule(haptic_config.buzz ? SOLENOID_BUZZ_ACTUATED : solenoid_left);
+    chSysUnlock();
+}
+
+void solenoid_check(void) {}
+#else
 void solenoid_stop(void) {
     writePinLow(SOLENOID_PIN);
     solenoid_on      = false;
@@ -78,10 +147,11 @@ void solenoid_check(void) {
         }
     }
 }
+#endif
 
 void solenoid_setup(void) {
     setPinOutput(SOLENOID_PIN);
     solenoid_fire();
 }
 
-void solenoid_shutdown(void) { writePinLow(SOLENOID_PIN); }
+void solenoid_shutdown(void) { solenoid_stop(); }
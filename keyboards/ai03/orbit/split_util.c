@@ -22,7 +22,7 @@ bool is_keyboard_left(void) {
     return readPin(SPLIT_HAND_PIN);
   #else
     #ifdef EE_HANDS
-      return eeprom_read_byte(EECONFIG_HANDEDNESS);
+      return eeconfig_read_byte(EECONFIG_HANDEDNESS);
     #else
       #ifdef MASTER_RIGHT
         return !is_keyboard_master();
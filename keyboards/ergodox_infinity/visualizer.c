@@ -80,6 +80,7 @@ static keyframe_animation_t one_led_color = {
     .loop = false,
     .frame_lengths = {gfxMillisecondsToTicks(0)},
     .frame_functions = {lcd_backlight_keyframe_set_color},
+    .surfaces = VISUALIZER_SURFACE_LCD_BACKLIGHT,
 };
 
 bool swap_led_target_color(keyframe_animation_t* animation, visualizer_state_t* state) {
@@ -95,6 +96,7 @@ static keyframe_animation_t two_led_colors = {
     .loop = true,
     .frame_lengths = {gfxMillisecondsToTicks(1000), gfxMillisecondsToTicks(0)},
     .frame_functions = {lcd_backlight_keyframe_set_color, swap_led_target_color},
+    .surfaces = VISUALIZER_SURFACE_LCD_BACKLIGHT,
 };
 
 // The LCD animation alternates between the layer name display and a
@@ -104,6 +106,7 @@ static keyframe_animation_t lcd_bitmap_animation = {
     .loop = false,
     .frame_lengths = {gfxMillisecondsToTicks(0)},
     .frame_functions = {lcd_keyframe_display_layer_bitmap},
+    .surfaces = VISUALIZER_SURFACE_LCD,
 };
 
 static keyframe_animation_t lcd_bitmap_leds_animation = {
@@ -111,6 +114,7 @@ static keyframe_animation_t lcd_bitmap_leds_animation = {
     .loop = true,
     .frame_lengths = {gfxMillisecondsToTicks(2000), gfxMillisecondsToTicks(2000)},
     .frame_functions = {lcd_keyframe_display_layer_bitmap, lcd_keyframe_display_led_states},
+    .surfaces = VISUALIZER_SURFACE_LCD,
 };
 
 void initialize_user_visualizer(visualizer_state_t* state) {
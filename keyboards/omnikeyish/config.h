@@ -58,5 +58,6 @@
 #define DYNAMIC_MACRO_COUNT 12
 #define DYNAMIC_MACRO_SIZE 48
 #define DYNAMIC_MACRO_EEPROM_STORAGE
-#define DYNAMIC_MACRO_EEPROM_MAGIC_ADDR (uint16_t*)32
-#define DYNAMIC_MACRO_EEPROM_BLOCK0_ADDR (uint8_t*)34
+// Stored right after the EECONFIG_* block
+#define DYNAMIC_MACRO_EEPROM_MAGIC_ADDR (uint16_t*)EECONFIG_SIZE
+#define DYNAMIC_MACRO_EEPROM_BLOCK0_ADDR (uint8_t*)(EECONFIG_SIZE + 2)
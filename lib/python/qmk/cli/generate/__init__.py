@@ -1,3 +1,4 @@
 from . import api
 from . import docs
+from . import matrix_scanner
 from . import rgb_breathe_table
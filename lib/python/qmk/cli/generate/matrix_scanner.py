@@ -0,0 +1,177 @@
+"""Generate matrix_scanner.h, a port-grouped column reader for quantum/matrix.c
+"""
+import re
+
+from milc import cli
+
+from qmk.decorators import automagic_keyboard
+from qmk.info import info_json
+import qmk.path
+
+PIN_RE = re.compile(r'^([A-K])(\d{1,2})$')
+
+READ_PORT = {
+    'avr': ('uint8_t', 'PINx_ADDRESS(pin)'),
+    'arm': ('uint32_t', 'palReadPort(PAL_PORT(pin))'),
+}
+
+
+def parse_pin(pin, processor_type):
+    """Split a pin name such as `B5` into its port letter and bit number.
+    """
+    match = PIN_RE.match(pin.strip())
+    if not match:
+        raise ValueError('%s is not a plain port pin' % pin)
+
+    port, bit = match.group(1), int(match.group(2))
+    if bit > (7 if processor_type == 'avr' else 15):
+        raise ValueError('%s is out of range for a %s port' % (pin, processor_type.upper()))
+
+    return port, bit
+
+
+def group_pins(col_pins, processor_type):
+    """Group the column pins by port.
+
+    Returns a dict of port letter -> (first pin on that port, list of (bit, col) sorted by bit).
+    """
+    ports = {}
+    for col, pin in enumerate(col_pins):
+        port, bit = parse_pin(pin, processor_type)
+        ports.setdefault(port, (pin.strip(), []))[1].append((bit, col))
+
+    for port in ports.values():
+        port[1].sort()
+
+    return dict(sorted(ports.items()))
+
+
+def bit_runs(bits):
+    """Merge (bit, col) pairs where consecutive port bits map to consecutive columns.
+
+    Returns a list of (first bit, first col, length).
+    """
+    runs = []
+    for bit, col in bits:
+        if runs and bit == runs[-1][0] + runs[-1][2] and col == runs[-1][1] + runs[-1][2]:
+            runs[-1][2] += 1
+        else:
+            runs.append([bit, col, 1])
+
+    return [tuple(run) for run in runs]
+
+
+def run_expression(variable, bit, col, length):
+    """Render the C expression that moves a run of port bits into place.
+    """
+    value = variable if bit == 0 else '(%s >> %d)' % (variable, bit)
+    value = '(matrix_row_t)(%s & 0x%X)' % (value, (1 << length) - 1)
+
+    return value if col == 0 else '(%s << %d)' % (value, col)
+
+
+def render_matrix_scanner(keyboard, col_pins, processor_type):
+    """Render matrix_scanner.h for the given column pins.
+    """
+    if processor_type not in READ_PORT:
+        raise ValueError('Unsupported processor type: %s' % processor_type)
+
+    port_type, read_port = READ_PORT[processor_type]
+    ports = group_pins(col_pins, processor_type)
+
+    reads = []
+    lines = []
+    for port, (first_pin, bits) in ports.items():
+        variable = 'port_' + port.lower()
+        runs = bit_runs(bits)
+        reads.append('    %s %s = ~MATRIX_SCANNER_READ_PORT(%s);' % (port_type, variable, first_pin))
+        for bit, col, length in runs:
+            if length == 1:
+                comment = '%s%d -> col %d' % (port, bit, col)
+            else:
+                comment = '%s%d..%s%d -> cols %d..%d' % (port, bit, port, bit + length - 1, col, col + length - 1)
+            lines.append('    cols |= %s;  // %s' % (run_expression(variable, bit, col, length), comment))
+
+    summary = cost_summary(col_pins, ports)
+
+    return '''/* Generated by `qmk generate-matrix-scanner -kb %s`, do not edit.
+ *
+ * Reads every column GPIO port once per row instead of reading MATRIX_COLS pins one
+ * by one. Enable it with `GENERATED_MATRIX_SCANNER = yes` in rules.mk.
+ *
+%s
+ */
+#pragma once
+
+// clang-format off
+
+#define MATRIX_SCANNER_READ_PORT(pin) %s
+
+_Static_assert(MATRIX_COLS == %d, "matrix_scanner.h is out of date, regenerate it");
+
+static inline matrix_row_t matrix_scanner_read_cols(void) {
+%s
+    matrix_row_t cols = 0;
+%s
+    return cols;
+}
+''' % (keyboard, '\n'.join(' * ' + line for line in summary), read_port, len(col_pins), '\n'.join(reads), '\n'.join(lines))
+
+
+def cost_summary(col_pins, ports):
+    """Describe the work done per row by the generic and the generated scanner.
+    """
+    runs = sum(len(bit_runs(bits)) for _, bits in ports.values())
+
+    return [
+        'Generic scanner:   %d pin reads per row' % len(col_pins),
+        'Generated scanner: %d port reads and %d bit-field moves per row' % (len(ports), runs),
+    ]
+
+
+@cli.argument('-kb', '--keyboard', help='Keyboard to generate the scanner for.')
+@cli.argument('-o', '--output', arg_only=True, type=qmk.path.normpath, help='File to write to')
+@cli.argument('-q', '--quiet', arg_only=True, action='store_true', help='Quiet mode, only output error messages')
+@cli.subcommand('Generates a port-grouped matrix scanner header.')
+@automagic_keyboard
+def generate_matrix_scanner(cli):
+    """Generate a matrix_scanner.h that reads the matrix columns one GPIO port at a time.
+    """
+    if not cli.config.generate_matrix_scanner.keyboard:
+        cli.log.error('Missing parameter: --keyboard')
+        return False
+
+    keyboard = cli.config.generate_matrix_scanner.keyboard
+    kb_info_json = info_json(keyboard)
+    matrix_pins = kb_info_json.get('matrix_pins', {})
+
+    if 'direct' in matrix_pins:
+        cli.log.error('%s uses DIRECT_PINS, which the generated scanner does not support.', keyboard)
+        return False
+
+    if kb_info_json.get('diode_direction') != 'COL2ROW':
+        cli.log.error('%s: only COL2ROW matrices are supported, DIODE_DIRECTION is %s.', keyboard, kb_info_json.get('diode_direction'))
+        return False
+
+    if 'cols' not in matrix_pins:
+        cli.log.error('%s: could not find MATRIX_COL_PINS.', keyboard)
+        return False
+
+    try:
+        header = render_matrix_scanner(keyboard, matrix_pins['cols'], kb_info_json.get('processor_type'))
+    except ValueError as e:
+        cli.log.error('%s: %s', keyboard, e)
+        return False
+
+    if cli.args.output:
+        cli.args.output.parent.mkdir(parents=True, exist_ok=True)
+        if cli.args.output.exists():
+            cli.args.output.replace(cli.args.output.name + '.bak')
+        cli.args.output.write_text(header)
+
+        if not cli.args.quiet:
+            cli.log.info('Wrote header to %s.', cli.args.output)
+            for line in cost_summary(matrix_pins['cols'], group_pins(matrix_pins['cols'], kb_info_json['processor_type'])):
+                cli.log.info(line)
+    else:
+        print(header)
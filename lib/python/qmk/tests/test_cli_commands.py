@@ -225,6 +225,13 @@ def test_clean():
     assert result.stdout.count('done') == 2
 
 
+def test_generate_matrix_scanner():
+    result = check_subcommand('generate-matrix-scanner', '-kb', 'handwired/pytest/basic')
+    check_returncode(result)
+    assert '~MATRIX_SCANNER_READ_PORT(F4)' in result.stdout
+    assert 'cols |= (matrix_row_t)((port_f >> 4) & 0x1);  // F4 -> col 0' in result.stdout
+
+
 def test_generate_rgb_breathe_table():
     result = check_subcommand("generate-rgb-breathe-table", "-c", "1.2", "-m", "127")
     check_returncode(result)
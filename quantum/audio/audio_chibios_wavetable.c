@@ -0,0 +1,680 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Wavetable audio engine for ChibiOS.
+ *
+ * Instead of retuning the DAC trigger timers from a float heavy timer callback,
+ * GPT6 triggers both DAC channels at a fixed AUDIO_SAMPLE_RATE and DMA streams a
+ * circular sample buffer into them. The DAC end callback refills one half of the
+ * buffer while the other half plays, mixing the active voices with 32-bit phase
+ * accumulators and integer math only. Glissando, vibrato, envelopes and song
+ * sequencing run once per control tick on a separate thread, with glide and
+ * vibrato set up as Q16 factors when a note starts.
+ */
+
+#include "audio.h"
+#include <ch.h>
+#include <hal.h>
+
+#include <math.h>
+#include <string.h>
+#include "print.h"
+#include "keymap.h"
+#include "wave.h"
+
+#include "eeconfig.h"
+
+/* DAC output rate in Hz */
+#ifndef AUDIO_SAMPLE_RATE
+#    define AUDIO_SAMPLE_RATE 16000
+#endif
+
+/* Samples in the circular DMA buffer; each half is refilled in one callback */
+#ifndef AUDIO_BUFFER_SIZE
+#    define AUDIO_BUFFER_SIZE 256
+#endif
+
+/* Number of held notes mixed together, newest first */
+#ifndef AUDIO_MIX_VOICES
+#    define AUDIO_MIX_VOICES 2
+#endif
+
+/* Length of one control tick, in us: one song position (1/8 of a 64th note at
+ * TEMPO_DEFAULT) and one step of the voice envelope, glide and vibrato */
+#ifndef AUDIO_SONG_TICK_US
+#    define AUDIO_SONG_TICK_US 16000
+#endif
+
+#ifndef AUDIO_CONTROL_THREAD_PRIORITY
+#    define AUDIO_CONTROL_THREAD_PRIORITY (NORMALPRIO + 1)
+#endif
+
+#ifndef AUDIO_CONTROL_THREAD_STACK_SIZE
+#    define AUDIO_CONTROL_THREAD_STACK_SIZE 512
+#endif
+
+#ifndef AUDIO_GPT_FREQUENCY
+#    define AUDIO_GPT_FREQUENCY 1000000
+#endif
+
+#ifndef AUDIO_DAC_SAMPLE_MAX
+#    define AUDIO_DAC_SAMPLE_MAX 4095U
+#endif
+
+_Static_assert(AUDIO_BUFFER_SIZE % 2 == 0, "AUDIO_BUFFER_SIZE must be even");
+_Static_assert(SINE_LENGTH == 2048, "wavetable index shift assumes 2048 entries");
+
+#define AUDIO_CONTROL_PERIOD_US ((uint32_t)(AUDIO_BUFFER_SIZE / 2) * 1000000UL / AUDIO_SAMPLE_RATE)
+#define AUDIO_DAC_MID (AUDIO_DAC_SAMPLE_MAX / 2)
+#define AUDIO_VOICE_AMPLITUDE (AUDIO_DAC_MID / AUDIO_MIX_VOICES)
+#define AUDIO_PHASE_PER_HZ (4294967296.0f / AUDIO_SAMPLE_RATE)
+// half a cycle per sample, the highest frequency the sample rate can carry
+#define AUDIO_STEP_NYQUIST 0x80000000UL
+// top 11 bits of the phase index the 2048 entry table
+#define AUDIO_WAVETABLE_SHIFT 21
+
+// -----------------------------------------------------------------------------
+
+typedef struct {
+    uint32_t phase;
+    uint32_t step;  // phase increment per sample, 0 when silent
+    uint16_t duty;  // square wave high time, out of 65536
+} oscillator_t;
+
+/* Pitch state of a voice, set up by voice_start() when its note changes so
+ * that each control tick only does integer math on the phase step */
+typedef struct {
+    float    target;       // note frequency in Hz, 0 when idle
+    uint32_t base_step;    // phase step before vibrato and envelope
+    uint32_t target_step;  // phase step of the note
+    uint32_t glide_ratio;  // Q16 factor applied to base_step per tick while gliding
+    uint16_t glide_ticks;  // ticks left until base_step reaches target_step
+#ifdef VIBRATO_ENABLE
+    uint32_t vibrato_index;  // Q16 position in vibrato_q16
+    uint32_t vibrato_speed;  // Q16 advance per tick
+#endif
+} voice_t;
+
+static oscillator_t oscillators[AUDIO_MIX_VOICES];
+static voice_t      voice_state[AUDIO_MIX_VOICES];
+
+static dacsample_t sample_buffer[AUDIO_BUFFER_SIZE];
+static dacsample_t sample_buffer_inv[AUDIO_BUFFER_SIZE];
+
+static int   voices      = 0;
+static int   voice_place = 0;
+static float frequencies[8];
+static int   volumes[8];
+static float place = 0;
+
+static bool     playing_notes  = false;
+static bool     playing_note   = false;
+static float    note_frequency = 0;
+static float    note_length    = 0;
+static uint8_t  note_tempo     = TEMPO_DEFAULT;
+float           note_timbre    = TIMBRE_DEFAULT;
+static uint16_t note_position  = 0;
+static float (*notes_pointer)[][2];
+static uint16_t notes_count;
+static bool     notes_repeat;
+static bool     note_resting = false;
+static uint16_t current_note = 0;
+
+#ifdef VIBRATO_ENABLE
+static float    vibrato_strength = .5;
+static float    vibrato_rate     = 0.125;
+static uint32_t vibrato_q16[VIBRATO_LUT_LENGTH];  // vibrato_lut raised to vibrato_strength
+#endif
+
+float polyphony_rate = 0;
+
+static bool audio_initialized = false;
+
+audio_config_t audio_config;
+
+uint16_t envelope_index = 0;
+bool     glissando      = true;
+
+#ifndef STARTUP_SONG
+#    define STARTUP_SONG SONG(STARTUP_SOUND)
+#endif
+float startup_song[][2] = STARTUP_SONG;
+
+// Frequencies at or above AUDIO_SAMPLE_RATE would not fit the 32 bit step, they
+// are clamped to the Nyquist frequency instead of wrapping around
+static inline uint32_t hz_to_step(float freq) {
+    if (!(freq > 0)) {
+        return 0;
+    }
+    if (freq >= AUDIO_SAMPLE_RATE / 2) {
+        return AUDIO_STEP_NYQUIST;
+    }
+    return (uint32_t)(freq * AUDIO_PHASE_PER_HZ);
+}
+
+static inline float step_to_hz(uint32_t step) { return step / AUDIO_PHASE_PER_HZ; }
+
+static inline uint32_t scale_q16(uint32_t step, uint32_t factor) {
+    uint64_t scaled = ((uint64_t)step * factor) >> 16;
+    return scaled < AUDIO_STEP_NYQUIST ? (uint32_t)scaled : AUDIO_STEP_NYQUIST;
+}
+
+#ifdef VIBRATO_ENABLE
+static void vibrato_update_table(void) {
+    for (uint8_t i = 0; i < VIBRATO_LUT_LENGTH; i++) {
+#    ifdef VIBRATO_STRENGTH_ENABLE
+        vibrato_q16[i] = (uint32_t)(pow(vibrato_lut[i], vibrato_strength) * 65536.0f);
+#    else
+        vibrato_q16[i] = (uint32_t)(vibrato_lut[i] * 65536.0f);
+#    endif
+    }
+}
+#endif
+
+static void voice_stop(voice_t *voice) {
+    voice->target      = 0;
+    voice->base_step   = 0;
+    voice->glide_ticks = 0;
+}
+
+/* Retunes a voice to a new note. With glide, the pitch moves from the current
+ * one by a quarter tone (measured at the starting pitch) per tick, and snaps to
+ * the note once it is within a quarter tone of it. */
+static void voice_start(voice_t *voice, float target, bool glide) {
+    voice->target      = target;
+    voice->target_step = hz_to_step(target);
+    voice->glide_ticks = 0;
+
+    float current = step_to_hz(voice->base_step);
+    if (glide && current > 0) {
+        float ratio = pow(2, (current < target ? 440 : -440) / current / 12 / 2);
+        float near  = target * pow(2, (current < target ? -440 : 440) / target / 12 / 2);
+        while ((current < target ? current < near : current > near) && voice->glide_ticks < UINT16_MAX) {
+            current *= ratio;
+            voice->glide_ticks++;
+        }
+        voice->glide_ratio = (uint32_t)(ratio * 65536.0f);
+    }
+    if (!voice->glide_ticks) {
+        voice->base_step = voice->target_step;
+    }
+
+#ifdef VIBRATO_ENABLE
+    voice->vibrato_index = 0;
+    voice->vibrato_speed = (uint32_t)(vibrato_rate * (1.0f + 440.0f / target) * 65536.0f);
+#endif
+}
+
+// Phase step of a voice for this tick, integer math only
+static uint32_t voice_tick(voice_t *voice) {
+    if (voice->glide_ticks) {
+        voice->base_step = --voice->glide_ticks ? scale_q16(voice->base_step, voice->glide_ratio) : voice->target_step;
+    }
+    uint32_t step = voice->base_step;
+
+#ifdef VIBRATO_ENABLE
+    if (vibrato_strength > 0) {
+        step = scale_q16(step, vibrato_q16[voice->vibrato_index >> 16]);
+        voice->vibrato_index += voice->vibrato_speed;
+        if (voice->vibrato_index >= ((uint32_t)VIBRATO_LUT_LENGTH << 16)) {
+            voice->vibrato_index -= (uint32_t)VIBRATO_LUT_LENGTH << 16;
+        }
+    }
+#endif
+    return step;
+}
+
+// Applies the voice envelope, which may change the timbre and the pitch
+static void oscillator_set(oscillator_t *osc, uint32_t step) {
+    float freq      = step_to_hz(step);
+    float enveloped = voice_envelope(freq);
+    if (enveloped != freq) {
+        step = hz_to_step(enveloped);
+    }
+    osc->duty = (uint16_t)(note_timbre * 65535.0f);
+    osc->step = step;
+}
+
+static void oscillators_silence(uint8_t from) {
+    for (uint8_t i = from; i < AUDIO_MIX_VOICES; i++) {
+        oscillators[i].step = 0;
+        voice_stop(&voice_state[i]);
+    }
+}
+
+static void voice_play(uint8_t i, float target, bool glide) {
+    if (voice_state[i].target != target) {
+        voice_start(&voice_state[i], target, glide);
+    }
+    oscillator_set(&oscillators[i], voice_tick(&voice_state[i]));
+}
+
+// Advance the song by one position
+static void audio_song_tick(void) {
+    note_position++;
+    bool end_of_note;
+    if (note_frequency > 0 && !note_resting) {
+        end_of_note = (note_position >= (note_length * 8 - 1));
+    } else {
+        end_of_note = (note_position >= (note_length * 8));
+    }
+
+    if (!end_of_note) {
+        return;
+    }
+
+    current_note++;
+    if (current_note >= notes_count) {
+        if (notes_repeat) {
+            current_note = 0;
+        } else {
+            oscillators_silence(0);
+            playing_notes = false;
+            return;
+        }
+    }
+    if (!note_resting) {
+        // short rest between notes, silent only if the next note repeats this one
+        uint16_t next  = current_note;
+        note_resting   = true;
+        current_note   = current_note ? current_note - 1 : notes_count - 1;
+        note_frequency = ((*notes_pointer)[current_note][0] == (*notes_pointer)[next][0]) ? 0 : (*notes_pointer)[current_note][0];
+        note_length    = 1;
+    } else {
+        note_resting   = false;
+        envelope_index = 0;
+        note_frequency = (*notes_pointer)[current_note][0];
+        note_length    = ((*notes_pointer)[current_note][1] / 4) * (((float)note_tempo) / 100);
+    }
+    note_position = 0;
+}
+
+/* Runs once per AUDIO_SONG_TICK_US on the audio control thread. As with the
+ * timer driven driver, one tick is one song position and one envelope step, so
+ * voice envelopes and note lengths keep their timing. */
+static void audio_control_tick(void) {
+    if (!audio_config.enable) {
+        playing_notes = false;
+        playing_note  = false;
+    }
+
+    if (playing_note && voices > 0) {
+        if (envelope_index < 65535) {
+            envelope_index++;
+        }
+
+        if (polyphony_rate > 0 && voices > 1) {
+            // arpeggiate through the held notes on a single oscillator
+            voice_place %= voices;
+            if (place++ > (frequencies[voice_place] / polyphony_rate)) {
+                voice_place = (voice_place + 1) % voices;
+                place       = 0.0;
+            }
+            voice_play(0, frequencies[voice_place], false);
+            oscillators_silence(1);
+        } else {
+            for (uint8_t i = 0; i < AUDIO_MIX_VOICES; i++) {
+                if (i >= voices) {
+                    oscillators_silence(i);
+                    break;
+                }
+                voice_play(i, frequencies[voices - 1 - i], glissando);
+            }
+        }
+    } else if (playing_notes) {
+        if (note_frequency > 0) {
+            if (envelope_index < 65535) {
+                envelope_index++;
+            }
+            voice_play(0, note_frequency, false);
+        } else {
+            oscillators[0].step = 0;
+            voice_stop(&voice_state[0]);
+        }
+        oscillators_silence(1);
+
+        audio_song_tick();
+    } else {
+        oscillators_silence(0);
+    }
+}
+
+// Mix the active oscillators into n samples; DAC2 gets the inverted signal
+static void audio_fill(dacsample_t *out, dacsample_t *out_inv, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        int32_t mix = 0;
+        for (uint8_t v = 0; v < AUDIO_MIX_VOICES; v++) {
+            oscillator_t *osc = &oscillators[v];
+            if (!osc->step) {
+                continue;
+            }
+            osc->phase += osc->step;
+#ifdef AUDIO_WAVETABLE_SINE
+            mix += (int16_t)pgm_read_byte(&sinewave[osc->phase >> AUDIO_WAVETABLE_SHIFT]) - 128;
+#else
+            mix += (osc->phase >> 16) < osc->duty ? 127 : -128;
+#endif
+        }
+        dacsample_t sample = AUDIO_DAC_MID + (mix * (int32_t)AUDIO_VOICE_AMPLITUDE) / 128;
+        out[i]             = sample;
+        out_inv[i]         = AUDIO_DAC_SAMPLE_MAX - sample;
+    }
+}
+
+/* Control ticks run on their own thread: voice envelopes are user code working
+ * in floating point, which has no place in the DAC interrupt. The callback only
+ * mixes samples and counts the ticks that are due. */
+static BSEMAPHORE_DECL(control_sem, true);
+static uint8_t  control_ticks = 0;
+static uint32_t control_time  = 0;
+
+static THD_WORKING_AREA(waAudioControlThread, AUDIO_CONTROL_THREAD_STACK_SIZE);
+static THD_FUNCTION(AudioControlThread, arg) {
+    (void)arg;
+    chRegSetThreadName("audio");
+
+    while (true) {
+        chBSemWait(&control_sem);
+
+        chSysLock();
+        uint8_t ticks = control_ticks;
+        control_ticks = 0;
+        chSysUnlock();
+
+        while (ticks--) {
+            audio_control_tick();
+        }
+    }
+}
+
+/*
+ * DAC streaming callback, called at the half and at the end of the buffer.
+ */
+static void audio_dac_cb(DACDriver *dacp) {
+    size_t offset = dacIsBufferComplete(dacp) ? AUDIO_BUFFER_SIZE / 2 : 0;
+
+    audio_fill(&sample_buffer[offset], &sample_buffer_inv[offset], AUDIO_BUFFER_SIZE / 2);
+
+    control_time += AUDIO_CONTROL_PERIOD_US;
+    if (control_time >= AUDIO_SONG_TICK_US) {
+        control_time -= AUDIO_SONG_TICK_US;
+        chSysLockFromISR();
+        if (control_ticks < UINT8_MAX) {
+            control_ticks++;
+        }
+        chBSemSignalI(&control_sem);
+        chSysUnlockFromISR();
+    }
+}
+
+/*
+ * DAC error callback.
+ */
+static void audio_dac_error_cb(DACDriver *dacp, dacerror_t err) {
+    (void)dacp;
+    (void)err;
+
+    chSysHalt("DAC failure");
+}
+
+static const GPTConfig gpt6cfg = {.frequency = AUDIO_GPT_FREQUENCY,
+                                  .callback  = NULL,
+                                  .cr2       = TIM_CR2_MMS_1, /* MMS = 010 = TRGO on Update Event.    */
+                                  .dier      = 0U};
+
+static const DACConfig dac_cfg = {.init = AUDIO_DAC_MID, .datamode = DAC_DHRM_12BIT_RIGHT};
+
+static const DACConversionGroup dac_grp1 = {.num_channels = 1U, .end_cb = audio_dac_cb, .error_cb = audio_dac_error_cb, .trigger = DAC_TRG(0)};
+
+static const DACConversionGroup dac_grp2 = {.num_channels = 1U, .end_cb = NULL, .error_cb = audio_dac_error_cb, .trigger = DAC_TRG(0)};
+
+void audio_init() {
+    if (audio_initialized) {
+        return;
+    }
+
+// Check EEPROM
+#ifdef EEPROM_ENABLE
+    if (!eeconfig_is_enabled()) {
+        eeconfig_init();
+    }
+    audio_config.raw = eeconfig_read_audio();
+#else  // ARM EEPROM
+    audio_config.enable        = true;
+#    ifdef AUDIO_CLICKY_ON
+    audio_config.clicky_enable = true;
+#    endif
+#endif  // ARM EEPROM
+
+    for (size_t i = 0; i < AUDIO_BUFFER_SIZE; i++) {
+        sample_buffer[i]     = AUDIO_DAC_MID;
+        sample_buffer_inv[i] = AUDIO_DAC_MID;
+    }
+
+    palSetPadMode(GPIOA, 4, PAL_MODE_INPUT_ANALOG);
+    palSetPadMode(GPIOA, 5, PAL_MODE_INPUT_ANALOG);
+    dacStart(&DACD1, &dac_cfg);
+    dacStart(&DACD2, &dac_cfg);
+
+    /*
+     * Both channels stream continuously; GPT6 paces them at the sample rate.
+     */
+#ifdef VIBRATO_ENABLE
+    vibrato_update_table();
+#endif
+    chThdCreateStatic(waAudioControlThread, sizeof(waAudioControlThread), AUDIO_CONTROL_THREAD_PRIORITY, AudioControlThread, NULL);
+
+    dacStartConversion(&DACD1, &dac_grp1, sample_buffer, AUDIO_BUFFER_SIZE);
+    dacStartConversion(&DACD2, &dac_grp2, sample_buffer_inv, AUDIO_BUFFER_SIZE);
+    gptStart(&GPTD6, &gpt6cfg);
+    gptStartContinuous(&GPTD6, AUDIO_GPT_FREQUENCY / AUDIO_SAMPLE_RATE);
+
+    audio_initialized = true;
+
+    if (audio_config.enable) {
+        PLAY_SONG(startup_song);
+    } else {
+        stop_all_notes();
+    }
+}
+
+void stop_all_notes() {
+    dprintf("audio stop all notes");
+
+    if (!audio_initialized) {
+        audio_init();
+    }
+
+    chSysLock();
+    voices        = 0;
+    playing_notes = false;
+    playing_note  = false;
+    for (uint8_t i = 0; i < 8; i++) {
+        frequencies[i] = 0;
+        volumes[i]     = 0;
+    }
+    oscillators_silence(0);
+    chSysUnlock();
+}
+
+void stop_note(float freq) {
+    dprintf("audio stop note freq=%d", (int)freq);
+
+    if (!playing_note) {
+        return;
+    }
+    if (!audio_initialized) {
+        audio_init();
+    }
+
+    chSysLock();
+    for (int i = 7; i >= 0; i--) {
+        if (frequencies[i] == freq) {
+            for (int j = i; j < 7; j++) {
+                frequencies[j] = frequencies[j + 1];
+                volumes[j]     = volumes[j + 1];
+            }
+            frequencies[7] = 0;
+            volumes[7]     = 0;
+            break;
+        }
+    }
+    voices--;
+    if (voices < 0) {
+        voices = 0;
+    }
+    if (voice_place >= voices) {
+        voice_place = 0;
+    }
+    if (voices == 0) {
+        playing_note = false;
+        oscillators_silence(0);
+    }
+    chSysUnlock();
+}
+
+void play_note(float freq, int vol) {
+    dprintf("audio play note freq=%d vol=%d", (int)freq, vol);
+
+    if (!audio_initialized) {
+        audio_init();
+    }
+
+    if (audio_config.enable && voices < 8) {
+        // Cancel notes if notes are playing
+        if (playing_notes) {
+            stop_all_notes();
+        }
+
+        chSysLock();
+        playing_note   = true;
+        envelope_index = 0;
+        if (freq > 0) {
+            frequencies[voices] = freq;
+            volumes[voices]     = vol;
+            voices++;
+        }
+        chSysUnlock();
+    }
+}
+
+void play_notes(float (*np)[][2], uint16_t n_count, bool n_repeat) {
+    if (!audio_initialized) {
+        audio_init();
+    }
+
+    if (audio_config.enable) {
+        // Cancel note if a note is playing
+        if (playing_note) {
+            stop_all_notes();
+        }
+
+        chSysLock();
+        notes_pointer = np;
+        notes_count   = n_count;
+        notes_repeat  = n_repeat;
+
+        place          = 0;
+        current_note   = 0;
+        note_resting   = false;
+        envelope_index = 0;
+
+        note_frequency = (*notes_pointer)[current_note][0];
+        note_length    = ((*notes_pointer)[current_note][1] / 4) * (((float)note_tempo) / 100);
+        note_position  = 0;
+        playing_notes  = true;
+        chSysUnlock();
+    }
+}
+
+bool is_playing_notes(void) { return playing_notes; }
+
+bool is_audio_on(void) { return (audio_config.enable != 0); }
+
+void audio_toggle(void) {
+    audio_config.enable ^= 1;
+    eeconfig_update_audio(audio_config.raw);
+    if (audio_config.enable) {
+        audio_on_user();
+    }
+}
+
+void audio_on(void) {
+    audio_config.enable = 1;
+    eeconfig_update_audio(audio_config.raw);
+    audio_on_user();
+}
+
+void audio_off(void) {
+    stop_all_notes();
+    audio_config.enable = 0;
+    eeconfig_update_audio(audio_config.raw);
+}
+
+#ifdef VIBRATO_ENABLE
+
+// Vibrato rate functions
+
+void set_vibrato_rate(float rate) { vibrato_rate = rate; }
+
+void increase_vibrato_rate(float change) { vibrato_rate *= change; }
+
+void decrease_vibrato_rate(float change) { vibrato_rate /= change; }
+
+#    ifdef VIBRATO_STRENGTH_ENABLE
+
+void set_vibrato_strength(float strength) {
+    vibrato_strength = strength;
+    vibrato_update_table();
+}
+
+void increase_vibrato_strength(float change) { set_vibrato_strength(vibrato_strength * change); }
+
+void decrease_vibrato_strength(float change) { set_vibrato_strength(vibrato_strength / change); }
+
+#    endif /* VIBRATO_STRENGTH_ENABLE */
+
+#endif /* VIBRATO_ENABLE */
+
+// Polyphony functions
+
+void set_polyphony_rate(float rate) { polyphony_rate = rate; }
+
+void enable_polyphony() { polyphony_rate = 5; }
+
+void disable_polyphony() { polyphony_rate = 0; }
+
+void increase_polyphony_rate(float change) { polyphony_rate *= change; }
+
+void decrease_polyphony_rate(float change) { polyphony_rate /= change; }
+
+// Timbre function
+
+void set_timbre(float timbre) { note_timbre = timbre; }
+
+// Tempo functions
+
+void set_tempo(uint8_t tempo) { note_tempo = tempo; }
+
+void decrease_tempo(uint8_t tempo_change) { note_tempo += tempo_change; }
+
+void increase_tempo(uint8_t tempo_change) {
+    if (note_tempo - tempo_change < 10) {
+        note_tempo = 10;
+    } else {
+        note_tempo -= tempo_change;
+    }
+}
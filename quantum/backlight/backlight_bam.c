@@ -0,0 +1,200 @@
+#include "quantum.h"
+#include "backlight.h"
+#include "backlight_driver_common.h"
+
+/* Bit angle modulation
+ *
+ * The 8 bit duty cycle is output one bit at a time from a timer interrupt,
+ * bit n keeping the pins on or off for 2^n LSB periods. That takes 8
+ * interrupts per cycle, where the timer driver needs 256, and does not depend
+ * on how often the main loop runs. A steady level of fully off or on stops the
+ * timer, and no other level needs anything from the main loop.
+ *
+ * This needs the ChibiOS GPT driver, there is no AVR version.
+ */
+
+#ifndef PROTOCOL_CHIBIOS
+#    error "The bam backlight driver is only available on ChibiOS. Please use the software driver."
+#endif
+
+#ifndef BACKLIGHT_GPT_DRIVER
+#    define BACKLIGHT_GPT_DRIVER GPTD15
+#endif
+
+#ifndef BACKLIGHT_BAM_FREQUENCY
+#    define BACKLIGHT_BAM_FREQUENCY 1000000
+#endif
+
+// Timer ticks of the least significant bit, 255 of them make a cycle
+#ifndef BACKLIGHT_BAM_LSB_TICKS
+#    define BACKLIGHT_BAM_LSB_TICKS 10
+#endif
+
+// Shortest bit, in microseconds. The next interrupt is armed from the callback,
+// so a bit shorter than the interrupt latency comes out longer than it should
+// and the lowest levels lose their steps.
+#ifndef BACKLIGHT_BAM_MIN_LSB_US
+#    define BACKLIGHT_BAM_MIN_LSB_US 10
+#endif
+
+#define BAM_MIN_LSB_TICKS ((BACKLIGHT_BAM_FREQUENCY / 1000 * BACKLIGHT_BAM_MIN_LSB_US + 999) / 1000)
+#define BAM_LSB_TICKS (BACKLIGHT_BAM_LSB_TICKS > BAM_MIN_LSB_TICKS ? BACKLIGHT_BAM_LSB_TICKS : BAM_MIN_LSB_TICKS)
+
+#define BAM_BITS 8
+#define BAM_CYCLES_PER_SECOND (BACKLIGHT_BAM_FREQUENCY / (BAM_LSB_TICKS * 255))
+
+_Static_assert((BAM_LSB_TICKS << (BAM_BITS - 1)) <= 0xFFFF, "BACKLIGHT_BAM_LSB_TICKS too large for the timer");
+
+static volatile uint8_t s_duty    = 0;  // Duty cycle of the next cycle
+static volatile bool    s_running = false;
+static uint8_t          s_cycle_duty;  // Duty cycle being output
+static uint8_t          s_bit;         // Bit being output
+
+#ifdef BACKLIGHT_BREATHING
+#    define BREATHING_STEPS 128
+
+static volatile bool breathing = false;
+static uint8_t       breathing_index;
+static uint16_t      breathing_cycles;
+
+/* To generate breathing curve in python:
+ * from math import sin, pi; [int(sin(x/128.0*pi)**4*255) for x in range(128)]
+ */
+static const uint8_t breathing_table[BREATHING_STEPS] = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 2, 3, 4, 5, 6, 8, 10, 12, 15, 17, 20, 24, 28, 32, 36, 41, 46, 51, 57, 63, 70, 76, 83, 91, 98, 106, 113, 121, 129, 138, 146, 154, 162, 170, 178, 185, 193, 200, 207, 213, 220, 225, 231, 235, 240, 244, 247, 250, 252, 253, 254, 255, 254, 253, 252, 250, 247, 244, 240, 235, 231, 225, 220, 213, 207, 200, 193, 185, 178, 170, 162, 154, 146, 138, 129, 121, 113, 106, 98, 91, 83, 76, 70, 63, 57, 51, 46, 41, 36, 32, 28, 24, 20, 17, 15, 12, 10, 8, 6, 5, 4, 3, 2, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0};
+
+// breathing_table scaled to the backlight level and corrected for lightness,
+// worked out whenever the level changes so that the interrupt only looks it up
+static uint8_t breathing_duty[BREATHING_STEPS];
+#endif
+
+static uint8_t level_duty(uint8_t level, uint8_t brightness) { return cie_lightness((uint32_t)brightness * 257 * level / BACKLIGHT_LEVELS) >> 8; }
+
+#ifdef BACKLIGHT_BREATHING
+static void breathing_step(void) {
+    uint16_t cycles_per_step = (uint32_t)get_breathing_period() * BAM_CYCLES_PER_SECOND / BREATHING_STEPS;
+    if (++breathing_cycles < cycles_per_step) {
+        return;
+    }
+
+    breathing_cycles = 0;
+    breathing_index  = (breathing_index + 1) % BREATHING_STEPS;
+    s_duty           = breathing_duty[breathing_index];
+}
+#endif
+
+static void bam_next_bit(void) {
+    if (s_bit == 0) {
+#ifdef BACKLIGHT_BREATHING
+        if (breathing) {
+            breathing_step();
+        }
+#endif
+        // A cycle never mixes the bits of two duty cycles
+        s_cycle_duty = s_duty;
+    }
+
+    if (s_cycle_duty & (1 << s_bit)) {
+        backlight_pins_on();
+    } else {
+        backlight_pins_off();
+    }
+
+    gptStartOneShotI(&BACKLIGHT_GPT_DRIVER, BAM_LSB_TICKS << s_bit);
+    s_bit = (s_bit + 1) % BAM_BITS;
+}
+
+static void gptTimerCallback(GPTDriver *gptp) {
+    (void)gptp;
+
+    chSysLockFromISR();
+    bam_next_bit();
+    chSysUnlockFromISR();
+}
+
+static void backlight_bam_update(void) {
+    static const GPTConfig gptcfg = {BACKLIGHT_BAM_FREQUENCY, gptTimerCallback, 0, 0};
+
+    static bool s_init = false;
+    if (!s_init) {
+        gptStart(&BACKLIGHT_GPT_DRIVER, &gptcfg);
+        s_init = true;
+    }
+
+    bool modulate = s_duty != 0 && s_duty != 0xFF;
+#ifdef BACKLIGHT_BREATHING
+    modulate |= breathing;
+#endif
+
+    if (modulate && !s_running) {
+        s_running = true;
+        s_bit     = 0;
+        chSysLock();
+        bam_next_bit();
+        chSysUnlock();
+    } else if (!modulate) {
+        if (s_running) {
+            gptStopTimer(&BACKLIGHT_GPT_DRIVER);
+            s_running = false;
+        }
+
+        if (s_duty) {
+            backlight_pins_on();
+        } else {
+            backlight_pins_off();
+        }
+    }
+}
+
+void backlight_init_ports(void) {
+    backlight_pins_init();
+
+    backlight_set(get_backlight_level());
+
+#ifdef BACKLIGHT_BREATHING
+    if (is_backlight_breathing()) {
+        breathing_enable();
+    }
+#endif
+}
+
+void backlight_set(uint8_t level) {
+    if (level > BACKLIGHT_LEVELS) level = BACKLIGHT_LEVELS;
+
+#ifdef BACKLIGHT_BREATHING
+    for (uint8_t i = 0; i < BREATHING_STEPS; i++) {
+        breathing_duty[i] = level_duty(level, breathing_table[i]);
+    }
+    if (breathing) {
+        // The interrupt picks up the new table on its next step
+        backlight_bam_update();
+        return;
+    }
+#endif
+
+    s_duty = level_duty(level, 0xFF);
+    backlight_bam_update();
+}
+
+void backlight_task(void) {}
+
+#ifdef BACKLIGHT_BREATHING
+bool is_breathing(void) { return breathing; }
+
+void breathing_enable(void) {
+    breathing_cycles = 0;
+    breathing_index  = 0;
+    breathing        = true;
+    backlight_bam_update();
+}
+
+void breathing_disable(void) {
+    breathing = false;
+    backlight_set(is_backlight_enabled() ? get_backlight_level() : 0);
+}
+
+void breathing_pulse(void) {
+    backlight_set(is_backlight_enabled() ? 0 : BACKLIGHT_LEVELS);
+    wait_ms(10);
+    backlight_set(is_backlight_enabled() ? get_backlight_level() : 0);
+}
+#endif
@@ -1,5 +1,6 @@
 #include "quantum.h"
 #include "backlight.h"
+#include "backlight_driver_common.h"
 #include <hal.h>
 #include "debug.h"
 
@@ -47,22 +48,6 @@ static PWMConfig pwmCFG = {0xFFFF, /* PWM clock frequency  */
                            0, /* HW dependent part.*/
                            0};
 
-// See http://jared.geek.nz/2013/feb/linear-led-pwm
-static uint16_t cie_lightness(uint16_t v) {
-    if (v <= 5243)     // if below 8% of max
-        return v / 9;  // same as dividing by 900%
-    else {
-        uint32_t y = (((uint32_t)v + 10486) << 8) / (10486 + 0xFFFFUL);  // add 16% of max and compare
-        // to get a useful result with integer division, we shift left in the expression above
-        // and revert what we've done again after squaring.
-        y = y * y * y >> 8;
-        if (y > 0xFFFFUL)  // prevent overflow
-            return 0xFFFFU;
-        else
-            return (uint16_t)y;
-    }
-}
-
 static uint32_t rescale_limit_val(uint32_t val) {
     // rescale the supplied backlight value to be in terms of the value limit
     return (val * (BACKLIGHT_LIMIT_VAL + 1)) / 256;
@@ -47,3 +47,19 @@ void backlight_pins_init(void) {
 void backlight_pins_on(void) { FOR_EACH_LED(backlight_on(backlight_pin);) }
 
 void backlight_pins_off(void) { FOR_EACH_LED(backlight_off(backlight_pin);) }
+
+// See http://jared.geek.nz/2013/feb/linear-led-pwm
+uint16_t cie_lightness(uint16_t v) {
+    if (v <= 5243)     // if below 8% of max
+        return v / 9;  // same as dividing by 900%
+    else {
+        uint32_t y = (((uint32_t)v + 10486) << 8) / (10486 + 0xFFFFUL);  // add 16% of max and compare
+        // to get a useful result with integer division, we shift left in the expression above
+        // and revert what we've done again after squaring.
+        y = y * y * y >> 8;
+        if (y > 0xFFFFUL)  // prevent overflow
+            return 0xFFFFU;
+        else
+            return (uint16_t)y;
+    }
+}
@@ -4,4 +4,6 @@ void backlight_pins_init(void);
 void backlight_pins_on(void);
 void backlight_pins_off(void);
 
+uint16_t cie_lightness(uint16_t v);
+
 void breathing_task(void);
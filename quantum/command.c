@@ -39,7 +39,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #    include "backlight.h"
 #endif
 
-#if defined(MOUSEKEY_ENABLE) && !defined(MK_3_SPEED)
+#if defined(MOUSEKEY_ENABLE) && !defined(MK_3_SPEED) && !defined(MK_KINETIC_SPEED)
 #    include "mousekey.h"
 #endif
 
@@ -53,7 +53,7 @@ static void print_version(void);
 static void print_status(void);
 static bool command_console(uint8_t code);
 static void command_console_help(void);
-#if defined(MOUSEKEY_ENABLE) && !defined(MK_3_SPEED)
+#if defined(MOUSEKEY_ENABLE) && !defined(MK_3_SPEED) && !defined(MK_KINETIC_SPEED)
 static bool mousekey_console(uint8_t code);
 static void mousekey_console_help(void);
 #endif
@@ -74,7 +74,7 @@ bool command_proc(uint8_t code) {
             else
                 return (command_console_extra(code) || command_console(code));
             break;
-#if defined(MOUSEKEY_ENABLE) && !defined(MK_3_SPEED)
+#if defined(MOUSEKEY_ENABLE) && !defined(MK_3_SPEED) && !defined(MK_KINETIC_SPEED)
         case MOUSEKEY:
             mousekey_console(code);
             break;
@@ -524,7 +524,7 @@ static bool command_console(uint8_t code) {
         case KC_ESC:
             command_state = ONESHOT;
             return false;
-#if defined(MOUSEKEY_ENABLE) && !defined(MK_3_SPEED)
+#if defined(MOUSEKEY_ENABLE) && !defined(MK_3_SPEED) && !defined(MK_KINETIC_SPEED)
         case KC_M:
             mousekey_console_help();
             print("M> ");
@@ -539,7 +539,7 @@ static bool command_console(uint8_t code) {
     return true;
 }
 
-#if defined(MOUSEKEY_ENABLE) && !defined(MK_3_SPEED)
+#if defined(MOUSEKEY_ENABLE) && !defined(MK_3_SPEED) && !defined(MK_KINETIC_SPEED)
 /***********************************************************
  * Mousekey console
  ***********************************************************/
@@ -20,6 +20,12 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "matrix.h"
 #include "debounce.h"
 #include "quantum.h"
+#ifdef MATRIX_THREAD_SCAN
+#    include "spsc_queue.h"
+#endif
+#ifdef MATRIX_SCANNER_GENERATED
+#    include "matrix_scanner.h"
+#endif
 
 #ifdef DIRECT_PINS
 static pin_t direct_pins[MATRIX_ROWS][MATRIX_COLS] = DIRECT_PINS;
@@ -97,14 +103,10 @@ static void init_pins(void) {
     }
 }
 
-static bool read_cols_on_row(matrix_row_t current_matrix[], uint8_t current_row) {
-    // Start with a clear matrix row
+#        if !defined(MATRIX_SCANNER_GENERATED) || defined(MATRIX_SCANNER_BENCHMARK)
+static matrix_row_t read_cols_generic(void) {
     matrix_row_t current_row_value = 0;
 
-    // Select row and wait for row selecton to stabilize
-    select_row(current_row);
-    matrix_io_delay();
-
     // For each col...
     for (uint8_t col_index = 0; col_index < MATRIX_COLS; col_index++) {
         // Select the col pin to read (active low)
@@ -114,6 +116,22 @@ static bool read_cols_on_row(matrix_row_t current_matrix[], uint8_t current_row)
         current_row_value |= pin_state ? 0 : (MATRIX_ROW_SHIFTER << col_index);
     }
 
+    return current_row_value;
+}
+#        endif
+
+static bool read_cols_on_row(matrix_row_t current_matrix[], uint8_t current_row) {
+    // Select row and wait for row selecton to stabilize
+    select_row(current_row);
+    matrix_io_delay();
+
+#        ifdef MATRIX_SCANNER_GENERATED
+    // One read per GPIO port, see `qmk generate-matrix-scanner`
+    matrix_row_t current_row_value = matrix_scanner_read_cols();
+#        else
+    matrix_row_t current_row_value = read_cols_generic();
+#        endif
+
     // Unselect row
     unselect_row(current_row);
 
@@ -186,22 +204,81 @@ static bool read_rows_on_col(matrix_row_t current_matrix[], uint8_t current_col)
 #    error DIODE_DIRECTION is not defined!
 #endif
 
-void matrix_init(void) {
-    // initialize key pins
-    init_pins();
+#ifdef MATRIX_SCANNER_BENCHMARK
+#    if !defined(MATRIX_SCANNER_GENERATED) || (DIODE_DIRECTION != COL2ROW) || defined(DIRECT_PINS)
+#        error "MATRIX_SCANNER_BENCHMARK needs a generated COL2ROW scanner"
+#    endif
+#    if !defined(PROTOCOL_CHIBIOS) || !defined(DWT_CTRL_CYCCNTENA_Msk)
+#        error "MATRIX_SCANNER_BENCHMARK needs a Cortex-M DWT cycle counter"
+#    endif
+#    if defined(NO_PRINT) || defined(NO_DEBUG)
+#        error "MATRIX_SCANNER_BENCHMARK prints its results to the console, enable CONSOLE_ENABLE"
+#    endif
+#    ifndef MATRIX_SCANNER_BENCHMARK_INTERVAL
+#        define MATRIX_SCANNER_BENCHMARK_INTERVAL 5000  // ms
+#    endif
+#    define MATRIX_SCANNER_BENCHMARK_ROUNDS 64
+
+/** \brief Compare the cycle cost of the generic and the generated column reads
+ *
+ * Prints the average number of CPU cycles per read of all columns to the console.
+ */
+static void matrix_scanner_benchmark(void) {
+    static uint16_t     last_run = 0;
+    static matrix_row_t sink;
+
+    if (!debug_matrix || timer_elapsed(last_run) < MATRIX_SCANNER_BENCHMARK_INTERVAL) {
+        return;
+    }
+    last_run = timer_read();
 
-    // initialize matrix state: all keys off
-    for (uint8_t i = 0; i < MATRIX_ROWS; i++) {
-        raw_matrix[i] = 0;
-        matrix[i]     = 0;
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    uint32_t start = DWT->CYCCNT;
+    for (uint8_t i = 0; i < MATRIX_SCANNER_BENCHMARK_ROUNDS; i++) {
+        sink |= read_cols_generic();
     }
+    uint32_t generic = DWT->CYCCNT - start;
 
-    debounce_init(MATRIX_ROWS);
+    start = DWT->CYCCNT;
+    for (uint8_t i = 0; i < MATRIX_SCANNER_BENCHMARK_ROUNDS; i++) {
+        sink |= matrix_scanner_read_cols();
+    }
+    uint32_t generated = DWT->CYCCNT - start;
 
-    matrix_init_quantum();
+    dprintf("matrix scanner cycles/row: generic %lu, generated %lu\n", generic / MATRIX_SCANNER_BENCHMARK_ROUNDS, generated / MATRIX_SCANNER_BENCHMARK_ROUNDS);
 }
+#endif
 
-uint8_t matrix_scan(void) {
+#ifdef MATRIX_THREAD_SCAN
+/* Threaded scanning
+ *
+ * The matrix is scanned from a high priority thread woken by the system tick,
+ * rather than from the main loop. Every debounced change is pushed, with the
+ * time it was seen, into a lock-free SPSC queue that keyboard_task() drains
+ * into action_exec(). This is ChibiOS only: on AVR the scan would have to run
+ * inside the timer interrupt, busy waits and all.
+ */
+#    ifndef MATRIX_EVENT_QUEUE_SIZE
+#        define MATRIX_EVENT_QUEUE_SIZE 16
+#    endif
+#    ifndef MATRIX_THREAD_SCAN_INTERVAL
+#        define MATRIX_THREAD_SCAN_INTERVAL 1  // ms
+#    endif
+
+SPSC_QUEUE_DECLARE(matrix_event_queue, keyevent_t, MATRIX_EVENT_QUEUE_SIZE)
+
+static matrix_event_queue_t event_queue;
+static matrix_row_t         matrix_reported[MATRIX_ROWS];
+static volatile uint16_t    dropped_events = 0;
+static volatile bool        scan_enabled   = false;
+static volatile bool        scan_busy      = false;
+
+static void matrix_start_thread_scan(void);
+#endif
+
+static bool matrix_read_raw(void) {
     bool changed = false;
 
 #if defined(DIRECT_PINS) || (DIODE_DIRECTION == COL2ROW)
@@ -216,8 +293,115 @@ uint8_t matrix_scan(void) {
     }
 #endif
 
+    return changed;
+}
+
+void matrix_init(void) {
+    // initialize key pins
+    init_pins();
+
+    // initialize matrix state: all keys off
+    for (uint8_t i = 0; i < MATRIX_ROWS; i++) {
+        raw_matrix[i] = 0;
+        matrix[i]     = 0;
+    }
+
+    debounce_init(MATRIX_ROWS);
+
+    matrix_init_quantum();
+
+#ifdef MATRIX_THREAD_SCAN
+    matrix_start_thread_scan();
+#endif
+}
+
+#ifdef MATRIX_THREAD_SCAN
+/** \brief Scan the matrix and queue key events, from the scan thread
+ *
+ * A change that does not fit in the queue is not lost: it stays unreported and is
+ * queued again on the next scan, so only its timestamp suffers. Such overflows are
+ * counted and can be read with matrix_events_dropped().
+ */
+void matrix_thread_scan(void) {
+    if (!scan_enabled || scan_busy) {
+        return;
+    }
+    scan_busy = true;
+
+    bool changed = matrix_read_raw();
+    debounce(raw_matrix, matrix, MATRIX_ROWS, changed);
+
+    uint16_t now = timer_read() | 1; /* time should not be 0 */
+    for (uint8_t row = 0; row < MATRIX_ROWS; row++) {
+        matrix_row_t change = matrix[row] ^ matrix_reported[row];
+        if (!change) {
+            continue;
+        }
+
+        matrix_row_t col_mask = 1;
+        for (uint8_t col = 0; col < MATRIX_COLS; col++, col_mask <<= 1) {
+            if (change & col_mask) {
+                keyevent_t event = {.key = (keypos_t){.row = row, .col = col}, .pressed = (matrix[row] & col_mask), .time = now};
+                if (!matrix_event_queue_push(&event_queue, &event)) {
+                    dropped_events++;
+                    goto SCAN_END;
+                }
+                matrix_reported[row] ^= col_mask;
+            }
+        }
+    }
+
+SCAN_END:
+    scan_busy = false;
+}
+
+bool matrix_event_pop(keyevent_t *event) { return matrix_event_queue_pop(&event_queue, event); }
+
+uint16_t matrix_events_dropped(void) { return dropped_events; }
+
+#    if defined(PROTOCOL_CHIBIOS)
+#        ifndef MATRIX_SCAN_THREAD_PRIORITY
+#            define MATRIX_SCAN_THREAD_PRIORITY HIGHPRIO
+#        endif
+
+static THD_WORKING_AREA(waMatrixScanThread, 256);
+static THD_FUNCTION(MatrixScanThread, arg) {
+    (void)arg;
+    chRegSetThreadName("matrix_scan");
+
+    systime_t next = chVTGetSystemTime();
+    while (true) {
+        next = chTimeAddX(next, TIME_MS2I(MATRIX_THREAD_SCAN_INTERVAL));
+        matrix_thread_scan();
+        chThdSleepUntilWindowed(chTimeSubtractX(next, TIME_MS2I(MATRIX_THREAD_SCAN_INTERVAL)), next);
+    }
+}
+
+static void matrix_start_thread_scan(void) {
+    scan_enabled = true;
+    chThdCreateStatic(waMatrixScanThread, sizeof(waMatrixScanThread), MATRIX_SCAN_THREAD_PRIORITY, MatrixScanThread, NULL);
+}
+#    else
+#        error "MATRIX_THREAD_SCAN is not supported on this platform"
+#    endif
+
+uint8_t matrix_scan(void) {
+#    ifdef MATRIX_SCANNER_BENCHMARK
+    matrix_scanner_benchmark();
+#    endif
+    matrix_scan_quantum();
+    return !matrix_event_queue_empty(&event_queue);
+}
+#else
+uint8_t matrix_scan(void) {
+#    ifdef MATRIX_SCANNER_BENCHMARK
+    matrix_scanner_benchmark();
+#    endif
+    bool changed = matrix_read_raw();
+
     debounce(raw_matrix, matrix, MATRIX_ROWS, changed);
 
     matrix_scan_quantum();
     return (uint8_t)changed;
 }
+#endif
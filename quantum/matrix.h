@@ -71,6 +71,16 @@ void matrix_scan_kb(void);
 void matrix_init_user(void);
 void matrix_scan_user(void);
 
+#ifdef MATRIX_THREAD_SCAN
+#    include "keyboard.h"
+/* scan from the scan thread and queue key events */
+void matrix_thread_scan(void);
+/* take the oldest queued key event, returns false if there is none */
+bool matrix_event_pop(keyevent_t *event);
+/* number of times a key event did not fit in the queue */
+uint16_t matrix_events_dropped(void);
+#endif
+
 #ifdef __cplusplus
 }
 #endif
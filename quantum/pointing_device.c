@@ -22,6 +22,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "print.h"
 #include "debug.h"
 #include "pointing_device.h"
+#include "pointer.h"
 
 static report_mouse_t mouseReport = {};
 
@@ -32,24 +33,20 @@ __attribute__((weak)) void pointing_device_init(void) {
 }
 
 __attribute__((weak)) void pointing_device_send(void) {
-    static report_mouse_t old_report = {};
-
     // If you need to do other things, like debugging, this is the place to do it.
-    if (has_mouse_report_changed(mouseReport, old_report)) {
-        host_mouse_send(&mouseReport);
-    }
-    // send it and 0 it out except for buttons, so those stay until they are explicity over-ridden using update_pointing_device
+    // The pointer pipeline merges this with the other mouse sources and sends it when something changed.
+    pointer_update(POINTER_SOURCE_DEVICE, &mouseReport);
+    // 0 it out except for buttons, so those stay until they are explicity over-ridden using update_pointing_device
     mouseReport.x = 0;
     mouseReport.y = 0;
     mouseReport.v = 0;
     mouseReport.h = 0;
-    old_report    = mouseReport;
 }
 
 __attribute__((weak)) void pointing_device_task(void) {
     // gather info and put it in:
-    // mouseReport.x = 127 max -127 min
-    // mouseReport.y = 127 max -127 min
+    // mouseReport.x = 127 max -127 min, 32767 max -32767 min with MOUSE_EXTENDED_REPORT
+    // mouseReport.y = 127 max -127 min, 32767 max -32767 min with MOUSE_EXTENDED_REPORT
     // mouseReport.v = 127 max -127 min (scroll vertical)
     // mouseReport.h = 127 max -127 min (scroll horizontal)
     // mouseReport.buttons = 0x1F (decimal 31, binary 00011111) max (bitmask for mouse buttons 1-5, 1 is rightmost, 5 is leftmost) 0x00 min
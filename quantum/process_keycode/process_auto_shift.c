@@ -20,6 +20,7 @@
 #    include <stdio.h>
 
 #    include "process_auto_shift.h"
+#    include "deadline.h"
 
 static uint16_t autoshift_time    = 0;
 static uint16_t autoshift_timeout = AUTO_SHIFT_TIMEOUT;
@@ -36,6 +37,16 @@ static struct {
     bool holding_shift : 1;
 } autoshift_flags = {true, false, false, false};
 
+/* Due when the key in progress has been held for autoshift_timeout */
+static deadline_t autoshift_deadline;
+
+static void autoshift_timeout_expired(deadline_t *deadline) { autoshift_matrix_scan(); }
+
+static void autoshift_schedule_timeout(void) {
+    const uint16_t elapsed = timer_elapsed(autoshift_time);
+    deadline_schedule(&autoshift_deadline, elapsed >= autoshift_timeout ? 0 : autoshift_timeout - elapsed, autoshift_timeout_expired);
+}
+
 /** \brief Record the press of an autoshiftable key
  *
  *  \return Whether the record should be further processed.
@@ -75,6 +86,7 @@ static bool autoshift_press(uint16_t keycode, uint16_t now, keyrecord_t *record)
     autoshift_lastkey           = keycode;
     autoshift_time              = now;
     autoshift_flags.in_progress = true;
+    autoshift_schedule_timeout();
 
 #    if !defined(NO_ACTION_ONESHOT) && !defined(NO_ACTION_TAPPING)
     clear_oneshot_layer_state(ONESHOT_OTHER_KEY_PRESSED);
@@ -94,6 +106,7 @@ static void autoshift_end(uint16_t keycode, uint16_t now, bool matrix_trigger) {
     if (autoshift_flags.in_progress) {
         // Process the auto-shiftable key.
         autoshift_flags.in_progress = false;
+        deadline_cancel(&autoshift_deadline);
 
         // Time since the initial press was recorded.
         const uint16_t elapsed = TIMER_DIFF_16(now, autoshift_time);
@@ -135,9 +148,8 @@ static void autoshift_end(uint16_t keycode, uint16_t now, bool matrix_trigger) {
 
 /** \brief Simulates auto-shifted key releases when timeout is hit
  *
- *  Can be called from \c matrix_scan_user so that auto-shifted keys are sent
- *  immediately after the timeout has expired, rather than waiting for the key
- *  to be released.
+ *  Runs from a deadline, so auto-shifted keys are sent immediately after the
+ *  timeout has expired, rather than waiting for the key to be released.
  */
 void autoshift_matrix_scan(void) {
     if (autoshift_flags.in_progress) {
@@ -175,7 +187,12 @@ bool get_autoshift_state(void) { return autoshift_flags.enabled; }
 
 uint16_t get_autoshift_timeout(void) { return autoshift_timeout; }
 
-void set_autoshift_timeout(uint16_t timeout) { autoshift_timeout = timeout; }
+void set_autoshift_timeout(uint16_t timeout) {
+    autoshift_timeout = timeout;
+    if (autoshift_flags.in_progress) {
+        autoshift_schedule_timeout();
+    }
+}
 
 bool process_auto_shift(uint16_t keycode, keyrecord_t *record) {
     // Note that record->event.time isn't reliable, see:
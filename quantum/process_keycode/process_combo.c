@@ -16,6 +16,7 @@
 
 #include "print.h"
 #include "process_combo.h"
+#include "deadline.h"
 
 #ifndef COMBO_VARIABLE_LEN
 __attribute__((weak)) combo_t key_combos[COMBO_COUNT] = {};
@@ -32,6 +33,9 @@ static bool     drop_buffer         = false;
 static bool     is_active           = false;
 static bool     b_combo_enable      = true;  // defaults to enabled
 
+/* Due when the keys held for a combo are sent on their own */
+static deadline_t combo_deadline;
+
 static uint8_t buffer_size = 0;
 #ifdef COMBO_ALLOW_ACTION_KEYS
 static keyrecord_t key_buffer[MAX_COMBO_LENGTH];
@@ -71,6 +75,18 @@ static inline void dump_key_buffer(bool emit) {
     buffer_size = 0;
 }
 
+static void combo_timeout(deadline_t *deadline) { matrix_scan_combo(); }
+
+static void combo_restart_timer(void) {
+    timer = timer_read();
+    deadline_schedule(&combo_deadline, COMBO_TERM + 1, combo_timeout);
+}
+
+static void combo_stop_timer(void) {
+    timer = 0;
+    deadline_cancel(&combo_deadline);
+}
+
 #define ALL_COMBO_KEYS_ARE_DOWN (((1 << count) - 1) == combo->state)
 #define KEY_STATE_DOWN(key)         \
     do {                            \
@@ -157,7 +173,7 @@ bool process_combo(uint16_t keycode, keyrecord_t *record) {
     if (drop_buffer) {
         /* buffer is only dropped when we complete a combo, so we refresh the timer
          * here */
-        timer = timer_read();
+        combo_restart_timer();
         dump_key_buffer(false);
     } else if (!is_combo_key) {
         /* if no combos claim the key we need to emit the keybuffer */
@@ -165,12 +181,12 @@ bool process_combo(uint16_t keycode, keyrecord_t *record) {
 
         // reset state if there are no combo keys pressed at all
         if (no_combo_keys_pressed) {
-            timer     = 0;
+            combo_stop_timer();
             is_active = true;
         }
     } else if (record->event.pressed && is_active) {
         /* otherwise the key is consumed and placed in the buffer */
-        timer = timer_read();
+        combo_restart_timer();
 
         if (buffer_size < MAX_COMBO_LENGTH) {
 #ifdef COMBO_ALLOW_ACTION_KEYS
@@ -184,6 +200,7 @@ bool process_combo(uint16_t keycode, keyrecord_t *record) {
     return !is_combo_key;
 }
 
+/* Runs from combo_deadline, calling it from the matrix scan is no longer needed */
 void matrix_scan_combo(void) {
     if (b_combo_enable && is_active && timer && timer_elapsed(timer) > COMBO_TERM) {
         /* This disables the combo, meaning key events for this
@@ -198,7 +215,7 @@ void combo_enable(void) { b_combo_enable = true; }
 
 void combo_disable(void) {
     b_combo_enable = is_active = false;
-    timer                      = 0;
+    combo_stop_timer();
     dump_key_buffer(true);
 }
 
@@ -37,103 +37,371 @@ __attribute__((weak)) void dynamic_macro_record_key_user(int8_t direction, keyre
 
 __attribute__((weak)) void dynamic_macro_record_end_user(int8_t direction) { dynamic_macro_led_blink(); }
 
+/* Both macros share macros.buffer but read/write on different ends of it.
+ *
+ * Macro1 is written left-to-right starting from the beginning of the
+ * buffer.
+ *
+ * Macro2 is written right-to-left starting from the end of the buffer.
+ *
+ * &buffer[0]                                              &buffer[SIZE - 1]
+ *  v                                                                 v
+ * +------------------------------------------------------------------+
+ * |>>>>>> MACRO1 >>>>>>            <<<<<<<<<<<<<<< MACRO2 <<<<<<<<<<<|
+ * +------------------------------------------------------------------+
+ *  <- length[0] ->                 <------------ length[1] ---------->
+ *
+ * During the recording when one macro encounters the end of the other
+ * macro, the recording is stopped. Apart from this, there are no arbitrary
+ * limits for the macros' length in relation to each other.
+ *
+ * Instead of whole keyrecord_t structs the buffer holds a compact byte
+ * encoding of each event:
+ *
+ *   varint  (zigzag(key - previous key) << 2) | has_tap << 1 | pressed
+ *   byte    tap.count | tap.interrupted << 4, only present if has_tap
+ *   varint  milliseconds since the previous event
+ *
+ * where key is the matrix position packed as (row << 8 | col). Keys pressed
+ * and released in a row are usually close to each other, so a typical event
+ * takes 2-3 bytes instead of sizeof(keyrecord_t).
+ */
+typedef struct {
+    uint8_t  magic;
+    uint8_t  reserved;
+    uint16_t size;
+    uint16_t length[2];
+    uint8_t  buffer[DYNAMIC_MACRO_BUFFER_SIZE];
+} dynamic_macro_storage_t;
+
+_Static_assert(DYNAMIC_MACRO_BUFFER_SIZE <= 0x8000, "DYNAMIC_MACRO_BUFFER_SIZE is too large");
+
+static dynamic_macro_storage_t macros;
+
+#define DYNAMIC_MACRO_MAGIC 0xD4
+#define DYNAMIC_MACRO_EVENT_MAX_SIZE 7
+
+/* Slot index (0 or 1) of a macro from its direction */
+#define DYNAMIC_MACRO_SLOT(direction) ((direction) > 0 ? 0 : 1)
+
+/* Byte at the given offset in a macro, counting from the macro's own end of the buffer */
+#define DYNAMIC_MACRO_BYTE(direction, offset) (macros.buffer[(direction) > 0 ? (offset) : DYNAMIC_MACRO_BUFFER_SIZE - 1 - (offset)])
+
 /* Convenience macros used for retrieving the debug info. All of them
  * need a `direction` variable accessible at the call site.
  */
 #define DYNAMIC_MACRO_CURRENT_SLOT() (direction > 0 ? 1 : 2)
-#define DYNAMIC_MACRO_CURRENT_LENGTH(BEGIN, POINTER) ((int)(direction * ((POINTER) - (BEGIN))))
-#define DYNAMIC_MACRO_CURRENT_CAPACITY(BEGIN, END2) ((int)(direction * ((END2) - (BEGIN)) + 1))
+#define DYNAMIC_MACRO_CURRENT_CAPACITY() (DYNAMIC_MACRO_BUFFER_SIZE - macros.length[DYNAMIC_MACRO_SLOT(-direction)])
+
+/* Position of the next byte of the macro being recorded */
+static uint16_t record_length = 0;
+/* Length of the macro being recorded up to its last key-up event */
+static uint16_t record_keep = 0;
+static uint16_t record_key  = 0;
+static uint16_t record_time = 0;
+
+typedef struct {
+    int8_t   direction;
+    uint16_t offset;
+    uint16_t key;
+} dynamic_macro_reader_t;
+
+#ifdef DYNAMIC_MACRO_TIMED_PLAYBACK
+static struct {
+    dynamic_macro_reader_t reader;
+    keyrecord_t            record;
+    bool                   pending;
+    uint16_t               delay;
+    uint16_t               timer;
+    layer_state_t          saved_layer_state;
+} playback;
+#endif
+
+static uint8_t dynamic_macro_put_varint(uint8_t *out, uint32_t value) {
+    uint8_t size = 0;
+    while (value >= 0x80) {
+        out[size++] = (uint8_t)value | 0x80;
+        value >>= 7;
+    }
+    out[size++] = (uint8_t)value;
+    return size;
+}
+
+/* Reads a varint that has to end before offset end, returns false if it does
+ * not (a macro cut short, or corrupted in EEPROM) */
+static bool dynamic_macro_get_varint(dynamic_macro_reader_t *reader, uint16_t end, uint32_t *value) {
+    uint8_t shift = 0;
+    uint8_t byte;
+    *value = 0;
+    do {
+        if (reader->offset >= end || shift >= 32) {
+            return false;
+        }
+        byte = DYNAMIC_MACRO_BYTE(reader->direction, reader->offset++);
+        *value |= (uint32_t)(byte & 0x7F) << shift;
+        shift += 7;
+    } while (byte & 0x80);
+    return true;
+}
+
+/**
+ * Decode the next event of a macro.
+ *
+ * @param reader[in,out] The macro and the position being read.
+ * @param record[out]    The decoded event, time stamped with the current time.
+ * @param delay[out]     Milliseconds between the previous event and this one.
+ * @return false once the end of the macro is reached, or if the last event
+ *         does not fit in what is left of the macro.
+ */
+static bool dynamic_macro_read(dynamic_macro_reader_t *reader, keyrecord_t *record, uint16_t *delay) {
+    uint16_t end = macros.length[DYNAMIC_MACRO_SLOT(reader->direction)];
+    uint32_t header;
+    uint32_t elapsed;
+
+    if (!dynamic_macro_get_varint(reader, end, &header)) {
+        return false;
+    }
+    uint16_t zigzag = header >> 2;
+    reader->key += (uint16_t)((zigzag >> 1) ^ -(zigzag & 1));
+
+    *record = (keyrecord_t){
+        .event =
+            {
+                .key     = {.row = reader->key >> 8, .col = reader->key & 0xFF},
+                .pressed = header & 1,
+                .time    = timer_read() | 1,
+            },
+    };
+    if (header & 2) {
+        if (reader->offset >= end) {
+            return false;
+        }
+        uint8_t tap = DYNAMIC_MACRO_BYTE(reader->direction, reader->offset++);
+#ifndef NO_ACTION_TAPPING
+        record->tap.count       = tap & 0x0F;
+        record->tap.interrupted = (tap >> 4) & 1;
+#else
+        (void)tap;
+#endif
+    }
+    if (!dynamic_macro_get_varint(reader, end, &elapsed)) {
+        return false;
+    }
+    *delay = elapsed;
+    return true;
+}
+
+#ifdef DYNAMIC_MACRO_EEPROM_ADDR
+/* Write both macros to EEPROM (or its flash emulation) in a single batch. Only
+ * the bytes that changed are actually written. */
+static void dynamic_macro_save(void) {
+    macros.magic = DYNAMIC_MACRO_MAGIC;
+    macros.size  = DYNAMIC_MACRO_BUFFER_SIZE;
+    eeprom_update_block(&macros, (void *)DYNAMIC_MACRO_EEPROM_ADDR, sizeof(macros));
+}
+
+static void dynamic_macro_load(void) {
+    static bool loaded = false;
+    if (loaded) {
+        return;
+    }
+    loaded = true;
+
+    eeprom_read_block(&macros, (const void *)DYNAMIC_MACRO_EEPROM_ADDR, sizeof(macros));
+    if (macros.magic != DYNAMIC_MACRO_MAGIC || macros.size != DYNAMIC_MACRO_BUFFER_SIZE || macros.length[0] > DYNAMIC_MACRO_BUFFER_SIZE || macros.length[1] > DYNAMIC_MACRO_BUFFER_SIZE - macros.length[0]) {
+        dprintln("dynamic macro: no saved macros");
+        macros.length[0] = 0;
+        macros.length[1] = 0;
+        return;
+    }
+
+    // A macro whose events do not end exactly at its length is dropped
+    for (int8_t direction = 1; direction >= -1; direction -= 2) {
+        dynamic_macro_reader_t reader = {.direction = direction};
+        keyrecord_t            record;
+        uint16_t               delay;
+        uint16_t               read = 0;
+        while (dynamic_macro_read(&reader, &record, &delay)) {
+            read = reader.offset;
+        }
+        if (read != macros.length[DYNAMIC_MACRO_SLOT(direction)]) {
+            dprintf("dynamic macro: slot %d is corrupted\n", DYNAMIC_MACRO_CURRENT_SLOT());
+            macros.length[DYNAMIC_MACRO_SLOT(direction)] = 0;
+        }
+    }
+}
+#endif
 
 /**
  * Start recording of the dynamic macro.
  *
- * @param[out] macro_pointer The new macro buffer iterator.
- * @param[in]  macro_buffer  The macro buffer used to initialize macro_pointer.
+ * @param direction[in] Either +1 or -1, which macro to record.
  */
-void dynamic_macro_record_start(keyrecord_t **macro_pointer, keyrecord_t *macro_buffer) {
+void dynamic_macro_record_start(int8_t direction) {
     dprintln("dynamic macro recording: started");
 
     dynamic_macro_record_start_user();
 
     clear_keyboard();
     layer_clear();
-    *macro_pointer = macro_buffer;
+    macros.length[DYNAMIC_MACRO_SLOT(direction)] = 0;
+    record_length = 0;
+    record_keep   = 0;
+    record_key    = 0;
+}
+
+/**
+ * Replay every event of a macro at once.
+ */
+static void dynamic_macro_play_now(int8_t direction) {
+    dynamic_macro_reader_t reader = {.direction = direction};
+    keyrecord_t            record;
+    uint16_t               delay;
+
+    while (dynamic_macro_read(&reader, &record, &delay)) {
+        process_record(&record);
+    }
 }
 
 /**
  * Play the dynamic macro.
  *
- * @param macro_buffer[in] The beginning of the macro buffer being played.
- * @param macro_end[in]    The element after the last macro buffer element.
- * @param direction[in]    Either +1 or -1, which way to iterate the buffer.
+ * With DYNAMIC_MACRO_TIMED_PLAYBACK the events are only queued here and
+ * replayed with their recorded timing by dynamic_macro_task(), otherwise they
+ * are all replayed immediately. A macro played from within a timed playback
+ * (a nested macro) is always replayed immediately.
+ *
+ * @param direction[in] Either +1 or -1, which macro to play.
  */
-void dynamic_macro_play(keyrecord_t *macro_buffer, keyrecord_t *macro_end, int8_t direction) {
+void dynamic_macro_play(int8_t direction) {
     dprintf("dynamic macro: slot %d playback\n", DYNAMIC_MACRO_CURRENT_SLOT());
 
+#ifdef DYNAMIC_MACRO_TIMED_PLAYBACK
+    if (playback.reader.direction != 0) {
+        dynamic_macro_play_now(direction);
+        return;
+    }
+
+    playback.saved_layer_state = layer_state;
+    clear_keyboard();
+    layer_clear();
+
+    playback.reader  = (dynamic_macro_reader_t){.direction = direction};
+    playback.timer   = timer_read();
+    playback.pending = dynamic_macro_read(&playback.reader, &playback.record, &playback.delay);
+#else
     layer_state_t saved_layer_state = layer_state;
 
     clear_keyboard();
     layer_clear();
 
-    while (macro_buffer != macro_end) {
-        process_record(macro_buffer);
-        macro_buffer += direction;
-    }
+    dynamic_macro_play_now(direction);
 
     clear_keyboard();
 
     layer_state = saved_layer_state;
 
     dynamic_macro_play_user(direction);
+#endif
+}
+
+/**
+ * Replay the events of a timed playback that are due. Called from
+ * matrix_scan_quantum() so the playback never blocks the scan loop.
+ */
+void dynamic_macro_task(void) {
+#ifdef DYNAMIC_MACRO_TIMED_PLAYBACK
+    int8_t direction = playback.reader.direction;
+    if (direction == 0) {
+        return;
+    }
+
+    while (playback.pending && timer_elapsed(playback.timer) >= playback.delay) {
+        playback.timer += playback.delay;
+        playback.record.event.time = timer_read() | 1;
+        process_record(&playback.record);
+        playback.pending = dynamic_macro_read(&playback.reader, &playback.record, &playback.delay);
+    }
+
+    if (!playback.pending) {
+        clear_keyboard();
+
+        layer_state               = playback.saved_layer_state;
+        playback.reader.direction = 0;
+
+        dynamic_macro_play_user(direction);
+    }
+#endif
 }
 
 /**
  * Record a single key in a dynamic macro.
  *
- * @param macro_buffer[in] The start of the used macro buffer.
- * @param macro_pointer[in,out] The current buffer position.
- * @param macro2_end[in] The end of the other macro.
- * @param direction[in]  Either +1 or -1, which way to iterate the buffer.
+ * @param direction[in]  Either +1 or -1, which macro is being recorded.
  * @param record[in]     The current keypress.
  */
-void dynamic_macro_record_key(keyrecord_t *macro_buffer, keyrecord_t **macro_pointer, keyrecord_t *macro2_end, int8_t direction, keyrecord_t *record) {
+void dynamic_macro_record_key(int8_t direction, keyrecord_t *record) {
     /* If we've just started recording, ignore all the key releases. */
-    if (!record->event.pressed && *macro_pointer == macro_buffer) {
+    if (!record->event.pressed && record_length == 0) {
         dprintln("dynamic macro: ignoring a leading key-up event");
         return;
     }
 
+    uint8_t  event[DYNAMIC_MACRO_EVENT_MAX_SIZE];
+    uint16_t key    = (uint16_t)record->event.key.row << 8 | record->event.key.col;
+    int16_t  delta  = (int16_t)(key - record_key);
+    uint16_t zigzag = (uint16_t)(delta << 1) ^ (uint16_t)(delta >> 15);
+    uint8_t  tap    = 0;
+#ifndef NO_ACTION_TAPPING
+    tap = record->tap.count | record->tap.interrupted << 4;
+#endif
+    uint8_t size = dynamic_macro_put_varint(event, (uint32_t)zigzag << 2 | (tap ? 2 : 0) | record->event.pressed);
+    if (tap) {
+        event[size++] = tap;
+    }
+    size += dynamic_macro_put_varint(event + size, record_length == 0 ? 0 : TIMER_DIFF_16(record->event.time, record_time));
+
     /* The other end of the other macro is the last buffer element it
      * is safe to use before overwriting the other macro.
      */
-    if (*macro_pointer - direction != macro2_end) {
-        **macro_pointer = *record;
-        *macro_pointer += direction;
+    if (record_length + size <= DYNAMIC_MACRO_CURRENT_CAPACITY()) {
+        for (uint8_t i = 0; i < size; i++) {
+            DYNAMIC_MACRO_BYTE(direction, record_length + i) = event[i];
+        }
+        record_length += size;
+        record_key  = key;
+        record_time = record->event.time;
+        if (!record->event.pressed) {
+            record_keep = record_length;
+        }
     } else {
         dynamic_macro_record_key_user(direction, record);
     }
 
-    dprintf("dynamic macro: slot %d length: %d/%d\n", DYNAMIC_MACRO_CURRENT_SLOT(), DYNAMIC_MACRO_CURRENT_LENGTH(macro_buffer, *macro_pointer), DYNAMIC_MACRO_CURRENT_CAPACITY(macro_buffer, macro2_end));
+    dprintf("dynamic macro: slot %d length: %d/%d bytes\n", DYNAMIC_MACRO_CURRENT_SLOT(), record_length, DYNAMIC_MACRO_CURRENT_CAPACITY());
 }
 
 /**
  * End recording of the dynamic macro. Essentially just update the
- * pointer to the end of the macro.
+ * length of the macro.
  */
-void dynamic_macro_record_end(keyrecord_t *macro_buffer, keyrecord_t *macro_pointer, int8_t direction, keyrecord_t **macro_end) {
+void dynamic_macro_record_end(int8_t direction) {
     dynamic_macro_record_end_user(direction);
 
     /* Do not save the keys being held when stopping the recording,
      * i.e. the keys used to access the layer DYN_REC_STOP is on.
      */
-    while (macro_pointer != macro_buffer && (macro_pointer - direction)->event.pressed) {
-        dprintln("dynamic macro: trimming a trailing key-down event");
-        macro_pointer -= direction;
+    if (record_keep != record_length) {
+        dprintln("dynamic macro: trimming trailing key-down events");
     }
 
-    dprintf("dynamic macro: slot %d saved, length: %d\n", DYNAMIC_MACRO_CURRENT_SLOT(), DYNAMIC_MACRO_CURRENT_LENGTH(macro_buffer, macro_pointer));
+    dprintf("dynamic macro: slot %d saved, length: %d bytes\n", DYNAMIC_MACRO_CURRENT_SLOT(), record_keep);
+
+    macros.length[DYNAMIC_MACRO_SLOT(direction)] = record_keep;
 
-    *macro_end = macro_pointer;
+#ifdef DYNAMIC_MACRO_EEPROM_ADDR
+    dynamic_macro_save();
+#endif
 }
 
 /* Handle the key events related to the dynamic macros. Should be
@@ -147,69 +415,31 @@ void dynamic_macro_record_end(keyrecord_t *macro_buffer, keyrecord_t *macro_poin
  *   }
  */
 bool process_dynamic_macro(uint16_t keycode, keyrecord_t *record) {
-    /* Both macros use the same buffer but read/write on different
-     * ends of it.
-     *
-     * Macro1 is written left-to-right starting from the beginning of
-     * the buffer.
-     *
-     * Macro2 is written right-to-left starting from the end of the
-     * buffer.
-     *
-     * &macro_buffer   macro_end
-     *  v                   v
-     * +------------------------------------------------------------+
-     * |>>>>>> MACRO1 >>>>>>      <<<<<<<<<<<<< MACRO2 <<<<<<<<<<<<<|
-     * +------------------------------------------------------------+
-     *                           ^                                 ^
-     *                         r_macro_end                  r_macro_buffer
-     *
-     * During the recording when one macro encounters the end of the
-     * other macro, the recording is stopped. Apart from this, there
-     * are no arbitrary limits for the macros' length in relation to
-     * each other: for example one can either have two medium sized
-     * macros or one long macro and one short macro. Or even one empty
-     * and one using the whole buffer.
-     */
-    static keyrecord_t macro_buffer[DYNAMIC_MACRO_SIZE];
-
-    /* Pointer to the first buffer element after the first macro.
-     * Initially points to the very beginning of the buffer since the
-     * macro is empty. */
-    static keyrecord_t *macro_end = macro_buffer;
-
-    /* The other end of the macro buffer. Serves as the beginning of
-     * the second macro. */
-    static keyrecord_t *const r_macro_buffer = macro_buffer + DYNAMIC_MACRO_SIZE - 1;
-
-    /* Like macro_end but for the second macro. */
-    static keyrecord_t *r_macro_end = r_macro_buffer;
-
-    /* A persistent pointer to the current macro position (iterator)
-     * used during the recording. */
-    static keyrecord_t *macro_pointer = NULL;
-
     /* 0   - no macro is being recorded right now
      * 1,2 - either macro 1 or 2 is being recorded */
     static uint8_t macro_id = 0;
 
+#ifdef DYNAMIC_MACRO_EEPROM_ADDR
+    dynamic_macro_load();
+#endif
+
     if (macro_id == 0) {
         /* No macro recording in progress. */
         if (!record->event.pressed) {
             switch (keycode) {
                 case DYN_REC_START1:
-                    dynamic_macro_record_start(&macro_pointer, macro_buffer);
+                    dynamic_macro_record_start(+1);
                     macro_id = 1;
                     return false;
                 case DYN_REC_START2:
-                    dynamic_macro_record_start(&macro_pointer, r_macro_buffer);
+                    dynamic_macro_record_start(-1);
                     macro_id = 2;
                     return false;
                 case DYN_MACRO_PLAY1:
-                    dynamic_macro_play(macro_buffer, macro_end, +1);
+                    dynamic_macro_play(+1);
                     return false;
                 case DYN_MACRO_PLAY2:
-                    dynamic_macro_play(r_macro_buffer, r_macro_end, -1);
+                    dynamic_macro_play(-1);
                     return false;
             }
         }
@@ -225,10 +455,10 @@ bool process_dynamic_macro(uint16_t keycode, keyrecord_t *record) {
                                                                           * starts for DYN_REC_STOP. */
                     switch (macro_id) {
                         case 1:
-                            dynamic_macro_record_end(macro_buffer, macro_pointer, +1, &macro_end);
+                            dynamic_macro_record_end(+1);
                             break;
                         case 2:
-                            dynamic_macro_record_end(r_macro_buffer, macro_pointer, -1, &r_macro_end);
+                            dynamic_macro_record_end(-1);
                             break;
                     }
                     macro_id = 0;
@@ -244,10 +474,10 @@ bool process_dynamic_macro(uint16_t keycode, keyrecord_t *record) {
                 /* Store the key in the macro buffer and process it normally. */
                 switch (macro_id) {
                     case 1:
-                        dynamic_macro_record_key(macro_buffer, &macro_pointer, r_macro_end, +1, record);
+                        dynamic_macro_record_key(+1, record);
                         break;
                     case 2:
-                        dynamic_macro_record_key(r_macro_buffer, &macro_pointer, macro_end, -1, record);
+                        dynamic_macro_record_key(-1, record);
                         break;
                 }
                 return true;
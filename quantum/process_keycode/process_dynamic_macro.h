@@ -20,10 +20,11 @@
 
 #include "quantum.h"
 
-/* May be overridden with a custom value. Be aware that the effective
- * macro length is half of this value: each keypress is recorded twice
- * because of the down-event and up-event. This is not a bug, it's the
- * intended behavior.
+/* May be overridden with a custom value. The macro buffer takes as much
+ * RAM as this many keyrecord_t structs, but events are stored in a compact
+ * encoding of usually 2-3 bytes each, so it holds several times more key
+ * events than that. Each keypress is recorded twice because of the
+ * down-event and up-event.
  *
  * Usually it should be fine to set the macro size to at least 256 but
  * there have been reports of it being too much in some users' cases,
@@ -33,9 +34,23 @@
 #    define DYNAMIC_MACRO_SIZE 128
 #endif
 
+/* Size of the macro buffer in bytes */
+#ifndef DYNAMIC_MACRO_BUFFER_SIZE
+#    define DYNAMIC_MACRO_BUFFER_SIZE (DYNAMIC_MACRO_SIZE * sizeof(keyrecord_t))
+#endif
+
+/* Define DYNAMIC_MACRO_EEPROM_ADDR to keep the macros across power cycles,
+ * they take DYNAMIC_MACRO_BUFFER_SIZE + 8 bytes of EEPROM from there on. */
+#ifdef DYNAMIC_MACRO_EEPROM_ADDR
+#    include "eeprom.h"
+#endif
+
 void dynamic_macro_led_blink(void);
 bool process_dynamic_macro(uint16_t keycode, keyrecord_t *record);
 void dynamic_macro_record_start_user(void);
 void dynamic_macro_play_user(int8_t direction);
 void dynamic_macro_record_key_user(int8_t direction, keyrecord_t *record);
 void dynamic_macro_record_end_user(int8_t direction);
+
+/* Replays the events of a DYNAMIC_MACRO_TIMED_PLAYBACK macro that are due */
+void dynamic_macro_task(void);
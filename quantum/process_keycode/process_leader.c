@@ -18,6 +18,7 @@
 
 #    include "process_leader.h"
 #    include <string.h>
+#    include "deadline.h"
 
 #    ifndef LEADER_TIMEOUT
 #        define LEADER_TIMEOUT 300
@@ -34,6 +35,51 @@ uint16_t leader_time = 0;
 uint16_t leader_sequence[5]   = {0, 0, 0, 0, 0};
 uint8_t  leader_sequence_size = 0;
 
+// Defined by LEADER_TABLE(), a keymap without it uses LEADER_DICTIONARY() instead
+extern const leader_entry_t leader_table[] __attribute__((weak));
+extern const uint16_t       leader_table_size __attribute__((weak));
+
+// Cleared by leader_init() if the table is out of order, the binary search needs it sorted
+static bool leader_table_sorted = true;
+
+static inline uint16_t leader_table_entries(void) { return &leader_table_size && leader_table_sorted ? leader_table_size : 0; }
+
+// Range of table entries still matching the keys typed so far
+static uint16_t leader_lo    = 0;
+static uint16_t leader_hi    = 0;
+static uint8_t  leader_depth = 0;
+
+static deadline_t leader_deadline;
+
+#    define LEADER_KEY(index, depth) pgm_read_word(&leader_table[index].keys[depth])
+
+static void leader_timeout(deadline_t *deadline) { matrix_scan_leader(); }
+
+uint16_t leader_table_unsorted(const leader_entry_t *table, uint16_t size) {
+    for (uint16_t i = 1; i < size; i++) {
+        uint8_t depth = 0;
+        while (depth < LEADER_TABLE_MAX_LENGTH && pgm_read_word(&table[i - 1].keys[depth]) == pgm_read_word(&table[i].keys[depth])) {
+            depth++;
+        }
+        // A duplicate entry is out of order too, only one of them could ever fire
+        if (depth == LEADER_TABLE_MAX_LENGTH || pgm_read_word(&table[i - 1].keys[depth]) > pgm_read_word(&table[i].keys[depth])) {
+            return i;
+        }
+    }
+    return size;
+}
+
+void leader_init(void) {
+    if (!&leader_table_size) {
+        return;
+    }
+    uint16_t unsorted = leader_table_unsorted(leader_table, leader_table_size);
+    if (unsorted != leader_table_size) {
+        dprintf("leader: LEADER_TABLE entry %u is out of order, the table is ignored\n", unsorted);
+        leader_table_sorted = false;
+    }
+}
+
 void qk_leader_start(void) {
     if (leading) {
         return;
@@ -43,11 +89,72 @@ void qk_leader_start(void) {
     leader_time          = timer_read();
     leader_sequence_size = 0;
     memset(leader_sequence, 0, sizeof(leader_sequence));
+    leader_lo    = 0;
+    leader_hi    = leader_table_entries();
+    leader_depth = 0;
+    if (leader_table_entries()) {
+        deadline_schedule(&leader_deadline, LEADER_TIMEOUT, leader_timeout);
+    }
+}
+
+static void leader_table_finish(bool fire) {
+    deadline_cancel(&leader_deadline);
+    leading = false;
+    leader_end();
+    if (fire) {
+        void (*action)(void) = (void (*)(void))pgm_read_ptr(&leader_table[leader_lo].action);
+        if (action) {
+            action();
+        }
+    }
+}
+
+// The first entry in range is the one that ends at the current depth, if any
+static bool leader_table_exact_match(void) { return leader_depth > 0 && leader_lo < leader_hi && (leader_depth == LEADER_TABLE_MAX_LENGTH || LEADER_KEY(leader_lo, leader_depth) == 0); }
+
+// First entry in [lo, hi) whose key at depth is not below keycode (or above it, if upper)
+static uint16_t leader_table_bound(uint16_t lo, uint16_t hi, uint16_t keycode, bool upper) {
+    while (lo < hi) {
+        uint16_t mid = lo + (hi - lo) / 2;
+        uint16_t key = LEADER_KEY(mid, leader_depth);
+        if (key < keycode || (upper && key == keycode)) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+// Walk one level down the table, firing as soon as a single complete entry is left
+static void leader_table_step(uint16_t keycode) {
+    if (leader_depth >= LEADER_TABLE_MAX_LENGTH) {
+        leader_table_finish(false);
+        return;
+    }
+
+    uint16_t lo  = leader_table_bound(leader_lo, leader_hi, keycode, false);
+    leader_hi    = leader_table_bound(lo, leader_hi, keycode, true);
+    leader_lo    = lo;
+    leader_depth++;
+
+    if (leader_lo == leader_hi) {
+        leader_table_finish(false);
+    } else if (leader_hi - leader_lo == 1 && leader_table_exact_match()) {
+        leader_table_finish(true);
+    }
+}
+
+void matrix_scan_leader(void) {
+    if (leading && leader_table_entries() && timer_elapsed(leader_time) >= LEADER_TIMEOUT) {
+        leader_table_finish(leader_table_exact_match());
+    }
 }
 
 bool process_leader(uint16_t keycode, keyrecord_t *record) {
     // Leader key set-up
     if (record->event.pressed) {
+        matrix_scan_leader();
         if (leading) {
             if (timer_elapsed(leader_time) < LEADER_TIMEOUT) {
 #    ifndef LEADER_KEY_STRICT_KEY_PROCESSING
@@ -58,12 +165,18 @@ bool process_leader(uint16_t keycode, keyrecord_t *record) {
                 if (leader_sequence_size < (sizeof(leader_sequence) / sizeof(leader_sequence[0]))) {
                     leader_sequence[leader_sequence_size] = keycode;
                     leader_sequence_size++;
-                } else {
+                } else if (!leader_table_entries()) {
                     leading = false;
                     leader_end();
                 }
+                if (leader_table_entries()) {
+                    leader_table_step(keycode);
+                }
 #    ifdef LEADER_PER_KEY_TIMING
                 leader_time = timer_read();
+                if (leading && leader_table_entries()) {
+                    deadline_schedule(&leader_deadline, LEADER_TIMEOUT, leader_timeout);
+                }
 #    endif
                 return false;
             }
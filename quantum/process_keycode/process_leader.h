@@ -23,6 +23,39 @@ bool process_leader(uint16_t keycode, keyrecord_t *record);
 void leader_start(void);
 void leader_end(void);
 void qk_leader_start(void);
+void leader_init(void);
+void matrix_scan_leader(void);
+
+/* Longest sequence a LEADER_TABLE() entry can hold */
+#ifndef LEADER_TABLE_MAX_LENGTH
+#    define LEADER_TABLE_MAX_LENGTH 8
+#endif
+
+typedef struct {
+    uint16_t keys[LEADER_TABLE_MAX_LENGTH];  // zero padded
+    void (*action)(void);
+} leader_entry_t;
+
+/* Declarative alternative to LEADER_DICTIONARY()
+ *
+ * The table is a trie flattened into a sorted array, so entries must be sorted by
+ * their keycodes, compared from the first key on; a sequence sorts before any
+ * longer sequence it is a prefix of. Each keystroke narrows the range of entries
+ * that can still match, and an entry fires as soon as it is the only one left.
+ * An entry that is a prefix of a longer one fires when LEADER_TIMEOUT expires.
+ * leader_init() checks the order, and ignores a table that is out of order.
+ */
+#define LEADER_SEQ(action, ...) \
+    { {__VA_ARGS__}, action }
+#define LEADER_TABLE(...)                                            \
+    const leader_entry_t PROGMEM leader_table[] = {__VA_ARGS__}; \
+    const uint16_t               leader_table_size = sizeof(leader_table) / sizeof(leader_table[0])
+
+extern const leader_entry_t leader_table[];
+extern const uint16_t       leader_table_size;
+
+/* Index of the first entry that does not sort after the one before it, or size if the table is sorted */
+uint16_t leader_table_unsorted(const leader_entry_t *table, uint16_t size);
 
 #define SEQ_ONE_KEY(key) if (leader_sequence[0] == (key) && leader_sequence[1] == 0 && leader_sequence[2] == 0 && leader_sequence[3] == 0 && leader_sequence[4] == 0)
 #define SEQ_TWO_KEYS(key1, key2) if (leader_sequence[0] == (key1) && leader_sequence[1] == (key2) && leader_sequence[2] == 0 && leader_sequence[3] == 0 && leader_sequence[4] == 0)
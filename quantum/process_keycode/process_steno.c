@@ -18,6 +18,12 @@
 #include "eeprom.h"
 #include "keymap_steno.h"
 #include "virtser.h"
+#ifdef STENO_RAW_HID
+#    ifndef RAW_ENABLE
+#        error "STENO_RAW_HID requires RAW_ENABLE = yes"
+#    endif
+#    include "raw_hid.h"
+#endif
 #include <string.h>
 
 // TxBolt Codes
@@ -58,39 +64,88 @@
 #define GEMINI_STATE_SIZE 6
 #define MAX_STATE_SIZE GEMINI_STATE_SIZE
 
-static uint8_t      state[MAX_STATE_SIZE] = {0};
-static uint8_t      chord[MAX_STATE_SIZE] = {0};
-static int8_t       pressed               = 0;
-static steno_mode_t mode;
+#ifdef STENO_RAW_HID
+// STENO_RAW_HID_ID and the steno mode come before the serial packet
+#    define STENO_PACKET_HEADER 2
+#    define STENO_PACKET_SIZE STENO_RAW_HID_REPORT_SIZE
+_Static_assert(STENO_PACKET_SIZE >= STENO_PACKET_HEADER + MAX_STATE_SIZE, "STENO_RAW_HID_REPORT_SIZE is too small for a steno packet");
+#else
+#    define STENO_PACKET_HEADER 0
+#    define STENO_PACKET_SIZE MAX_STATE_SIZE
+#endif
+
+/* The chord is accumulated right where the protocol expects it in the output
+ * packet, so sending it needs no copy: a Gemini PR chord already is its
+ * packet, a TX Bolt one is only compacted in place. */
+static uint8_t       packet[STENO_PACKET_SIZE] = {0};
+static uint8_t *const chord                     = packet + STENO_PACKET_HEADER;
+static uint8_t       state[MAX_STATE_SIZE]      = {0};
+static int8_t        pressed                    = 0;
+static steno_mode_t  mode;
+
+#ifdef STENO_HISTORY_SIZE
+static steno_stroke_t history[STENO_HISTORY_SIZE];
+static uint8_t        history_head  = 0;
+static uint8_t        history_count = 0;
+static uint16_t       stroke_start;
+#endif
 
 static const uint8_t boltmap[64] PROGMEM = {TXB_NUL, TXB_NUM, TXB_NUM, TXB_NUM, TXB_NUM, TXB_NUM, TXB_NUM, TXB_S_L, TXB_S_L, TXB_T_L, TXB_K_L, TXB_P_L, TXB_W_L, TXB_H_L, TXB_R_L, TXB_A_L, TXB_O_L, TXB_STR, TXB_STR, TXB_NUL, TXB_NUL, TXB_NUL, TXB_STR, TXB_STR, TXB_E_R, TXB_U_R, TXB_F_R, TXB_R_R, TXB_P_R, TXB_B_R, TXB_L_R, TXB_G_R, TXB_T_R, TXB_S_R, TXB_D_R, TXB_NUM, TXB_NUM, TXB_NUM, TXB_NUM, TXB_NUM, TXB_NUM, TXB_Z_R};
 
 static void steno_clear_state(void) {
     memset(state, 0, sizeof(state));
-    memset(chord, 0, sizeof(chord));
+    memset(packet, 0, sizeof(packet));
 }
 
-static void send_steno_state(uint8_t size, bool send_empty) {
-    for (uint8_t i = 0; i < size; ++i) {
-        if (chord[i] || send_empty) {
-#ifdef VIRTSER_ENABLE
-            virtser_send(chord[i]);
-#endif
-        }
+/* Turns the chord into the packet for the current mode, returns its length */
+static uint8_t build_steno_packet(void) {
+    uint8_t length = 0;
+
+    switch (mode) {
+        case STENO_MODE_BOLT:
+            // Only the groups with keys pressed are sent, then a terminating 0
+            for (uint8_t i = 0; i < BOLT_STATE_SIZE; ++i) {
+                if (chord[i]) {
+                    chord[length++] = chord[i];
+                }
+            }
+            chord[length++] = 0;
+            if (length < BOLT_STATE_SIZE) {
+                memset(chord + length, 0, BOLT_STATE_SIZE - length);
+            }
+            break;
+        case STENO_MODE_GEMINI:
+            chord[0] |= 0x80;  // Indicate start of packet
+            length = GEMINI_STATE_SIZE;
+            break;
     }
+    return length;
+}
+
+static void send_steno_packet(uint8_t length) {
+#ifdef STENO_RAW_HID
+    packet[0] = STENO_RAW_HID_ID;
+    packet[1] = mode;
+    raw_hid_send(packet, sizeof(packet));
+    (void)length;
+#elif defined(VIRTSER_ENABLE)
+    virtser_send_buffer(chord, length);
+#else
+    (void)length;
+#endif
 }
 
 void steno_init() {
     if (!eeconfig_is_enabled()) {
         eeconfig_init();
     }
-    mode = eeprom_read_byte(EECONFIG_STENOMODE);
+    mode = eeconfig_read_byte(EECONFIG_STENOMODE);
 }
 
 void steno_set_mode(steno_mode_t new_mode) {
     steno_clear_state();
     mode = new_mode;
-    eeprom_update_byte(EECONFIG_STENOMODE, mode);
+    eeconfig_update_byte(EECONFIG_STENOMODE, mode);
 }
 
 /* override to intercept chords right before they get sent.
@@ -102,28 +157,46 @@ __attribute__((weak)) bool postprocess_steno_user(uint16_t keycode, keyrecord_t
 
 __attribute__((weak)) bool process_steno_user(uint16_t keycode, keyrecord_t *record) { return true; }
 
-static void send_steno_chord(void) {
-    if (send_steno_chord_user(mode, chord)) {
-        switch (mode) {
-            case STENO_MODE_BOLT:
-                send_steno_state(BOLT_STATE_SIZE, false);
-#ifdef VIRTSER_ENABLE
-                virtser_send(0);  // terminating byte
+static void send_steno_chord(uint16_t released) {
+#ifdef STENO_HISTORY_SIZE
+    steno_stroke_t *stroke = &history[history_head];
+    stroke->mode           = mode;
+    stroke->pressed        = stroke_start;
+    stroke->released       = released;
+    memcpy(stroke->chord, chord, sizeof(stroke->chord));
+#else
+    (void)released;
 #endif
-                break;
-            case STENO_MODE_GEMINI:
-                chord[0] |= 0x80;  // Indicate start of packet
-                send_steno_state(GEMINI_STATE_SIZE, true);
-                break;
-        }
+
+    if (send_steno_chord_user(mode, chord)) {
+        send_steno_packet(build_steno_packet());
     }
     steno_clear_state();
+
+#ifdef STENO_HISTORY_SIZE
+    stroke->sent = timer_read();
+    history_head = (history_head + 1) % STENO_HISTORY_SIZE;
+    if (history_count < STENO_HISTORY_SIZE) {
+        history_count++;
+    }
+#endif
 }
 
 uint8_t *steno_get_state(void) { return &state[0]; }
 
 uint8_t *steno_get_chord(void) { return &chord[0]; }
 
+#ifdef STENO_HISTORY_SIZE
+uint8_t steno_history_count(void) { return history_count; }
+
+const steno_stroke_t *steno_history_get(uint8_t age) {
+    if (age >= history_count) {
+        return NULL;
+    }
+    return &history[(history_head + STENO_HISTORY_SIZE - 1 - age) % STENO_HISTORY_SIZE];
+}
+#endif
+
 static bool update_state_bolt(uint8_t key, bool press) {
     uint8_t boltcode = pgm_read_byte(boltmap + key);
     if (press) {
@@ -182,12 +255,17 @@ bool process_steno(uint16_t keycode, keyrecord_t *record) {
             // allow postprocessing hooks
             if (postprocess_steno_user(keycode, record, mode, chord, pressed)) {
                 if (IS_PRESSED(record->event)) {
+#ifdef STENO_HISTORY_SIZE
+                    if (pressed == 0) {
+                        stroke_start = record->event.time;
+                    }
+#endif
                     ++pressed;
                 } else {
                     --pressed;
                     if (pressed <= 0) {
                         pressed = 0;
-                        send_steno_chord();
+                        send_steno_chord(record->event.time);
                     }
                 }
             }
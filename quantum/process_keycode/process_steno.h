@@ -20,8 +20,34 @@
 
 typedef enum { STENO_MODE_BOLT, STENO_MODE_GEMINI } steno_mode_t;
 
+/* Sends steno packets over raw HID instead of the virtual serial port, as
+ * STENO_RAW_HID_ID, the steno mode and then the serial packet */
+#ifdef STENO_RAW_HID
+#    ifndef STENO_RAW_HID_ID
+#        define STENO_RAW_HID_ID 0x53
+#    endif
+#    ifndef STENO_RAW_HID_REPORT_SIZE
+#        define STENO_RAW_HID_REPORT_SIZE 32
+#    endif
+#endif
+
+/* One sent chord, timestamps are timer_read() values */
+typedef struct {
+    uint16_t     pressed;   // first key of the stroke went down
+    uint16_t     released;  // last key of the stroke went up
+    uint16_t     sent;      // packet was handed to the USB stack
+    steno_mode_t mode;
+    uint8_t      chord[6];
+} steno_stroke_t;
+
 bool     process_steno(uint16_t keycode, keyrecord_t *record);
 void     steno_init(void);
 void     steno_set_mode(steno_mode_t mode);
 uint8_t *steno_get_state(void);
 uint8_t *steno_get_chord(void);
+
+#ifdef STENO_HISTORY_SIZE
+uint8_t steno_history_count(void);
+/* Most recent stroke first, NULL past the end of the history */
+const steno_stroke_t *steno_history_get(uint8_t age);
+#endif
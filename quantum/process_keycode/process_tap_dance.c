@@ -14,13 +14,22 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 #include "quantum.h"
+#include <string.h>
+#include "deadline.h"
 
 #ifndef NO_ACTION_ONESHOT
 uint8_t get_oneshot_mods(void);
 #endif
 
 static uint16_t last_td;
-static int8_t   highest_td = -1;
+
+/* Indices of the dances in progress (count > 0), oldest first. Timeouts and
+ * interrupts only ever look at these, not at the whole tap_dance_actions[]. */
+static uint8_t active_td[TAP_DANCE_MAX_ACTIVE];
+static uint8_t active_count = 0;
+
+/* Due when the earliest of the active dances times out */
+static deadline_t td_deadline;
 
 void qk_tap_dance_pair_on_each_tap(qk_tap_dance_state_t *state, void *user_data) {
     qk_tap_dance_pair_t *pair = (qk_tap_dance_pair_t *)user_data;
@@ -102,23 +111,93 @@ static inline void process_tap_dance_action_on_reset(qk_tap_dance_action_t *acti
     send_keyboard_report();
 }
 
-void preprocess_tap_dance(uint16_t keycode, keyrecord_t *record) {
-    qk_tap_dance_action_t *action;
+static void remove_active_td(uint8_t idx) {
+    for (uint8_t i = 0; i < active_count; i++) {
+        if (active_td[i] == idx) {
+            active_count--;
+            memmove(&active_td[i], &active_td[i + 1], active_count - i);
+            return;
+        }
+    }
+}
 
-    if (!record->event.pressed) return;
+/* Finishes and resets the dance at position i of active_td. Returns the
+ * position of the next dance, as the callbacks may remove any dance from the
+ * list, including this one. */
+static uint8_t end_active_td(uint8_t i) {
+    uint8_t                idx    = active_td[i];
+    qk_tap_dance_action_t *action = &tap_dance_actions[idx];
+
+    process_tap_dance_action_on_dance_finished(action);
+    reset_tap_dance(&action->state);
+
+    return (i < active_count && active_td[i] == idx) ? i + 1 : i;
+}
+
+static void add_active_td(uint8_t idx) {
+    while (active_count == TAP_DANCE_MAX_ACTIVE) {
+        // Too many dances at once, the oldest one is ended early. If it is
+        // still held, it is reset when it is released.
+        uint8_t oldest = active_td[0];
+        end_active_td(0);
+        remove_active_td(oldest);
+    }
+    active_td[active_count++] = idx;
+}
+
+static uint16_t tap_dance_term(qk_tap_dance_action_t *action) {
+    if (action->custom_tapping_term > 0) {
+        return action->custom_tapping_term;
+    }
+#ifdef TAPPING_TERM_PER_KEY
+    return get_tapping_term(action->state.keycode, NULL);
+#else
+    return TAPPING_TERM;
+#endif
+}
+
+static void tap_dance_timeout(deadline_t *deadline) { matrix_scan_tap_dance(); }
 
-    if (highest_td == -1) return;
+/* Points td_deadline at the first dance to time out, a dance times out once
+ * more than its term has passed since its last tap. Finished dances that are
+ * still held only wait for their release, so they are left out. */
+static void schedule_tap_dance_timeout(void) {
+    uint32_t next = UINT32_MAX;
 
-    for (int i = 0; i <= highest_td; i++) {
-        action = &tap_dance_actions[i];
-        if (action->state.count) {
-            if (keycode == action->state.keycode && keycode == last_td) continue;
-            action->state.interrupted          = true;
-            action->state.interrupting_keycode = keycode;
-            process_tap_dance_action_on_dance_finished(action);
-            reset_tap_dance(&action->state);
+    for (uint8_t i = 0; i < active_count; i++) {
+        qk_tap_dance_action_t *action = &tap_dance_actions[active_td[i]];
+        if (action->state.finished) {
+            continue;
+        }
+        uint16_t elapsed = timer_elapsed(action->state.timer);
+        uint16_t term    = tap_dance_term(action);
+        uint32_t left    = elapsed > term ? 0 : (uint32_t)term - elapsed + 1;
+        if (left < next) {
+            next = left;
         }
     }
+
+    if (next == UINT32_MAX) {
+        deadline_cancel(&td_deadline);
+    } else {
+        deadline_schedule(&td_deadline, next, tap_dance_timeout);
+    }
+}
+
+void preprocess_tap_dance(uint16_t keycode, keyrecord_t *record) {
+    if (!record->event.pressed) return;
+
+    // Dances are interrupted in the order they were started
+    for (uint8_t i = 0; i < active_count;) {
+        qk_tap_dance_action_t *action = &tap_dance_actions[active_td[i]];
+        if (keycode == action->state.keycode && keycode == last_td) {
+            i++;
+            continue;
+        }
+        action->state.interrupted          = true;
+        action->state.interrupting_keycode = keycode;
+        i                                  = end_active_td(i);
+    }
 }
 
 bool process_tap_dance(uint16_t keycode, keyrecord_t *record) {
@@ -127,11 +206,13 @@ bool process_tap_dance(uint16_t keycode, keyrecord_t *record) {
 
     switch (keycode) {
         case QK_TAP_DANCE ... QK_TAP_DANCE_MAX:
-            if ((int16_t)idx > highest_td) highest_td = idx;
             action = &tap_dance_actions[idx];
 
             action->state.pressed = record->event.pressed;
             if (record->event.pressed) {
+                if (!action->state.count) {
+                    add_active_td(idx);
+                }
                 action->state.keycode = keycode;
                 action->state.count++;
                 action->state.timer = timer_read();
@@ -145,6 +226,7 @@ bool process_tap_dance(uint16_t keycode, keyrecord_t *record) {
                 process_tap_dance_action_on_each_tap(action);
 
                 last_td = keycode;
+                schedule_tap_dance_timeout();
             } else {
                 if (action->state.count && action->state.finished) {
                     reset_tap_dance(&action->state);
@@ -158,25 +240,15 @@ bool process_tap_dance(uint16_t keycode, keyrecord_t *record) {
 }
 
 void matrix_scan_tap_dance() {
-    if (highest_td == -1) return;
-    uint16_t tap_user_defined;
-
-    for (uint8_t i = 0; i <= highest_td; i++) {
-        qk_tap_dance_action_t *action = &tap_dance_actions[i];
-        if (action->custom_tapping_term > 0) {
-            tap_user_defined = action->custom_tapping_term;
+    for (uint8_t i = 0; i < active_count;) {
+        qk_tap_dance_action_t *action = &tap_dance_actions[active_td[i]];
+        if (!action->state.finished && timer_elapsed(action->state.timer) > tap_dance_term(action)) {
+            i = end_active_td(i);
         } else {
-#ifdef TAPPING_TERM_PER_KEY
-            tap_user_defined = get_tapping_term(action->state.keycode, NULL);
-#else
-            tap_user_defined = TAPPING_TERM;
-#endif
-        }
-        if (action->state.count && timer_elapsed(action->state.timer) > tap_user_defined) {
-            process_tap_dance_action_on_dance_finished(action);
-            reset_tap_dance(&action->state);
+            i++;
         }
     }
+    schedule_tap_dance_timeout();
 }
 
 void reset_tap_dance(qk_tap_dance_state_t *state) {
@@ -193,4 +265,6 @@ void reset_tap_dance(qk_tap_dance_state_t *state) {
     state->finished             = false;
     state->interrupting_keycode = 0;
     last_td                     = 0;
+
+    remove_active_td(state->keycode - QK_TAP_DANCE);
 }
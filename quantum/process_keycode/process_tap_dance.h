@@ -35,6 +35,11 @@ typedef struct {
 
 #    define TD(n) (QK_TAP_DANCE | ((n)&0xFF))
 
+/* Number of dances that can be in progress at the same time */
+#    ifndef TAP_DANCE_MAX_ACTIVE
+#        define TAP_DANCE_MAX_ACTIVE 8
+#    endif
+
 typedef void (*qk_tap_dance_user_fn_t)(qk_tap_dance_state_t *state, void *user_data);
 
 typedef struct {
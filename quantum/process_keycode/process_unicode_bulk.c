@@ -0,0 +1,391 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Bulk Unicode output.
+ *
+ * register_unicode() types every code point with tap_code16() and blocking
+ * waits, restoring mods and caps lock after each one. Here the reports for a
+ * whole sequence of code points are computed up front as (mods, key) pairs
+ * and streamed from a queue, one per main loop iteration:
+ *
+ *  - mods and caps lock are saved and restored once per sequence, not per
+ *    code point;
+ *  - a tapped key is released by the report that presses the next key, or
+ *    by the following mod change, e.g. the last hex digit together with Alt
+ *    on macOS. Only a key that is typed twice in a row gets a report of its
+ *    own to release it;
+ *  - reports identical to the previous one are never queued;
+ *  - UNICODE_TYPE_DELAY is waited for without blocking the scan loop.
+ *
+ * Any other keyboard report sent meanwhile is held back (see
+ * send_keyboard_report()) and sent, in order, once the sequence is done, so
+ * taps that follow a code point still arrive after it without the scan loop
+ * waiting for the queue to drain.
+ *
+ * The sequences are those of the built-in unicode_input_start() and
+ * unicode_input_finish(). If a keyboard or keymap overrides either of them,
+ * register_unicode() keeps using the blocking path, which calls them.
+ */
+
+#include "process_unicode_common.h"
+#include "process_unicode_bulk.h"
+
+_Static_assert(UNICODE_BULK_QUEUE_SIZE >= UNICODE_BULK_MAX_REPORTS && UNICODE_BULK_QUEUE_SIZE <= 255, "UNICODE_BULK_QUEUE_SIZE must be between UNICODE_BULK_MAX_REPORTS and 255");
+
+typedef struct {
+    uint8_t mods;
+    uint8_t key;
+    uint8_t delay;  // ms to wait before sending this report
+} unicode_bulk_report_t;
+
+static unicode_bulk_report_t queue[UNICODE_BULK_QUEUE_SIZE];
+static uint8_t               queue_head  = 0;
+static uint8_t               queue_count = 0;
+static uint16_t              sent_timer;
+
+/* Regular reports held back until the sequence is done */
+static report_keyboard_t deferred[UNICODE_BULK_DEFERRED_REPORTS];
+static uint8_t           deferred_head  = 0;
+static uint8_t           deferred_count = 0;
+
+/* Sequence builder state */
+static bool                  active  = false;
+static bool                  closed  = false;
+static bool                  caps    = false;
+static const char *          pending = NULL;
+static unicode_bulk_report_t last;
+static bool                  release_pending = false;
+static uint8_t               release_mods;
+static uint8_t               pending_delay = 0;
+
+static void unicode_bulk_push(uint8_t mods, uint8_t key) {
+    if (last.mods == mods && last.key == key) {
+        return;
+    }
+
+    last = (unicode_bulk_report_t){.mods = mods, .key = key, .delay = pending_delay};
+
+    queue[(uint8_t)(queue_head + queue_count) % UNICODE_BULK_QUEUE_SIZE] = last;
+    queue_count++;
+    pending_delay = 0;
+}
+
+/* Queues a report. The release of a previously tapped key is merged into it,
+ * unless it presses that same key again or changes mods along with a key. */
+static void unicode_bulk_emit(uint8_t mods, uint8_t key) {
+    if (release_pending) {
+        release_pending = false;
+        if (key != KC_NO && (key == last.key || mods != release_mods)) {
+            unicode_bulk_push(release_mods, KC_NO);
+        }
+    }
+    unicode_bulk_push(mods, key);
+}
+
+static void unicode_bulk_settle(void) {
+    if (release_pending) {
+        release_pending = false;
+        unicode_bulk_push(release_mods, KC_NO);
+    }
+}
+
+static void unicode_bulk_delay(uint8_t ms) {
+    unicode_bulk_settle();
+    pending_delay = ms;
+}
+
+/* Splits a basic keycode with optional mods, e.g. LCTL(LSFT(KC_U)), into a
+ * modifier mask and a key. Returns false for any other keycode. */
+static bool unicode_bulk_split(uint16_t keycode, uint8_t *mods, uint8_t *key) {
+    if (keycode > QK_MODS_MAX) {
+        return false;
+    }
+
+    uint8_t mod5 = (keycode >> 8) & 0x1F;
+    *mods        = (mod5 & 0x10) ? (mod5 & 0x0F) << 4 : mod5;
+    *key         = keycode & 0xFF;
+    if (IS_MOD(*key)) {
+        *mods |= MOD_BIT(*key);
+        *key = KC_NO;
+    }
+    return true;
+}
+
+static void unicode_bulk_tap(uint8_t base, uint16_t keycode) {
+    uint8_t mods, key;
+    if (!unicode_bulk_split(keycode, &mods, &key)) {
+        return;
+    }
+    mods |= base;
+
+    if (mods != base) {
+        unicode_bulk_emit(mods, KC_NO);
+    }
+    unicode_bulk_emit(mods, key);
+    release_pending = true;
+    release_mods    = base;
+}
+
+/* Same digits as register_hex32() */
+static void unicode_bulk_hex(uint8_t base, uint32_t hex) {
+    bool leading = true;
+    for (int i = 7; i >= 0; i--) {
+        uint8_t digit = (hex >> (i * 4)) & 0xF;
+        if (digit != 0 || i <= 3) {
+            leading = false;
+        }
+        if (!leading) {
+            unicode_bulk_tap(base, hex_to_keycode(digit));
+        }
+    }
+}
+
+static bool unicode_bulk_supported(void) {
+    if (unicode_input_start != unicode_input_start_default || unicode_input_finish != unicode_input_finish_default) {
+        return false;
+    }
+
+    uint8_t mods, key;
+    switch (unicode_config.input_mode) {
+        case UC_MAC:
+            // The key is held while typing, so it has to be a modifier
+            return unicode_bulk_split(UNICODE_KEY_MAC, &mods, &key) && key == KC_NO;
+        case UC_LNX:
+            return unicode_bulk_split(UNICODE_KEY_LNX, &mods, &key);
+        case UC_WINC:
+            return unicode_bulk_split(UNICODE_KEY_WINC, &mods, &key);
+        default:
+            return true;
+    }
+}
+
+static void unicode_bulk_begin(void) {
+    active          = true;
+    closed          = false;
+    last            = (unicode_bulk_report_t){.mods = 0xFF, .key = 0xFF};
+    release_pending = false;
+    pending_delay   = 0;
+
+    caps = unicode_config.input_mode == UC_LNX && host_keyboard_led_state().caps_lock;
+    if (caps) {
+        unicode_bulk_tap(0, KC_CAPS);
+    }
+}
+
+static void unicode_bulk_close(void) {
+    if (caps) {
+        unicode_bulk_tap(0, KC_CAPS);
+    }
+    unicode_bulk_settle();
+    closed = true;
+}
+
+/* Queues the reports for one code point, see unicode_input_start() and
+ * unicode_input_finish() for the sequences */
+static void unicode_bulk_encode(uint32_t code_point) {
+    uint8_t mods = 0, key;
+
+    if (code_point > 0x10FFFF || (code_point > 0xFFFF && unicode_config.input_mode == UC_WIN)) {
+        return;
+    }
+
+    switch (unicode_config.input_mode) {
+        case UC_MAC:
+            unicode_bulk_split(UNICODE_KEY_MAC, &mods, &key);
+            unicode_bulk_emit(mods, KC_NO);
+            unicode_bulk_delay(UNICODE_TYPE_DELAY);
+            if (code_point > 0xFFFF) {
+                code_point -= 0x10000;
+                unicode_bulk_hex(mods, (code_point >> 10) + 0xD800);
+                unicode_bulk_hex(mods, (code_point & 0x3FF) + 0xDC00);
+            } else {
+                unicode_bulk_hex(mods, code_point);
+            }
+            unicode_bulk_emit(0, KC_NO);
+            break;
+        case UC_LNX:
+            unicode_bulk_tap(0, UNICODE_KEY_LNX);
+            unicode_bulk_delay(UNICODE_TYPE_DELAY);
+            unicode_bulk_hex(0, code_point);
+            unicode_bulk_tap(0, KC_SPC);
+            break;
+        case UC_WIN:
+            mods = MOD_BIT(KC_LALT);
+            unicode_bulk_emit(mods, KC_NO);
+            unicode_bulk_tap(mods, KC_PPLS);
+            unicode_bulk_delay(UNICODE_TYPE_DELAY);
+            unicode_bulk_hex(mods, code_point);
+            unicode_bulk_emit(0, KC_NO);
+            break;
+        case UC_WINC:
+            unicode_bulk_tap(0, UNICODE_KEY_WINC);
+            unicode_bulk_tap(0, KC_U);
+            unicode_bulk_delay(UNICODE_TYPE_DELAY);
+            unicode_bulk_hex(0, code_point);
+            unicode_bulk_tap(0, KC_ENTER);
+            break;
+        default:
+            unicode_bulk_delay(UNICODE_TYPE_DELAY);
+            unicode_bulk_hex(0, code_point);
+            break;
+    }
+}
+
+static void unicode_bulk_refill(void) {
+    while (pending) {
+        if (!*pending) {
+            pending = NULL;
+            break;
+        }
+        if (UNICODE_BULK_QUEUE_SIZE - queue_count < UNICODE_BULK_MAX_REPORTS) {
+            return;
+        }
+
+        int32_t code_point;
+        pending = decode_utf8(pending, &code_point);
+        if (code_point >= 0) {
+            unicode_bulk_encode(code_point);
+        }
+    }
+
+    if (active && !closed && UNICODE_BULK_QUEUE_SIZE - queue_count >= UNICODE_BULK_MAX_REPORTS) {
+        unicode_bulk_close();
+    }
+}
+
+/* Sends the next queued report. Returns false if it is not due yet, unless
+ * blocking is set in which case it waits for it. */
+static bool unicode_bulk_send_next(bool blocking) {
+    unicode_bulk_report_t *next = &queue[queue_head];
+
+    while (timer_elapsed(sent_timer) < next->delay) {
+        if (!blocking) {
+            return false;
+        }
+        wait_ms(1);
+    }
+
+    report_keyboard_t report = {0};
+    report.mods              = next->mods;
+    if (next->key != KC_NO) {
+        add_key_to_report(&report, next->key);
+    }
+    host_keyboard_send(&report);
+    sent_timer = timer_read();
+
+    queue_head = (uint8_t)(queue_head + 1) % UNICODE_BULK_QUEUE_SIZE;
+    queue_count--;
+    return true;
+}
+
+static void unicode_bulk_send_deferred(void) {
+    host_keyboard_send(&deferred[deferred_head]);
+    deferred_head = (uint8_t)(deferred_head + 1) % UNICODE_BULK_DEFERRED_REPORTS;
+    deferred_count--;
+}
+
+static void unicode_bulk_finish(void) {
+    active = false;
+    // Back to the regular keyboard state, including the mods held before
+    send_keyboard_report();
+}
+
+void unicode_bulk_flush(void) {
+    if (!active) {
+        return;
+    }
+
+    while (pending || !closed || queue_count) {
+        unicode_bulk_refill();
+        if (queue_count) {
+            unicode_bulk_send_next(true);
+        }
+    }
+    while (deferred_count) {
+        unicode_bulk_send_deferred();
+    }
+    unicode_bulk_finish();
+}
+
+void unicode_bulk_task(void) {
+    if (!active) {
+        return;
+    }
+
+    unicode_bulk_refill();
+    if (queue_count) {
+        unicode_bulk_send_next(false);
+    } else if (closed) {
+        if (deferred_count) {
+            unicode_bulk_send_deferred();
+        } else {
+            unicode_bulk_finish();
+        }
+    }
+}
+
+bool unicode_bulk_defer_report(report_keyboard_t *report) {
+    if (!active) {
+        return false;
+    }
+    if (deferred_count == UNICODE_BULK_DEFERRED_REPORTS) {
+        // Out of room, send everything ahead of this report right away
+        unicode_bulk_flush();
+        return false;
+    }
+
+    deferred[(uint8_t)(deferred_head + deferred_count) % UNICODE_BULK_DEFERRED_REPORTS] = *report;
+    deferred_count++;
+    return true;
+}
+
+bool unicode_bulk_busy(void) { return active; }
+
+bool unicode_bulk_code_point(uint32_t code_point) {
+    if (!unicode_bulk_supported()) {
+        return false;
+    }
+
+    // Code points have to follow any held back reports
+    if (pending || closed || deferred_count) {
+        unicode_bulk_flush();
+    }
+    if (!active) {
+        unicode_bulk_begin();
+    }
+    while (UNICODE_BULK_QUEUE_SIZE - queue_count < UNICODE_BULK_MAX_REPORTS) {
+        unicode_bulk_send_next(true);
+    }
+    unicode_bulk_encode(code_point);
+    return true;
+}
+
+bool unicode_bulk_string(const char *str) {
+    if (!unicode_bulk_supported()) {
+        return false;
+    }
+
+    // Code points have to follow any held back reports
+    if (pending || closed || deferred_count) {
+        unicode_bulk_flush();
+    }
+    if (!active) {
+        unicode_bulk_begin();
+    }
+    pending = str;
+    unicode_bulk_refill();
+    return true;
+}
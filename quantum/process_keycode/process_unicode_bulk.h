@@ -0,0 +1,55 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "report.h"
+
+/* Number of keyboard reports that can be queued. A code point needs at most
+ * UNICODE_BULK_MAX_REPORTS of them, so this must be at least that. */
+#ifndef UNICODE_BULK_QUEUE_SIZE
+#    define UNICODE_BULK_QUEUE_SIZE 48
+#endif
+
+#define UNICODE_BULK_MAX_REPORTS 24
+
+/* Number of regular keyboard reports that can wait for the queued Unicode
+ * input. Once they are used up, the next report waits for the queue. */
+#ifndef UNICODE_BULK_DEFERRED_REPORTS
+#    define UNICODE_BULK_DEFERRED_REPORTS 4
+#endif
+
+/* Queues the reports for typing a code point, or a whole UTF-8 string, in the
+ * current input mode. They are sent one per main loop iteration by
+ * unicode_bulk_task(). str must stay valid until unicode_bulk_busy() is false.
+ * Returns false if the input mode cannot be handled here, in which case the
+ * caller has to fall back to the blocking register_unicode(). */
+bool unicode_bulk_code_point(uint32_t code_point);
+bool unicode_bulk_string(const char *str);
+
+bool unicode_bulk_busy(void);
+
+/* Sends everything still queued right away */
+void unicode_bulk_flush(void);
+
+/* Holds back a regular report until the queued Unicode input has been sent,
+ * so it cannot end up in the middle of a code point. Returns false if
+ * nothing is queued, in which case the caller sends it. */
+bool unicode_bulk_defer_report(report_keyboard_t *report);
+
+void unicode_bulk_task(void);
@@ -30,7 +30,7 @@ static int8_t  selected_index;
 #endif
 
 void unicode_input_mode_init(void) {
-    unicode_config.raw = eeprom_read_byte(EECONFIG_UNICODEMODE);
+    unicode_config.raw = eeconfig_read_byte(EECONFIG_UNICODEMODE);
 #if UNICODE_SELECTED_MODES != -1
 #    if UNICODE_CYCLE_PERSIST
     // Find input_mode in selected modes
@@ -75,9 +75,10 @@ void cycle_unicode_input_mode(int8_t offset) {
 #endif
 }
 
-void persist_unicode_input_mode(void) { eeprom_update_byte(EECONFIG_UNICODEMODE, unicode_config.input_mode); }
+void persist_unicode_input_mode(void) { eeconfig_update_byte(EECONFIG_UNICODEMODE, unicode_config.input_mode); }
 
-__attribute__((weak)) void unicode_input_start(void) {
+/* The defaults are aliased, so the bulk output can tell whether they are overridden */
+void unicode_input_start_default(void) {
     unicode_saved_caps_lock = host_keyboard_led_state().caps_lock;
 
     // Note the order matters here!
@@ -110,8 +111,9 @@ __attribute__((weak)) void unicode_input_start(void) {
 
     wait_ms(UNICODE_TYPE_DELAY);
 }
+void unicode_input_start(void) __attribute__((weak, alias("unicode_input_start_default")));
 
-__attribute__((weak)) void unicode_input_finish(void) {
+void unicode_input_finish_default(void) {
     switch (unicode_config.input_mode) {
         case UC_MAC:
             unregister_code(UNICODE_KEY_MAC);
@@ -132,6 +134,7 @@ __attribute__((weak)) void unicode_input_finish(void) {
 
     set_mods(unicode_saved_mods);  // Reregister previously set mods
 }
+void unicode_input_finish(void) __attribute__((weak, alias("unicode_input_finish_default")));
 
 __attribute__((weak)) void unicode_input_cancel(void) {
     switch (unicode_config.input_mode) {
@@ -186,6 +189,12 @@ void register_unicode(uint32_t code_point) {
         return;
     }
 
+#ifdef UNICODE_BULK_ENABLE
+    if (unicode_bulk_code_point(code_point)) {
+        return;
+    }
+#endif
+
     unicode_input_start();
     if (code_point > 0xFFFF && unicode_config.input_mode == UC_MAC) {
         // Convert code point to UTF-16 surrogate pair on macOS
@@ -231,7 +240,7 @@ void send_unicode_hex_string(const char *str) {
 // clang-format on
 
 // Borrowed from https://nullprogram.com/blog/2017/10/06/
-static const char *decode_utf8(const char *str, int32_t *code_point) {
+const char *decode_utf8(const char *str, int32_t *code_point) {
     const char *next;
 
     if (str[0] < 0x80) {  // U+0000-007F
@@ -17,6 +17,9 @@
 #pragma once
 
 #include "quantum.h"
+#ifdef UNICODE_BULK_ENABLE
+#    include "process_unicode_bulk.h"
+#endif
 
 #if defined(UNICODE_ENABLE) + defined(UNICODEMAP_ENABLE) + defined(UCIS_ENABLE) > 1
 #    error "Cannot enable more than one Unicode method (UNICODE, UNICODEMAP, UCIS) at the same time"
@@ -84,12 +87,16 @@ void    persist_unicode_input_mode(void);
 
 void unicode_input_start(void);
 void unicode_input_finish(void);
+void unicode_input_start_default(void);
+void unicode_input_finish_default(void);
 void unicode_input_cancel(void);
 
 void register_hex(uint16_t hex);
 void register_hex32(uint32_t hex);
 void register_unicode(uint32_t code_point);
 
+const char *decode_utf8(const char *str, int32_t *code_point);
+
 void send_unicode_hex_string(const char *str);
 void send_unicode_string(const char *str);
 
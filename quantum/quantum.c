@@ -62,6 +62,10 @@ float bell_song[][2] = SONG(TERMINAL_SOUND);
 #    include "process_auto_shift.h"
 #endif
 
+#ifdef EFFECTS_THREAD_ENABLE
+#    include "effects_thread.h"
+#endif
+
 static void do_code16(uint16_t code, void (*f)(uint8_t)) {
     switch (code) {
         case QK_MODS ... QK_MODS_MAX:
@@ -144,6 +148,7 @@ void reset_keyboard(void) {
 #ifdef HAPTIC_ENABLE
     haptic_shutdown();
 #endif
+    eeconfig_flush();
     bootloader_jump();
 }
 
@@ -183,112 +188,158 @@ void post_process_record_quantum(keyrecord_t *record) {
 /* Core keycode function, hands off handling to other functions,
     then processes internal quantum keycodes, and then processes
     ACTIONs.                                                      */
-bool process_record_quantum(keyrecord_t *record) {
-    uint16_t keycode = get_record_keycode(record, true);
-
-    // This is how you use actions here
-    // if (keycode == KC_LEAD) {
-    //   action_t action;
-    //   action.code = ACTION_DEFAULT_LAYER_SET(0);
-    //   process_action(record, action);
-    //   return false;
-    // }
+typedef bool (*process_record_handler_t)(uint16_t keycode, keyrecord_t *record);
 
-#ifdef VELOCIKEY_ENABLE
-    if (velocikey_enabled() && record->event.pressed) {
-        velocikey_accelerate();
-    }
-#endif
+/* A keycode handler and the range of keycodes it acts on. */
+typedef struct {
+    process_record_handler_t handler;
+    uint16_t                 first;
+    uint16_t                 last;
+} process_record_route_t;
 
-#ifdef WPM_ENABLE
-    if (record->event.pressed) {
-        update_wpm(keycode);
-    }
-#endif
+// Handlers that record, swallow or react to any key see every keycode
+#define PROCESS_ALL(handler) \
+    { handler, 0x0000, 0xFFFF }
+#define PROCESS_RANGE(handler, first, last) \
+    { handler, first, last }
 
-#ifdef TAP_DANCE_ENABLE
-    preprocess_tap_dance(keycode, record);
+#if (defined(RGBLIGHT_ENABLE) || defined(RGB_MATRIX_ENABLE)) && !defined(EFFECTS_THREAD_ENABLE)
+static bool process_rgb_record(uint16_t keycode, keyrecord_t *record) { return process_rgb(keycode, record); }
 #endif
 
-    if (!(
-#if defined(KEY_LOCK_ENABLE)
-            // Must run first to be able to mask key_up events.
-            process_key_lock(&keycode, record) &&
-#endif
+/* Keycode handlers in the order they run, after process_key_lock(). A handler
+ * is only called for keycodes in its range, and returning false stops the
+ * event from reaching the handlers below it. The ranges may be wider than
+ * what a handler reacts to, never narrower. */
+// clang-format off
+static const process_record_route_t PROGMEM process_record_routes[] = {
 #if defined(DYNAMIC_MACRO_ENABLE) && !defined(DYNAMIC_MACRO_USER_CALL)
-            // Must run asap to ensure all keypresses are recorded.
-            process_dynamic_macro(keycode, record) &&
+    // Must run asap to ensure all keypresses are recorded.
+    PROCESS_ALL(process_dynamic_macro),
 #endif
 #if defined(AUDIO_ENABLE) && defined(AUDIO_CLICKY)
-            process_clicky(keycode, record) &&
-#endif  // AUDIO_CLICKY
+    PROCESS_ALL(process_clicky),
+#endif
 #ifdef HAPTIC_ENABLE
-            process_haptic(keycode, record) &&
-#endif  // HAPTIC_ENABLE
-#if defined(RGB_MATRIX_ENABLE)
-            process_rgb_matrix(keycode, record) &&
+    PROCESS_ALL(process_haptic),
+#endif
+#if defined(EFFECTS_THREAD_ENABLE)
+    // RGB matrix and RGB keycode handling is deferred to the effects thread
+    PROCESS_ALL(process_effects_thread),
+#elif defined(RGB_MATRIX_ENABLE)
+    PROCESS_ALL(process_rgb_matrix),
 #endif
 #if defined(VIA_ENABLE)
-            process_record_via(keycode, record) &&
+    PROCESS_ALL(process_record_via),
 #endif
-            process_record_kb(keycode, record) &&
+    PROCESS_ALL(process_record_kb),
 #if defined(SEQUENCER_ENABLE)
-            process_sequencer(keycode, record) &&
+    PROCESS_RANGE(process_sequencer, SQ_ON, SEQUENCER_TRACK_MAX),
 #endif
 #if defined(MIDI_ENABLE) && defined(MIDI_ADVANCED)
-            process_midi(keycode, record) &&
+    PROCESS_RANGE(process_midi, MIDI_TONE_MIN, MI_BENDU),
 #endif
 #ifdef AUDIO_ENABLE
-            process_audio(keycode, record) &&
+    PROCESS_RANGE(process_audio, AU_ON, MUV_DE),
 #endif
 #ifdef BACKLIGHT_ENABLE
-            process_backlight(keycode, record) &&
+    PROCESS_RANGE(process_backlight, BL_ON, BL_BRTG),
 #endif
 #ifdef STENO_ENABLE
-            process_steno(keycode, record) &&
+    PROCESS_RANGE(process_steno, QK_STENO, QK_STENO_MAX),
 #endif
 #if (defined(AUDIO_ENABLE) || (defined(MIDI_ENABLE) && defined(MIDI_BASIC))) && !defined(NO_MUSIC_MODE)
-            process_music(keycode, record) &&
+    // Music mode plays any key
+    PROCESS_ALL(process_music),
 #endif
 #ifdef TAP_DANCE_ENABLE
-            process_tap_dance(keycode, record) &&
+    PROCESS_RANGE(process_tap_dance, QK_TAP_DANCE, QK_TAP_DANCE_MAX),
 #endif
-#if defined(UNICODE_ENABLE) || defined(UNICODEMAP_ENABLE) || defined(UCIS_ENABLE)
-            process_unicode_common(keycode, record) &&
+#ifdef UCIS_ENABLE
+    // UCIS takes over every key while it reads a sequence
+    PROCESS_ALL(process_unicode_common),
+#elif defined(UNICODE_ENABLE) || defined(UNICODEMAP_ENABLE)
+    PROCESS_RANGE(process_unicode_common, UNICODE_MODE_FORWARD, UNICODE_MODE_WINC),
+    PROCESS_RANGE(process_unicode_common, QK_UNICODE, QK_UNICODE_MAX),
 #endif
 #ifdef LEADER_ENABLE
-            process_leader(keycode, record) &&
+    PROCESS_ALL(process_leader),
 #endif
 #ifdef COMBO_ENABLE
-            process_combo(keycode, record) &&
+    PROCESS_ALL(process_combo),
 #endif
 #ifdef PRINTING_ENABLE
-            process_printer(keycode, record) &&
+    PROCESS_ALL(process_printer),
 #endif
 #ifdef AUTO_SHIFT_ENABLE
-            process_auto_shift(keycode, record) &&
+    PROCESS_ALL(process_auto_shift),
 #endif
 #ifdef TERMINAL_ENABLE
-            process_terminal(keycode, record) &&
+    PROCESS_ALL(process_terminal),
 #endif
 #ifdef SPACE_CADET_ENABLE
-            process_space_cadet(keycode, record) &&
+    // Any other key press cancels a pending space cadet tap
+    PROCESS_ALL(process_space_cadet),
 #endif
 #ifdef MAGIC_KEYCODE_ENABLE
-            process_magic(keycode, record) &&
+    PROCESS_RANGE(process_magic, MAGIC_SWAP_CONTROL_CAPSLOCK, MAGIC_EE_HANDS_RIGHT),
 #endif
 #ifdef GRAVE_ESC_ENABLE
-            process_grave_esc(keycode, record) &&
+    PROCESS_RANGE(process_grave_esc, GRAVE_ESC, GRAVE_ESC),
 #endif
-#if defined(RGBLIGHT_ENABLE) || defined(RGB_MATRIX_ENABLE)
-            process_rgb(keycode, record) &&
+#if (defined(RGBLIGHT_ENABLE) || defined(RGB_MATRIX_ENABLE)) && !defined(EFFECTS_THREAD_ENABLE)
+    PROCESS_RANGE(process_rgb_record, RGB_TOG, RGB_MODE_RGBTEST),
 #endif
 #ifdef JOYSTICK_ENABLE
-            process_joystick(keycode, record) &&
+    // Also sends pending axis updates on any key
+    PROCESS_ALL(process_joystick),
 #endif
-            true)) {
+};
+// clang-format on
+
+bool process_record_quantum(keyrecord_t *record) {
+    uint16_t keycode = get_record_keycode(record, true);
+
+    // This is how you use actions here
+    // if (keycode == KC_LEAD) {
+    //   action_t action;
+    //   action.code = ACTION_DEFAULT_LAYER_SET(0);
+    //   process_action(record, action);
+    //   return false;
+    // }
+
+#ifdef VELOCIKEY_ENABLE
+    if (velocikey_enabled() && record->event.pressed) {
+        velocikey_accelerate();
+    }
+#endif
+
+#ifdef WPM_ENABLE
+    if (record->event.pressed) {
+        update_wpm(keycode);
+    }
+#endif
+
+#ifdef TAP_DANCE_ENABLE
+    preprocess_tap_dance(keycode, record);
+#endif
+
+#if defined(KEY_LOCK_ENABLE)
+    // Must run first to be able to mask key_up events.
+    if (!process_key_lock(&keycode, record)) {
         return false;
     }
+#endif
+
+    for (uint8_t i = 0; i < sizeof(process_record_routes) / sizeof(process_record_routes[0]); i++) {
+        if (keycode < pgm_read_word(&process_record_routes[i].first) || keycode > pgm_read_word(&process_record_routes[i].last)) {
+            continue;
+        }
+        process_record_handler_t handler = (process_record_handler_t)pgm_read_ptr(&process_record_routes[i].handler);
+        if (!handler(keycode, record)) {
+            return false;
+        }
+    }
 
     if (record->event.pressed) {
         switch (keycode) {
@@ -621,6 +672,9 @@ void matrix_init_quantum() {
 #ifdef HAPTIC_ENABLE
     haptic_init();
 #endif
+#ifdef LEADER_ENABLE
+    leader_init();
+#endif
 #if defined(BLUETOOTH_ENABLE) && defined(OUTPUT_AUTO_ENABLE)
     set_output(OUTPUT_AUTO);
 #endif
@@ -637,20 +691,22 @@ void matrix_scan_quantum() {
     matrix_scan_sequencer();
 #endif
 
-#ifdef TAP_DANCE_ENABLE
-    matrix_scan_tap_dance();
+#ifdef DYNAMIC_MACRO_ENABLE
+    dynamic_macro_task();
 #endif
 
-#ifdef COMBO_ENABLE
-    matrix_scan_combo();
+#ifdef UNICODE_BULK_ENABLE
+    unicode_bulk_task();
 #endif
 
-#ifdef LED_MATRIX_ENABLE
+#ifndef EFFECTS_THREAD_ENABLE
+#    ifdef LED_MATRIX_ENABLE
     led_matrix_task();
-#endif
+#    endif
 
-#ifdef RGB_MATRIX_ENABLE
+#    ifdef RGB_MATRIX_ENABLE
     rgb_matrix_task();
+#    endif
 #endif
 
 #ifdef WPM_ENABLE
@@ -665,13 +721,21 @@ void matrix_scan_quantum() {
     dip_switch_read(false);
 #endif
 
-#ifdef AUTO_SHIFT_ENABLE
-    autoshift_matrix_scan();
-#endif
-
     matrix_scan_kb();
 }
 
+#ifdef EFFECTS_THREAD_ENABLE
+void effects_task_quantum(void) {
+#    ifdef LED_MATRIX_ENABLE
+    led_matrix_task();
+#    endif
+
+#    ifdef RGB_MATRIX_ENABLE
+    rgb_matrix_task();
+#    endif
+}
+#endif
+
 #ifdef HD44780_ENABLED
 #    include "hd44780.h"
 #endif
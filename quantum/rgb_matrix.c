@@ -43,7 +43,7 @@ __attribute__((weak)) RGB rgb_matrix_hsv_to_rgb(HSV hsv) { return hsv_to_rgb(hsv
 
 // ------------------------------------------
 // -----Begin rgb effect includes macros-----
-#define RGB_MATRIX_EFFECT(name)
+#define RGB_MATRIX_EFFECT(name, ...)
 #define RGB_MATRIX_CUSTOM_EFFECT_IMPLS
 
 #include "rgb_matrix_animations/rgb_matrix_effects.inc"
@@ -117,6 +117,39 @@ __attribute__((weak)) RGB rgb_matrix_hsv_to_rgb(HSV hsv) { return hsv_to_rgb(hsv
 #    define RGB_MATRIX_STARTUP_SPD UINT8_MAX / 2
 #endif
 
+// Static effects are redrawn this often, or as soon as the config changes
+#if !defined(RGB_MATRIX_STATIC_FLUSH_LIMIT)
+#    define RGB_MATRIX_STATIC_FLUSH_LIMIT RGB_MATRIX_LED_FLUSH_LIMIT
+#endif
+
+#if defined(RGB_MATRIX_PROFILE) || defined(RGB_MATRIX_ADAPTIVE_CHUNK)
+#    if !defined(PROTOCOL_CHIBIOS) || !defined(DWT_CTRL_CYCCNTENA_Msk)
+#        error "RGB_MATRIX_PROFILE and RGB_MATRIX_ADAPTIVE_CHUNK need a Cortex-M DWT cycle counter"
+#    endif
+// Clock (Hz) the DWT cycle counter runs at
+#    if !defined(RGB_MATRIX_CPU_FREQUENCY)
+#        if defined(STM32_SYSCLK)
+#            define RGB_MATRIX_CPU_FREQUENCY STM32_SYSCLK
+#        else
+#            error "Define RGB_MATRIX_CPU_FREQUENCY to the core clock in Hz for this MCU"
+#        endif
+#    endif
+#    define RGB_MATRIX_CYCLES_PER_US (RGB_MATRIX_CPU_FREQUENCY / 1000000)
+#endif
+
+#ifdef RGB_MATRIX_ADAPTIVE_CHUNK
+// Time (ms) from the start of a frame to its flush that the chunk size is grown to meet
+#    if !defined(RGB_MATRIX_FRAME_TIME)
+#        define RGB_MATRIX_FRAME_TIME RGB_MATRIX_LED_FLUSH_LIMIT
+#    endif
+// Time (us) a single render call may take before the chunk size is halved
+#    if !defined(RGB_MATRIX_RENDER_BUDGET)
+#        define RGB_MATRIX_RENDER_BUDGET 1000
+#    endif
+#endif
+
+#define RGB_MATRIX_DEFAULT_CHUNK (RGB_MATRIX_LED_PROCESS_LIMIT > 0 && RGB_MATRIX_LED_PROCESS_LIMIT < DRIVER_LED_TOTAL ? RGB_MATRIX_LED_PROCESS_LIMIT : DRIVER_LED_TOTAL)
+
 // globals
 bool         g_suspend_state = false;
 rgb_config_t rgb_matrix_config;  // TODO: would like to prefix this with g_ for global consistancy, do this in another pr
@@ -127,12 +160,28 @@ uint8_t g_rgb_frame_buffer[MATRIX_ROWS][MATRIX_COLS] = {{0}};
 #ifdef RGB_MATRIX_KEYREACTIVE_ENABLED
 last_hit_t g_last_hit_tracker;
 #endif  // RGB_MATRIX_KEYREACTIVE_ENABLED
+#ifdef RGB_MATRIX_ADAPTIVE_CHUNK
+uint8_t g_rgb_led_chunk = RGB_MATRIX_DEFAULT_CHUNK;
+#endif  // RGB_MATRIX_ADAPTIVE_CHUNK
 
 // internals
 static uint8_t         rgb_last_enable   = UINT8_MAX;
 static uint8_t         rgb_last_effect   = UINT8_MAX;
+static uint32_t        rgb_last_config   = 0;
+static uint8_t         rgb_last_speed    = 0;
+static led_flags_t     rgb_last_flags    = 0xFF;
 static effect_params_t rgb_effect_params = {0, 0xFF};
 static rgb_task_states rgb_task_state    = SYNCING;
+#if defined(RGB_MATRIX_PROFILE) || defined(RGB_MATRIX_ADAPTIVE_CHUNK)
+static uint32_t rgb_frame_start;     // DWT cycle count at the start of the frame
+static uint32_t rgb_frame_max_call;  // us
+#endif
+#ifdef RGB_MATRIX_PROFILE
+static rgb_matrix_effect_stats_t rgb_effect_stats[RGB_MATRIX_EFFECT_MAX];
+#endif  // RGB_MATRIX_PROFILE
+#ifdef RGB_MATRIX_ADAPTIVE_CHUNK
+static uint8_t rgb_effect_chunk[RGB_MATRIX_EFFECT_MAX];  // 0 until the effect first runs
+#endif  // RGB_MATRIX_ADAPTIVE_CHUNK
 #if RGB_DISABLE_TIMEOUT > 0
 static uint32_t rgb_anykey_timer;
 #endif  // RGB_DISABLE_TIMEOUT > 0
@@ -143,9 +192,9 @@ static uint32_t rgb_timer_buffer;
 static last_hit_t last_hit_buffer;
 #endif  // RGB_MATRIX_KEYREACTIVE_ENABLED
 
-void eeconfig_read_rgb_matrix(void) { eeprom_read_block(&rgb_matrix_config, EECONFIG_RGB_MATRIX, sizeof(rgb_matrix_config)); }
+void eeconfig_read_rgb_matrix(void) { eeconfig_read_block(&rgb_matrix_config, EECONFIG_RGB_MATRIX, sizeof(rgb_matrix_config)); }
 
-void eeconfig_update_rgb_matrix(void) { eeprom_update_block(&rgb_matrix_config, EECONFIG_RGB_MATRIX, sizeof(rgb_matrix_config)); }
+void eeconfig_update_rgb_matrix(void) { eeconfig_update_block(&rgb_matrix_config, EECONFIG_RGB_MATRIX, sizeof(rgb_matrix_config)); }
 
 void eeconfig_update_rgb_matrix_default(void) {
     dprintf("eeconfig_update_rgb_matrix_default\n");
@@ -264,6 +313,66 @@ static bool rgb_matrix_none(effect_params_t *params) {
     return false;
 }
 
+// ---------------------------------------------
+// -----Begin rgb effect descriptor macros------
+#define RGB_MATRIX_EFFECT_DESCRIPTOR(name, flags, cost, ...) {name, flags, cost},
+
+static const rgb_matrix_effect_t rgb_matrix_effects[RGB_MATRIX_EFFECT_MAX] PROGMEM = {
+    [RGB_MATRIX_NONE] = {rgb_matrix_none, RGB_MATRIX_EFFECT_STATIC, RGB_MATRIX_COST_LOW},
+
+#define RGB_MATRIX_EFFECT(name, ...) [RGB_MATRIX_##name] = RGB_MATRIX_EFFECT_DESCRIPTOR(name, ##__VA_ARGS__, 0, 0)
+#include "rgb_matrix_animations/rgb_matrix_effects.inc"
+#undef RGB_MATRIX_EFFECT
+
+#if defined(RGB_MATRIX_CUSTOM_KB) || defined(RGB_MATRIX_CUSTOM_USER)
+#    define RGB_MATRIX_EFFECT(name, ...) [RGB_MATRIX_CUSTOM_##name] = RGB_MATRIX_EFFECT_DESCRIPTOR(name, ##__VA_ARGS__, 0, 0)
+#    ifdef RGB_MATRIX_CUSTOM_KB
+#        include "rgb_matrix_kb.inc"
+#    endif
+#    ifdef RGB_MATRIX_CUSTOM_USER
+#        include "rgb_matrix_user.inc"
+#    endif
+#    undef RGB_MATRIX_EFFECT
+#endif
+};
+
+#undef RGB_MATRIX_EFFECT_DESCRIPTOR
+// -----End rgb effect descriptor macros--------
+// ---------------------------------------------
+
+uint8_t rgb_matrix_get_effect_flags(uint8_t mode) { return mode < RGB_MATRIX_EFFECT_MAX ? pgm_read_byte(&rgb_matrix_effects[mode].flags) : 0; }
+
+#ifdef RGB_MATRIX_ADAPTIVE_CHUNK
+static uint8_t rgb_matrix_effect_chunk(uint8_t effect) {
+    if (effect >= RGB_MATRIX_EFFECT_MAX) {
+        return RGB_MATRIX_DEFAULT_CHUNK;
+    }
+
+    if (!rgb_effect_chunk[effect]) {
+        // Start from the cost hint, the frame timings take it from there
+        uint8_t cost             = pgm_read_byte(&rgb_matrix_effects[effect].cost);
+        uint8_t chunk            = RGB_MATRIX_DEFAULT_CHUNK / (cost ? cost : 1);
+        rgb_effect_chunk[effect] = chunk ? chunk : 1;
+    }
+    return rgb_effect_chunk[effect];
+}
+
+/* Halves the chunk size of an effect when one of its render calls held up the
+ * scan loop for longer than RGB_MATRIX_RENDER_BUDGET, and grows it while its
+ * frames take longer than RGB_MATRIX_FRAME_TIME to render and flush. */
+static void rgb_matrix_adapt_chunk(uint8_t effect, uint32_t frame_time) {
+    uint8_t chunk = g_rgb_led_chunk;
+
+    if (rgb_frame_max_call > RGB_MATRIX_RENDER_BUDGET) {
+        chunk = chunk > 1 ? chunk / 2 : 1;
+    } else if (frame_time > RGB_MATRIX_FRAME_TIME * 1000UL && rgb_frame_max_call < RGB_MATRIX_RENDER_BUDGET) {
+        uint8_t step = chunk / 4 + 1;
+        chunk        = DRIVER_LED_TOTAL - chunk > step ? chunk + step : DRIVER_LED_TOTAL;
+    }
+    rgb_effect_chunk[effect] = chunk;
+}
+#endif  // RGB_MATRIX_ADAPTIVE_CHUNK
+
 static void rgb_task_timers(void) {
 #if defined(RGB_MATRIX_KEYREACTIVE_ENABLED) || RGB_DISABLE_TIMEOUT > 0
     uint32_t deltaTime = timer_elapsed32(rgb_timer_buffer);
@@ -294,14 +403,33 @@ static void rgb_task_timers(void) {
 #endif  // RGB_MATRIX_KEYREACTIVE_ENABLED
 }
 
-static void rgb_task_sync(void) {
+static bool rgb_task_settings_changed(void) { return rgb_matrix_config.raw != rgb_last_config || rgb_matrix_config.speed != rgb_last_speed || rgb_effect_params.flags != rgb_last_flags; }
+
+static void rgb_task_sync(uint8_t effect) {
+    uint32_t limit = RGB_MATRIX_LED_FLUSH_LIMIT;
+    if (rgb_matrix_get_effect_flags(effect) & RGB_MATRIX_EFFECT_STATIC) {
+        limit = rgb_task_settings_changed() ? 0 : RGB_MATRIX_STATIC_FLUSH_LIMIT;
+    }
+
     // next task
-    if (timer_elapsed32(g_rgb_timer) >= RGB_MATRIX_LED_FLUSH_LIMIT) rgb_task_state = STARTING;
+    if (timer_elapsed32(g_rgb_timer) >= limit) rgb_task_state = STARTING;
 }
 
-static void rgb_task_start(void) {
+static void rgb_task_start(uint8_t effect) {
     // reset iter
     rgb_effect_params.iter = 0;
+    rgb_last_config        = rgb_matrix_config.raw;
+    rgb_last_speed         = rgb_matrix_config.speed;
+    rgb_last_flags         = rgb_effect_params.flags;
+
+#ifdef RGB_MATRIX_ADAPTIVE_CHUNK
+    // the chunk size only changes between frames
+    g_rgb_led_chunk = rgb_matrix_effect_chunk(effect);
+#endif  // RGB_MATRIX_ADAPTIVE_CHUNK
+#if defined(RGB_MATRIX_PROFILE) || defined(RGB_MATRIX_ADAPTIVE_CHUNK)
+    rgb_frame_start    = DWT->CYCCNT;
+    rgb_frame_max_call = 0;
+#endif
 
     // update double buffers
     g_rgb_timer = rgb_timer_buffer;
@@ -317,44 +445,38 @@ static void rgb_task_render(uint8_t effect) {
     bool rendering         = false;
     rgb_effect_params.init = (effect != rgb_last_effect) || (rgb_matrix_config.enable != rgb_last_enable);
 
+    // Factory default magic value
+    if (effect == UINT8_MAX) {
+        rgb_matrix_test();
+        rgb_task_state = FLUSHING;
+        return;
+    }
+
     // each effect can opt to do calculations
     // and/or request PWM buffer updates.
-    switch (effect) {
-        case RGB_MATRIX_NONE:
-            rendering = rgb_matrix_none(&rgb_effect_params);
-            break;
-
-// ---------------------------------------------
-// -----Begin rgb effect switch case macros-----
-#define RGB_MATRIX_EFFECT(name, ...)          \
-    case RGB_MATRIX_##name:                   \
-        rendering = name(&rgb_effect_params); \
-        break;
-#include "rgb_matrix_animations/rgb_matrix_effects.inc"
-#undef RGB_MATRIX_EFFECT
-
-#if defined(RGB_MATRIX_CUSTOM_KB) || defined(RGB_MATRIX_CUSTOM_USER)
-#    define RGB_MATRIX_EFFECT(name, ...)          \
-        case RGB_MATRIX_CUSTOM_##name:            \
-            rendering = name(&rgb_effect_params); \
-            break;
-#    ifdef RGB_MATRIX_CUSTOM_KB
-#        include "rgb_matrix_kb.inc"
-#    endif
-#    ifdef RGB_MATRIX_CUSTOM_USER
-#        include "rgb_matrix_user.inc"
-#    endif
-#    undef RGB_MATRIX_EFFECT
-#endif
-            // -----End rgb effect switch case macros-------
-            // ---------------------------------------------
-
-        // Factory default magic value
-        case UINT8_MAX: {
-            rgb_matrix_test();
-            rgb_task_state = FLUSHING;
+    if (effect < RGB_MATRIX_EFFECT_MAX) {
+        bool (*render)(effect_params_t *) = pgm_read_ptr(&rgb_matrix_effects[effect].render);
+#if defined(RGB_MATRIX_PROFILE) || defined(RGB_MATRIX_ADAPTIVE_CHUNK)
+        uint32_t call_start = DWT->CYCCNT;
+        rendering           = render(&rgb_effect_params);
+        uint32_t elapsed    = (DWT->CYCCNT - call_start) / RGB_MATRIX_CYCLES_PER_US;
+
+        if (elapsed > rgb_frame_max_call) {
+            rgb_frame_max_call = elapsed;
+        }
+#    ifdef RGB_MATRIX_PROFILE
+        rgb_matrix_effect_stats_t *stats     = &rgb_effect_stats[effect];
+        uint32_t                   render_us = stats->render_us + elapsed;
+        stats->calls++;
+        stats->render_time += render_us / 1000;
+        stats->render_us = render_us % 1000;
+        if (elapsed > stats->max_call) {
+            stats->max_call = elapsed;
         }
-            return;
+#    endif  // RGB_MATRIX_PROFILE
+#else
+        rendering = render(&rgb_effect_params);
+#endif
     }
 
     rgb_effect_params.iter++;
@@ -370,6 +492,27 @@ static void rgb_task_render(uint8_t effect) {
 }
 
 static void rgb_task_flush(uint8_t effect) {
+#if defined(RGB_MATRIX_PROFILE) || defined(RGB_MATRIX_ADAPTIVE_CHUNK)
+    if (effect < RGB_MATRIX_EFFECT_MAX) {
+        uint32_t frame_time = (DWT->CYCCNT - rgb_frame_start) / RGB_MATRIX_CYCLES_PER_US;
+#    ifdef RGB_MATRIX_PROFILE
+        rgb_matrix_effect_stats_t *stats = &rgb_effect_stats[effect];
+        stats->frames++;
+#        ifdef RGB_MATRIX_ADAPTIVE_CHUNK
+        stats->chunk = g_rgb_led_chunk;
+#        else
+        stats->chunk = RGB_MATRIX_DEFAULT_CHUNK;
+#        endif
+        if (frame_time > stats->max_frame) {
+            stats->max_frame = frame_time;
+        }
+#    endif  // RGB_MATRIX_PROFILE
+#    ifdef RGB_MATRIX_ADAPTIVE_CHUNK
+        rgb_matrix_adapt_chunk(effect, frame_time);
+#    endif  // RGB_MATRIX_ADAPTIVE_CHUNK
+    }
+#endif
+
     // update last trackers after the first full render so we can init over several frames
     rgb_last_effect = effect;
     rgb_last_enable = rgb_matrix_config.enable;
@@ -399,7 +542,7 @@ void rgb_matrix_task(void) {
 
     switch (rgb_task_state) {
         case STARTING:
-            rgb_task_start();
+            rgb_task_start(effect);
             break;
         case RENDERING:
             rgb_task_render(effect);
@@ -412,7 +555,7 @@ void rgb_matrix_task(void) {
             rgb_task_flush(effect);
             break;
         case SYNCING:
-            rgb_task_sync();
+            rgb_task_sync(effect);
             break;
     }
 }
@@ -432,10 +575,10 @@ void rgb_matrix_indicators_advanced(effect_params_t *params) {
      * and not sure which would be better. Otherwise, this should be called from
      * rgb_task_render, right before the iter++ line.
      */
-#if defined(RGB_MATRIX_LED_PROCESS_LIMIT) && RGB_MATRIX_LED_PROCESS_LIMIT > 0 && RGB_MATRIX_LED_PROCESS_LIMIT < DRIVER_LED_TOTAL
-    uint8_t min = RGB_MATRIX_LED_PROCESS_LIMIT * (params->iter - 1);
-    uint8_t max = min + RGB_MATRIX_LED_PROCESS_LIMIT;
-    if (max > DRIVER_LED_TOTAL) max = DRIVER_LED_TOTAL;
+#if defined(RGB_MATRIX_ADAPTIVE_CHUNK) || (defined(RGB_MATRIX_LED_PROCESS_LIMIT) && RGB_MATRIX_LED_PROCESS_LIMIT > 0 && RGB_MATRIX_LED_PROCESS_LIMIT < DRIVER_LED_TOTAL)
+    uint8_t min = RGB_MATRIX_LED_CHUNK * (params->iter - 1);
+    uint8_t max = min + RGB_MATRIX_LED_CHUNK;
+    if (max < min || max > DRIVER_LED_TOTAL) max = DRIVER_LED_TOTAL;
 #else
     uint8_t min = 0;
     uint8_t max = DRIVER_LED_TOTAL;
@@ -475,6 +618,11 @@ void rgb_matrix_init(void) {
         eeconfig_update_rgb_matrix_default();
     }
     eeconfig_debug_rgb_matrix();  // display current eeprom values
+
+#if defined(RGB_MATRIX_PROFILE) || defined(RGB_MATRIX_ADAPTIVE_CHUNK)
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+#endif
 }
 
 void rgb_matrix_set_suspend_state(bool state) {
@@ -622,3 +770,21 @@ void rgb_matrix_decrease_speed(void) { rgb_matrix_decrease_speed_helper(true); }
 led_flags_t rgb_matrix_get_flags(void) { return rgb_effect_params.flags; }
 
 void rgb_matrix_set_flags(led_flags_t flags) { rgb_effect_params.flags = flags; }
+
+#ifdef RGB_MATRIX_PROFILE
+const rgb_matrix_effect_stats_t *rgb_matrix_get_effect_stats(uint8_t mode) { return mode < RGB_MATRIX_EFFECT_MAX ? &rgb_effect_stats[mode] : NULL; }
+
+void rgb_matrix_clear_effect_stats(void) { memset(rgb_effect_stats, 0, sizeof(rgb_effect_stats)); }
+
+/** \brief Dump the render statistics of every effect that has run to the console */
+void rgb_matrix_print_effect_stats(void) {
+    xprintf("mode flags cost chunk frames  calls maxcall maxframe render\n");
+    for (uint8_t i = 0; i < RGB_MATRIX_EFFECT_MAX; i++) {
+        const rgb_matrix_effect_stats_t *stats = &rgb_effect_stats[i];
+        if (!stats->frames) {
+            continue;
+        }
+        xprintf("%4u %5u %4u %5u %6lu %6lu %7lu %8lu %6lu\n", i, rgb_matrix_get_effect_flags(i), pgm_read_byte(&rgb_matrix_effects[i].cost), stats->chunk, stats->frames, stats->calls, stats->max_call, stats->max_frame, stats->render_time);
+    }
+}
+#endif  // RGB_MATRIX_PROFILE
@@ -45,7 +45,19 @@
 #    define RGB_MATRIX_LED_PROCESS_LIMIT (DRIVER_LED_TOTAL + 4) / 5
 #endif
 
-#if defined(RGB_MATRIX_LED_PROCESS_LIMIT) && RGB_MATRIX_LED_PROCESS_LIMIT > 0 && RGB_MATRIX_LED_PROCESS_LIMIT < DRIVER_LED_TOTAL
+#ifdef RGB_MATRIX_ADAPTIVE_CHUNK
+// Picked per effect at the start of every frame
+#    define RGB_MATRIX_LED_CHUNK g_rgb_led_chunk
+#else
+#    define RGB_MATRIX_LED_CHUNK RGB_MATRIX_LED_PROCESS_LIMIT
+#endif
+
+#if defined(RGB_MATRIX_ADAPTIVE_CHUNK)
+#    define RGB_MATRIX_USE_LIMITS(min, max)                \
+        uint8_t min = RGB_MATRIX_LED_CHUNK * params->iter; \
+        uint8_t max = min + RGB_MATRIX_LED_CHUNK;          \
+        if (max < min || max > DRIVER_LED_TOTAL) max = DRIVER_LED_TOTAL;
+#elif defined(RGB_MATRIX_LED_PROCESS_LIMIT) && RGB_MATRIX_LED_PROCESS_LIMIT > 0 && RGB_MATRIX_LED_PROCESS_LIMIT < DRIVER_LED_TOTAL
 #    define RGB_MATRIX_USE_LIMITS(min, max)                        \
         uint8_t min = RGB_MATRIX_LED_PROCESS_LIMIT * params->iter; \
         uint8_t max = min + RGB_MATRIX_LED_PROCESS_LIMIT;          \
@@ -157,6 +169,13 @@ void        rgb_matrix_decrease_speed(void);
 void        rgb_matrix_decrease_speed_noeeprom(void);
 led_flags_t rgb_matrix_get_flags(void);
 void        rgb_matrix_set_flags(led_flags_t flags);
+uint8_t     rgb_matrix_get_effect_flags(uint8_t mode);
+
+#ifdef RGB_MATRIX_PROFILE
+const rgb_matrix_effect_stats_t *rgb_matrix_get_effect_stats(uint8_t mode);
+void                             rgb_matrix_clear_effect_stats(void);
+void                             rgb_matrix_print_effect_stats(void);
+#endif
 
 #ifndef RGBLIGHT_ENABLE
 #    define eeconfig_update_rgblight_current eeconfig_update_rgb_matrix
@@ -219,6 +238,9 @@ extern rgb_config_t rgb_matrix_config;
 extern bool         g_suspend_state;
 extern uint32_t     g_rgb_timer;
 extern led_config_t g_led_config;
+#ifdef RGB_MATRIX_ADAPTIVE_CHUNK
+extern uint8_t g_rgb_led_chunk;
+#endif
 #ifdef RGB_MATRIX_KEYREACTIVE_ENABLED
 extern last_hit_t g_last_hit_tracker;
 #endif
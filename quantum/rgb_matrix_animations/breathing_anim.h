@@ -1,5 +1,5 @@
 #ifndef DISABLE_RGB_MATRIX_BREATHING
-RGB_MATRIX_EFFECT(BREATHING)
+RGB_MATRIX_EFFECT(BREATHING, 0, RGB_MATRIX_COST_LOW)
 #    ifdef RGB_MATRIX_CUSTOM_EFFECT_IMPLS
 
 bool BREATHING(effect_params_t* params) {
@@ -1,5 +1,5 @@
 #ifndef DISABLE_RGB_MATRIX_BAND_VAL
-RGB_MATRIX_EFFECT(BAND_VAL)
+RGB_MATRIX_EFFECT(BAND_VAL, 0, RGB_MATRIX_COST_LOW)
 #    ifdef RGB_MATRIX_CUSTOM_EFFECT_IMPLS
 
 static HSV BAND_VAL_math(HSV hsv, uint8_t i, uint8_t time) {
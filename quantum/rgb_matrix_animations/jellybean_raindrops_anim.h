@@ -1,5 +1,5 @@
 #ifndef DISABLE_RGB_MATRIX_JELLYBEAN_RAINDROPS
-RGB_MATRIX_EFFECT(JELLYBEAN_RAINDROPS)
+RGB_MATRIX_EFFECT(JELLYBEAN_RAINDROPS, 0, RGB_MATRIX_COST_LOW)
 #    ifdef RGB_MATRIX_CUSTOM_EFFECT_IMPLS
 
 static void jellybean_raindrops_set_color(int i, effect_params_t* params) {
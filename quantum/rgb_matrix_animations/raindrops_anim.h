@@ -1,5 +1,5 @@
 #ifndef DISABLE_RGB_MATRIX_RAINDROPS
-RGB_MATRIX_EFFECT(RAINDROPS)
+RGB_MATRIX_EFFECT(RAINDROPS, 0, RGB_MATRIX_COST_LOW)
 #    ifdef RGB_MATRIX_CUSTOM_EFFECT_IMPLS
 
 static void raindrops_set_color(int i, effect_params_t* params) {
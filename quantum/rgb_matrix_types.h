@@ -59,6 +59,34 @@ typedef struct PACKED {
     bool        init;
 } effect_params_t;
 
+/* Effect descriptor flags */
+#define RGB_MATRIX_EFFECT_STATIC 0x01       // Output only changes with the config, not over time
+#define RGB_MATRIX_EFFECT_REACTIVE 0x02     // Reacts to key presses
+#define RGB_MATRIX_EFFECT_FRAMEBUFFER 0x04  // Keeps state in g_rgb_frame_buffer
+
+/* Relative cost of rendering one LED, 0 is treated as RGB_MATRIX_COST_LOW */
+#define RGB_MATRIX_COST_LOW 1
+#define RGB_MATRIX_COST_MEDIUM 2
+#define RGB_MATRIX_COST_HIGH 4
+
+typedef struct {
+    bool (*render)(effect_params_t *params);  // Renders the LEDs of chunk params->iter, returns true until the frame is done
+    uint8_t flags;
+    uint8_t cost;
+} rgb_matrix_effect_t;
+
+#ifdef RGB_MATRIX_PROFILE
+typedef struct {
+    uint32_t frames;       // frames rendered and flushed
+    uint32_t calls;        // render calls, one per chunk of LEDs
+    uint32_t max_call;     // longest render call, in us
+    uint32_t max_frame;    // longest time from the start of a frame to its flush, in us
+    uint32_t render_time;  // ms spent in render calls
+    uint16_t render_us;    // us spent in render calls on top of render_time
+    uint8_t  chunk;        // LEDs per render call in the last frame
+} rgb_matrix_effect_stats_t;
+#endif
+
 typedef struct PACKED {
     uint8_t x;
     uint8_t y;
@@ -147,6 +147,102 @@ void setrgb(uint8_t r, uint8_t g, uint8_t b, LED_TYPE *led1) {
 #endif
 }
 
+#ifdef RGBLIGHT_OUTPUT_STAGE
+/* Effect output
+ *
+ * Effects write a whole frame as HSV, relative to the effect range, and
+ * rgblight_effect_commit() converts it in one pass. Consecutive LEDs of the
+ * same color, like the dark part of the snake and knight effects, share one
+ * conversion, and RGBLIGHT_LIMIT_VAL is applied as the values are written.
+ */
+static HSV effect_hsv[RGBLED_NUM];
+
+void rgblight_effect_sethsv(uint8_t index, uint8_t hue, uint8_t sat, uint8_t val) {
+    if (index >= rgblight_ranges.effect_num_leds) {
+        return;
+    }
+    effect_hsv[index] = (HSV){hue, sat, val > RGBLIGHT_LIMIT_VAL ? RGBLIGHT_LIMIT_VAL : val};
+}
+
+void rgblight_effect_commit(void) {
+    HSV  last_hsv  = {0, 0, 0};
+    RGB  last_rgb  = {0};
+    bool converted = false;
+
+    for (uint8_t i = 0; i < rgblight_ranges.effect_num_leds; i++) {
+        HSV hsv = effect_hsv[i];
+        if (!converted || hsv.h != last_hsv.h || hsv.s != last_hsv.s || hsv.v != last_hsv.v) {
+            last_hsv  = hsv;
+            last_rgb  = rgblight_hsv_to_rgb(hsv);
+            converted = true;
+        }
+        setrgb(last_rgb.r, last_rgb.g, last_rgb.b, &led[i + rgblight_ranges.effect_start_pos]);
+    }
+    rgblight_set();
+}
+#else
+void rgblight_effect_sethsv(uint8_t index, uint8_t hue, uint8_t sat, uint8_t val) {
+    if (index >= rgblight_ranges.effect_num_leds) {
+        return;
+    }
+    sethsv(hue, sat, val, (LED_TYPE *)&led[index + rgblight_ranges.effect_start_pos]);
+}
+
+void rgblight_effect_commit(void) { rgblight_set(); }
+#endif
+
+#if defined(RGBLIGHT_OUTPUT_STAGE) && !defined(RGBLIGHT_CUSTOM_DRIVER)
+/* Output stage
+ *
+ * Every channel goes through one lookup table holding the gamma curve scaled
+ * down to RGBLIGHT_OUTPUT_LIMIT, into a copy of the frame that is only sent to
+ * the strip when it differs from the previous one. Sending takes about 30us
+ * per LED with interrupts disabled, which is wasted on static modes and on
+ * effect steps that do not change any LED.
+ */
+static uint8_t  output_lut[256];
+static LED_TYPE last_frame[RGBLED_NUM];
+static uint8_t  last_frame_start;
+static uint8_t  last_frame_num;
+static bool     last_frame_valid = false;  // Cleared whenever the strip may not show last_frame
+
+static void rgblight_output_init(void) {
+    for (uint16_t i = 0; i < 256; i++) {
+#    ifdef USE_CIE1931_CURVE
+        uint16_t v = i;  // hsv_to_rgb() already follows the CIE curve
+#    else
+        uint16_t v = (i * i + 127) / 255;
+#    endif
+        output_lut[i] = (uint32_t)v * RGBLIGHT_OUTPUT_LIMIT / 255;
+    }
+    last_frame_valid = false;
+}
+
+static bool rgblight_output_frame(const LED_TYPE *start_led, uint8_t num_leds) {
+    uint8_t start   = rgblight_ranges.clipping_start_pos;
+    bool    changed = !last_frame_valid || last_frame_start != start || last_frame_num != num_leds;
+
+    for (uint8_t i = 0; i < num_leds; i++) {
+        LED_TYPE out = start_led[i];
+        out.r        = output_lut[out.r];
+        out.g        = output_lut[out.g];
+        out.b        = output_lut[out.b];
+#    ifdef RGBW
+        out.w = output_lut[out.w];
+#    endif
+        if (memcmp(&last_frame[i], &out, sizeof(LED_TYPE)) != 0) {
+            last_frame[i] = out;
+            changed       = true;
+        }
+    }
+
+    last_frame_start = start;
+    last_frame_num   = num_leds;
+    last_frame_valid = true;
+    return changed;
+}
+#endif
+
 void rgblight_check_config(void) {
     /* Add some out of bound checks for RGB light config */
 
@@ -163,7 +259,7 @@ void rgblight_check_config(void) {
 
 uint32_t eeconfig_read_rgblight(void) {
 #ifdef EEPROM_ENABLE
-    return eeprom_read_dword(EECONFIG_RGBLIGHT);
+    return eeconfig_read_dword(EECONFIG_RGBLIGHT);
 #else
     return 0;
 #endif
@@ -172,7 +268,7 @@ uint32_t eeconfig_read_rgblight(void) {
 void eeconfig_update_rgblight(uint32_t val) {
 #ifdef EEPROM_ENABLE
     rgblight_check_config();
-    eeprom_update_dword(EECONFIG_RGBLIGHT, val);
+    eeconfig_update_dword(EECONFIG_RGBLIGHT, val);
 #endif
 }
 
@@ -225,6 +321,10 @@ void rgblight_init(void) {
 
     eeconfig_debug_rgblight();  // display current eeprom values
 
+#if defined(RGBLIGHT_OUTPUT_STAGE) && !defined(RGBLIGHT_CUSTOM_DRIVER)
+    rgblight_output_init();
+#endif
+
     rgblight_timer_init();  // setup the timer
 
     if (rgblight_config.enable) {
@@ -502,9 +602,9 @@ void rgblight_sethsv_eeprom_helper(uint8_t hue, uint8_t sat, uint8_t val, bool w
                         _hue = hue - _hue;
                     }
                     dprintf("rgblight rainbow set hsv: %d,%d,%d,%u\n", i, _hue, direction, range);
-                    sethsv(_hue, sat, val, (LED_TYPE *)&led[i + rgblight_ranges.effect_start_pos]);
+                    rgblight_effect_sethsv(i, _hue, sat, val);
                 }
-                rgblight_set();
+                rgblight_effect_commit();
             }
 #endif
         }
@@ -744,6 +844,9 @@ void rgblight_suspend(void) {
 
 void rgblight_wakeup(void) {
     is_suspended = false;
+#    if defined(RGBLIGHT_OUTPUT_STAGE) && !defined(RGBLIGHT_CUSTOM_DRIVER)
+    last_frame_valid = false;  // The strip may have lost power
+#    endif
 
     if (pre_suspend_enabled) {
         rgblight_enable_noeeprom();
@@ -806,7 +909,16 @@ void rgblight_set(void) {
         convert_rgb_to_rgbw(&start_led[i]);
     }
 #    endif
+#    ifdef RGBLIGHT_OUTPUT_STAGE
+    if (num_leds > RGBLED_NUM) {
+        num_leds = RGBLED_NUM;
+    }
+    if (rgblight_output_frame(start_led, num_leds)) {
+        rgblight_call_driver(last_frame, num_leds);
+    }
+#    else
     rgblight_call_driver(start_led, num_leds);
+#    endif
 }
 #endif
 
@@ -1078,9 +1190,9 @@ void rgblight_effect_rainbow_swirl(animation_status_t *anim) {
 
     for (i = 0; i < rgblight_ranges.effect_num_leds; i++) {
         hue = (RGBLIGHT_RAINBOW_SWIRL_RANGE / rgblight_ranges.effect_num_leds * i + anim->current_hue);
-        sethsv(hue, rgblight_config.sat, rgblight_config.val, (LED_TYPE *)&led[i + rgblight_ranges.effect_start_pos]);
+        rgblight_effect_sethsv(i, hue, rgblight_config.sat, rgblight_config.val);
     }
-    rgblight_set();
+    rgblight_effect_commit();
 
     if (anim->delta % 2) {
         anim->current_hue++;
@@ -1115,13 +1227,7 @@ void rgblight_effect_snake(animation_status_t *anim) {
 #    endif
 
     for (i = 0; i < rgblight_ranges.effect_num_leds; i++) {
-        LED_TYPE *ledp = led + i + rgblight_ranges.effect_start_pos;
-        ledp->r        = 0;
-        ledp->g        = 0;
-        ledp->b        = 0;
-#    ifdef RGBW
-        ledp->w = 0;
-#    endif
+        rgblight_effect_sethsv(i, rgblight_config.hue, rgblight_config.sat, 0);
         for (j = 0; j < RGBLIGHT_EFFECT_SNAKE_LENGTH; j++) {
             k = pos + j * increment;
             if (k > RGBLED_NUM) {
@@ -1131,11 +1237,11 @@ void rgblight_effect_snake(animation_status_t *anim) {
                 k = k + rgblight_ranges.effect_num_leds;
             }
             if (i == k) {
-                sethsv(rgblight_config.hue, rgblight_config.sat, (uint8_t)(rgblight_config.val * (RGBLIGHT_EFFECT_SNAKE_LENGTH - j) / RGBLIGHT_EFFECT_SNAKE_LENGTH), ledp);
+                rgblight_effect_sethsv(i, rgblight_config.hue, rgblight_config.sat, (uint8_t)(rgblight_config.val * (RGBLIGHT_EFFECT_SNAKE_LENGTH - j) / RGBLIGHT_EFFECT_SNAKE_LENGTH));
             }
         }
     }
-    rgblight_set();
+    rgblight_effect_commit();
     if (increment == 1) {
         if (pos - 1 < 0) {
             pos = rgblight_ranges.effect_num_leds - 1;
@@ -1175,30 +1281,18 @@ void rgblight_effect_knight(animation_status_t *anim) {
     }
 #    endif
     // Set all the LEDs to 0
-    for (i = rgblight_ranges.effect_start_pos; i < rgblight_ranges.effect_end_pos; i++) {
-        led[i].r = 0;
-        led[i].g = 0;
-        led[i].b = 0;
-#    ifdef RGBW
-        led[i].w = 0;
-#    endif
+    for (i = 0; i < rgblight_ranges.effect_num_leds; i++) {
+        rgblight_effect_sethsv(i, rgblight_config.hue, rgblight_config.sat, 0);
     }
     // Determine which LEDs should be lit up
     for (i = 0; i < RGBLIGHT_EFFECT_KNIGHT_LED_NUM; i++) {
-        cur = (i + RGBLIGHT_EFFECT_KNIGHT_OFFSET) % rgblight_ranges.effect_num_leds + rgblight_ranges.effect_start_pos;
+        cur = (i + RGBLIGHT_EFFECT_KNIGHT_OFFSET) % rgblight_ranges.effect_num_leds;
 
         if (i >= low_bound && i <= high_bound) {
-            sethsv(rgblight_config.hue, rgblight_config.sat, rgblight_config.val, (LED_TYPE *)&led[cur]);
-        } else {
-            led[cur].r = 0;
-            led[cur].g = 0;
-            led[cur].b = 0;
-#    ifdef RGBW
-            led[cur].w = 0;
-#    endif
+            rgblight_effect_sethsv(cur, rgblight_config.hue, rgblight_config.sat, rgblight_config.val);
         }
     }
-    rgblight_set();
+    rgblight_effect_commit();
 
     // Move from low_bound to high_bound changing the direction we increment each
     // time a boundary is hit.
@@ -1240,9 +1334,9 @@ void rgblight_effect_christmas(animation_status_t *anim) {
 
     for (i = 0; i < rgblight_ranges.effect_num_leds; i++) {
         uint8_t local_hue = (i / RGBLIGHT_EFFECT_CHRISTMAS_STEP) % 2 ? hue : hue_green - hue;
-        sethsv(local_hue, rgblight_config.sat, val, (LED_TYPE *)&led[i + rgblight_ranges.effect_start_pos]);
+        rgblight_effect_sethsv(i, local_hue, rgblight_config.sat, val);
     }
-    rgblight_set();
+    rgblight_effect_commit();
 
     if (anim->pos == 0) {
         increment = 1;
@@ -1287,16 +1381,15 @@ void rgblight_effect_rgbtest(animation_status_t *anim) {
 #ifdef RGBLIGHT_EFFECT_ALTERNATING
 void rgblight_effect_alternating(animation_status_t *anim) {
     for (int i = 0; i < rgblight_ranges.effect_num_leds; i++) {
-        LED_TYPE *ledp = led + i + rgblight_ranges.effect_start_pos;
         if (i < rgblight_ranges.effect_num_leds / 2 && anim->pos) {
-            sethsv(rgblight_config.hue, rgblight_config.sat, rgblight_config.val, ledp);
+            rgblight_effect_sethsv(i, rgblight_config.hue, rgblight_config.sat, rgblight_config.val);
         } else if (i >= rgblight_ranges.effect_num_leds / 2 && !anim->pos) {
-            sethsv(rgblight_config.hue, rgblight_config.sat, rgblight_config.val, ledp);
+            rgblight_effect_sethsv(i, rgblight_config.hue, rgblight_config.sat, rgblight_config.val);
         } else {
-            sethsv(rgblight_config.hue, rgblight_config.sat, 0, ledp);
+            rgblight_effect_sethsv(i, rgblight_config.hue, rgblight_config.sat, 0);
         }
     }
-    rgblight_set();
+    rgblight_effect_commit();
     anim->pos = (anim->pos + 1) % 2;
 }
 #endif
@@ -1348,10 +1441,9 @@ void rgblight_effect_twinkle(animation_status_t *anim) {
             // This LED is off, and was NOT selected to start brightening
         }
 
-        LED_TYPE *ledp = led + i + rgblight_ranges.effect_start_pos;
-        sethsv(c->h, c->s, c->v, ledp);
+        rgblight_effect_sethsv(i, c->h, c->s, c->v);
     }
 
-    rgblight_set();
+    rgblight_effect_commit();
 }
 #endif
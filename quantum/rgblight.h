@@ -169,6 +169,9 @@ enum RGBLIGHT_EFFECT_MODE {
 #    ifndef RGBLIGHT_LIMIT_VAL
 #        define RGBLIGHT_LIMIT_VAL 255
 #    endif
+#    ifndef RGBLIGHT_OUTPUT_LIMIT
+#        define RGBLIGHT_OUTPUT_LIMIT 255
+#    endif
 
 #    define RGBLED_TIMER_TOP F_CPU / (256 * 64)
 // #define RGBLED_TIMER_TOP 0xFF10
@@ -286,6 +289,10 @@ void setrgb(uint8_t r, uint8_t g, uint8_t b, LED_TYPE *led1);
 void rgblight_set(void);
 void rgblight_set_clipping_range(uint8_t start_pos, uint8_t num_leds);
 
+/*   effect output, index is relative to the effect range */
+void rgblight_effect_sethsv(uint8_t index, uint8_t hue, uint8_t sat, uint8_t val);
+void rgblight_effect_commit(void);
+
 /* === Effects and Animations Functions === */
 /*   effect range setting */
 void rgblight_set_effect_range(uint8_t start_pos, uint8_t num_leds);
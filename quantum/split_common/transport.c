@@ -11,6 +11,10 @@
 #    include "rgblight.h"
 #endif
 
+#ifdef EFFECTS_THREAD_ENABLE
+#    include "effects_thread.h"
+#endif
+
 #ifdef BACKLIGHT_ENABLE
 #    include "backlight.h"
 #endif
@@ -21,6 +25,37 @@ static pin_t encoders_pad[] = ENCODERS_PAD_A;
 #    define NUMBER_OF_ENCODERS (sizeof(encoders_pad) / sizeof(pin_t))
 #endif
 
+#if defined(RGBLIGHT_ENABLE) && defined(RGBLIGHT_SPLIT)
+// With the effects thread, the rgblight state belongs to it and the transport goes through its snapshot and queue
+static bool transport_rgblight_get_sync(rgblight_syncinfo_t *syncinfo) {
+#    ifdef EFFECTS_THREAD_ENABLE
+    return effects_rgblight_get_sync(syncinfo);
+#    else
+    if (!rgblight_get_change_flags()) {
+        return false;
+    }
+    rgblight_get_syncinfo(syncinfo);
+    return true;
+#    endif
+}
+
+static void transport_rgblight_sync_sent(void) {
+#    ifdef EFFECTS_THREAD_ENABLE
+    effects_rgblight_sync_sent();
+#    else
+    rgblight_clear_change_flags();
+#    endif
+}
+
+static void transport_rgblight_update_sync(rgblight_syncinfo_t *syncinfo) {
+#    ifdef EFFECTS_THREAD_ENABLE
+    effects_rgblight_update_sync(syncinfo);
+#    else
+    rgblight_update_sync(syncinfo, false);
+#    endif
+}
+#endif
+
 #if defined(USE_I2C)
 
 #    include "i2c_master.h"
@@ -69,11 +104,10 @@ bool transport_master(matrix_row_t matrix[]) {
 #    endif
 
 #    if defined(RGBLIGHT_ENABLE) && defined(RGBLIGHT_SPLIT)
-    if (rgblight_get_change_flags()) {
-        rgblight_syncinfo_t rgblight_sync;
-        rgblight_get_syncinfo(&rgblight_sync);
+    rgblight_syncinfo_t rgblight_sync;
+    if (transport_rgblight_get_sync(&rgblight_sync)) {
         if (i2c_writeReg(SLAVE_I2C_ADDRESS, I2C_RGB_START, (void *)&rgblight_sync, sizeof(rgblight_sync), TIMEOUT) >= 0) {
-            rgblight_clear_change_flags();
+            transport_rgblight_sync_sent();
         }
     }
 #    endif
@@ -84,8 +118,9 @@ bool transport_master(matrix_row_t matrix[]) {
 #    endif
 
 #    ifdef WPM_ENABLE
+    // Each write is an I2C transaction of its own, small changes are held back
     uint8_t current_wpm = get_current_wpm();
-    if (current_wpm != i2c_buffer->current_wpm) {
+    if (wpm_sync_needed(i2c_buffer->current_wpm)) {
         if (i2c_writeReg(SLAVE_I2C_ADDRESS, I2C_WPM_START, (void *)&current_wpm, sizeof(current_wpm), TIMEOUT) >= 0) {
             i2c_buffer->current_wpm = current_wpm;
         }
@@ -106,7 +141,7 @@ void transport_slave(matrix_row_t matrix[]) {
 #    if defined(RGBLIGHT_ENABLE) && defined(RGBLIGHT_SPLIT)
     // Update the RGB with the new data
     if (i2c_buffer->rgblight_sync.status.change_flags != 0) {
-        rgblight_update_sync(&i2c_buffer->rgblight_sync, false);
+        transport_rgblight_update_sync(&i2c_buffer->rgblight_sync);
         i2c_buffer->rgblight_sync.status.change_flags = 0;
     }
 #    endif
@@ -201,17 +236,16 @@ void transport_slave_init(void) { soft_serial_target_init(transactions, TID_LIMI
 // rgblight synchronization information communication.
 
 void transport_rgblight_master(void) {
-    if (rgblight_get_change_flags()) {
-        rgblight_get_syncinfo((rgblight_syncinfo_t *)&serial_rgblight.rgblight_sync);
+    if (transport_rgblight_get_sync((rgblight_syncinfo_t *)&serial_rgblight.rgblight_sync)) {
         if (soft_serial_transaction(PUT_RGBLIGHT) == TRANSACTION_END) {
-            rgblight_clear_change_flags();
+            transport_rgblight_sync_sent();
         }
     }
 }
 
 void transport_rgblight_slave(void) {
     if (status_rgblight == TRANSACTION_ACCEPTED) {
-        rgblight_update_sync((rgblight_syncinfo_t *)&serial_rgblight.rgblight_sync, false);
+        transport_rgblight_update_sync((rgblight_syncinfo_t *)&serial_rgblight.rgblight_sync);
         status_rgblight = TRANSACTION_END;
     }
 }
@@ -171,6 +171,7 @@ keyframe_animation_t led_test_animation = {
             led_backlight_keyframe_normal_orientation,
             led_backlight_keyframe_crossfade,
         },
+    .surfaces = VISUALIZER_SURFACE_LED_BACKLIGHT,
 };
 #    endif
 
@@ -69,15 +69,34 @@ static visualizer_keyboard_status_t current_status = {.layer         = 0xFFFFFFF
 #endif
 };
 
-static bool same_status(visualizer_keyboard_status_t* status1, visualizer_keyboard_status_t* status2) {
-    return status1->layer == status2->layer && status1->default_layer == status2->default_layer && status1->mods == status2->mods && status1->leds == status2->leds && status1->suspended == status2->suspended
+// Returns the VISUALIZER_EVENT_* for the fields that differ
+static uint8_t status_changes(visualizer_keyboard_status_t* status1, visualizer_keyboard_status_t* status2) {
+    uint8_t events = 0;
+    if (status1->layer != status2->layer) events |= VISUALIZER_EVENT_LAYER;
+    if (status1->default_layer != status2->default_layer) events |= VISUALIZER_EVENT_DEFAULT_LAYER;
+    if (status1->mods != status2->mods) events |= VISUALIZER_EVENT_MODS;
+    if (status1->leds != status2->leds) events |= VISUALIZER_EVENT_LEDS;
+    if (status1->suspended != status2->suspended) events |= VISUALIZER_EVENT_SUSPEND;
 #ifdef BACKLIGHT_ENABLE
-           && status1->backlight_level == status2->backlight_level
+    if (status1->backlight_level != status2->backlight_level) events |= VISUALIZER_EVENT_BACKLIGHT;
 #endif
 #ifdef VISUALIZER_USER_DATA_SIZE
-           && memcmp(status1->user_data, status2->user_data, VISUALIZER_USER_DATA_SIZE) == 0
+    if (memcmp(status1->user_data, status2->user_data, VISUALIZER_USER_DATA_SIZE) != 0) events |= VISUALIZER_EVENT_USER_DATA;
 #endif
-        ;
+    return events;
+}
+
+// Status changes posted by the main thread and not yet handled by the visualizer
+// thread. Repeated changes of the same kind are merged, as only the latest
+// current_status matters.
+static volatile uint8_t pending_events = 0;
+
+static uint8_t take_pending_events(void) {
+    gfxSystemLock();
+    uint8_t events = pending_events;
+    pending_events = 0;
+    gfxSystemUnlock();
+    return events;
 }
 
 static bool visualizer_enabled = false;
@@ -162,7 +181,9 @@ static uint8_t get_num_running_animations(void) {
     return count;
 }
 
-static bool update_keyframe_animation(keyframe_animation_t* animation, visualizer_state_t* state, systemticks_t delta, systemticks_t* sleep_time) {
+static uint8_t animation_surfaces(keyframe_animation_t* animation) { return animation->surfaces ? animation->surfaces : VISUALIZER_SURFACE_ALL; }
+
+static bool update_keyframe_animation(keyframe_animation_t* animation, visualizer_state_t* state, systemticks_t delta, systemticks_t* sleep_time, uint8_t* dirty) {
     // TODO: Clean up this messy code
     dprintf("Animation frame%d, left %d, delta %d\n", animation->current_frame, animation->time_left_in_frame, delta);
     if (animation->current_frame == animation->num_frames) {
@@ -183,6 +204,7 @@ static bool update_keyframe_animation(keyframe_animation_t* animation, visualize
                 animation->last_update_of_frame = true;
                 (*animation->frame_functions[animation->current_frame])(animation, state);
                 animation->last_update_of_frame = false;
+                *dirty |= animation_surfaces(animation);
             }
             animation->current_frame++;
             animation->need_update           = true;
@@ -203,9 +225,10 @@ static bool update_keyframe_animation(keyframe_animation_t* animation, visualize
     if (animation->need_update) {
         animation->need_update           = (*animation->frame_functions[animation->current_frame])(animation, state);
         animation->first_update_of_frame = false;
+        *dirty |= animation_surfaces(animation);
     }
 
-    systemticks_t wanted_sleep = animation->need_update ? gfxMillisecondsToTicks(10) : (unsigned)animation->time_left_in_frame;
+    systemticks_t wanted_sleep = animation->need_update ? gfxMillisecondsToTicks(VISUALIZER_FRAME_INTERVAL) : (unsigned)animation->time_left_in_frame;
     if (wanted_sleep < *sleep_time) {
         *sleep_time = wanted_sleep;
     }
@@ -228,6 +251,18 @@ void run_next_keyframe(keyframe_animation_t* animation, visualizer_state_t* stat
     (*temp_animation.frame_functions[next_frame])(&temp_animation, &temp_state);
 }
 
+static delaytime_t ticks_to_ms(systemticks_t ticks) {
+#ifdef PROTOCOL_CHIBIOS
+    // The gEventWait function really takes milliseconds, even if the documentation says ticks.
+    // Unfortunately there's no generic ugfx conversion from system time to milliseconds,
+    // so let's do it in a platform dependent way.
+    return TIME_I2MS(ticks);
+#else
+    // On windows the system ticks is the same as milliseconds anyway
+    return ticks;
+#endif
+}
+
 // TODO: Optimize the stack size, this is probably way too big
 static DECLARE_THREAD_STACK(visualizerThreadStack, 1024);
 static DECLARE_THREAD_FUNCTION(visualizerThread, arg) {
@@ -265,19 +300,24 @@ static DECLARE_THREAD_FUNCTION(visualizerThread, arg) {
     lcd_backlight_color(LCD_HUE(state.current_lcd_color), LCD_SAT(state.current_lcd_color), LCD_INT(state.current_lcd_color));
 #endif
 
+    const systemticks_t frame_interval = gfxMillisecondsToTicks(VISUALIZER_FRAME_INTERVAL);
+
     systemticks_t sleep_time   = TIME_INFINITE;
     systemticks_t current_time = gfxSystemTicks();
-    bool          force_update = true;
+    systemticks_t frame_time   = current_time - frame_interval;
+    // Handle the whole status the first time
+    uint8_t events = 0xFF;
 
     while (true) {
         systemticks_t new_time = gfxSystemTicks();
         systemticks_t delta    = new_time - current_time;
         current_time           = new_time;
-        bool enabled           = visualizer_enabled;
-        if (force_update || !same_status(&state.status, &current_status)) {
-            force_update = false;
-#if BACKLIGHT_ENABLE
-            if (current_status.backlight_level != state.status.backlight_level) {
+        bool    enabled        = visualizer_enabled;
+        uint8_t dirty          = 0;
+        events |= take_pending_events();
+        if (events) {
+#ifdef BACKLIGHT_ENABLE
+            if ((events & VISUALIZER_EVENT_BACKLIGHT) && current_status.backlight_level != state.status.backlight_level) {
                 if (current_status.backlight_level != 0) {
                     gdispGSetPowerMode(LED_DISPLAY, powerOn);
                     uint16_t percent = (uint16_t)current_status.backlight_level * 100 / BACKLIGHT_LEVELS;
@@ -286,9 +326,12 @@ static DECLARE_THREAD_FUNCTION(visualizerThread, arg) {
                     gdispGSetPowerMode(LED_DISPLAY, powerOff);
                 }
                 state.status.backlight_level = current_status.backlight_level;
+                dirty |= VISUALIZER_SURFACE_LED_BACKLIGHT;
             }
 #endif
-            if (visualizer_enabled) {
+            // A backlight level change alone is handled above, without involving
+            // the user visualizer and its animations
+            if (visualizer_enabled && (events & ~VISUALIZER_EVENT_BACKLIGHT)) {
                 if (current_status.suspended) {
                     stop_all_keyframe_animations();
                     visualizer_enabled = false;
@@ -300,7 +343,10 @@ static DECLARE_THREAD_FUNCTION(visualizerThread, arg) {
                     update_user_visualizer_state(&state, &prev_status);
                 }
                 state.prev_lcd_color = state.current_lcd_color;
+                // The user code may draw directly
+                dirty |= VISUALIZER_SURFACE_ALL;
             }
+            events = 0;
         }
         if (!enabled && state.status.suspended && current_status.suspended == false) {
             // Setting the status to the initial status will force an update
@@ -310,30 +356,46 @@ static DECLARE_THREAD_FUNCTION(visualizerThread, arg) {
             stop_all_keyframe_animations();
             user_visualizer_resume(&state);
             state.prev_lcd_color = state.current_lcd_color;
+            dirty |= VISUALIZER_SURFACE_ALL;
         }
         sleep_time = TIME_INFINITE;
         for (int i = 0; i < MAX_SIMULTANEOUS_ANIMATIONS; i++) {
             if (animations[i]) {
-                update_keyframe_animation(animations[i], &state, delta, &sleep_time);
+                update_keyframe_animation(animations[i], &state, delta, &sleep_time, &dirty);
             }
         }
+
+        // Only flush what was drawn to, the LCD backlight needs no flush
 #ifdef BACKLIGHT_ENABLE
-        gdispGFlush(LED_DISPLAY);
+        if (dirty & VISUALIZER_SURFACE_LED_BACKLIGHT) {
+            gdispGFlush(LED_DISPLAY);
+        }
 #endif
 
 #ifdef LCD_ENABLE
-        gdispGFlush(LCD_DISPLAY);
+        if (dirty & VISUALIZER_SURFACE_LCD) {
+            gdispGFlush(LCD_DISPLAY);
+        }
 #endif
 
 #ifdef EMULATOR
-        draw_emulator();
+        if (dirty) {
+            draw_emulator();
+        }
 #endif
+        if (dirty) {
+            frame_time = current_time;
+        }
+
         // Enable the visualizer when the startup or the suspend animation has finished
         if (!visualizer_enabled && state.status.suspended == false && get_num_running_animations() == 0) {
             visualizer_enabled = true;
-            force_update       = true;
+            events             = 0xFF;
             sleep_time         = 0;
         }
+        if (pending_events) {
+            sleep_time = 0;
+        }
 
         systemticks_t after_update = gfxSystemTicks();
         unsigned      update_delta = after_update - current_time;
@@ -344,18 +406,18 @@ static DECLARE_THREAD_FUNCTION(visualizerThread, arg) {
                 sleep_time = 0;
             }
         }
-        dprintf("Update took %d, last delta %d, sleep_time %d\n", update_delta, delta, sleep_time);
-#ifdef PROTOCOL_CHIBIOS
-        // The gEventWait function really takes milliseconds, even if the documentation says ticks.
-        // Unfortunately there's no generic ugfx conversion from system time to milliseconds,
-        // so let's do it in a platform dependent way.
-
-        // On windows the system ticks is the same as milliseconds anyway
+        dprintf("Update took %d, last delta %d, sleep_time %d, dirty %d\n", update_delta, delta, sleep_time, dirty);
         if (sleep_time != TIME_INFINITE) {
-            sleep_time = TIME_I2MS(sleep_time);
+            sleep_time = ticks_to_ms(sleep_time);
         }
-#endif
         geventEventWait(&event_listener, sleep_time);
+
+        // Status changes coming in faster than the frame rate are merged into
+        // the next frame, leaving the CPU to the main thread meanwhile
+        systemticks_t since_frame = gfxSystemTicks() - frame_time;
+        if (since_frame < frame_interval) {
+            gfxSleepMilliseconds(ticks_to_ms(frame_interval - since_frame));
+        }
     }
 #ifdef LCD_ENABLE
     gdispCloseFont(state.font_fixed5x8);
@@ -389,8 +451,12 @@ void visualizer_init(void) {
     gfxThreadCreate(visualizerThreadStack, sizeof(visualizerThreadStack), VISUALIZER_THREAD_PRIORITY, visualizerThread, NULL);
 }
 
-void update_status(bool changed) {
+static void update_status(uint8_t events) {
+    bool changed = events != 0;
     if (changed) {
+        gfxSystemLock();
+        pending_events |= events;
+        gfxSystemUnlock();
         GSourceListener* listener = geventGetSourceListener((GSourceHandle)&current_status, NULL);
         if (listener) {
             geventSendEvent(listener);
@@ -430,13 +496,13 @@ void visualizer_update(layer_state_t default_state, layer_state_t state, uint8_t
     // not really matter as it will be fixed during the next loop step.
     // Alternatively a mutex could be used instead of the volatile variables
 
-    bool changed = false;
+    uint8_t events = 0;
 #ifdef SERIAL_LINK_ENABLE
     if (is_serial_link_connected()) {
         visualizer_keyboard_status_t* new_status = read_current_status();
         if (new_status) {
-            if (!same_status(&current_status, new_status)) {
-                changed        = true;
+            events = status_changes(&current_status, new_status);
+            if (events) {
                 current_status = *new_status;
             }
         }
@@ -457,27 +523,27 @@ void visualizer_update(layer_state_t default_state, layer_state_t state, uint8_t
 #ifdef VISUALIZER_USER_DATA_SIZE
         memcpy(new_status.user_data, user_data, VISUALIZER_USER_DATA_SIZE);
 #endif
-        if (!same_status(&current_status, &new_status)) {
-            changed        = true;
+        events = status_changes(&current_status, &new_status);
+        if (events) {
             current_status = new_status;
         }
     }
-    update_status(changed);
+    update_status(events);
 }
 
 void visualizer_suspend(void) {
     current_status.suspended = true;
-    update_status(true);
+    update_status(VISUALIZER_EVENT_SUSPEND);
 }
 
 void visualizer_resume(void) {
     current_status.suspended = false;
-    update_status(true);
+    update_status(VISUALIZER_EVENT_SUSPEND);
 }
 
 #ifdef BACKLIGHT_ENABLE
 void backlight_set(uint8_t level) {
     current_status.backlight_level = level;
-    update_status(true);
+    update_status(VISUALIZER_EVENT_BACKLIGHT);
 }
 #endif
@@ -66,6 +66,29 @@ void draw_emulator(void);
 // If you need support for more than 16 keyframes per animation, you can change this
 #define MAX_VISUALIZER_KEY_FRAMES 16
 
+// Shortest time between two redraws, in ms. Status changes that come in faster
+// are merged into one redraw.
+#ifndef VISUALIZER_FRAME_INTERVAL
+#    define VISUALIZER_FRAME_INTERVAL 10
+#endif
+
+// The surfaces an animation draws to, only those are flushed after it runs
+#define VISUALIZER_SURFACE_LCD (1 << 0)
+#define VISUALIZER_SURFACE_LCD_BACKLIGHT (1 << 1)
+#define VISUALIZER_SURFACE_LED_BACKLIGHT (1 << 2)
+#define VISUALIZER_SURFACE_ALL (VISUALIZER_SURFACE_LCD | VISUALIZER_SURFACE_LCD_BACKLIGHT | VISUALIZER_SURFACE_LED_BACKLIGHT)
+
+// The status changes posted to the visualizer thread
+typedef enum {
+    VISUALIZER_EVENT_LAYER         = (1 << 0),
+    VISUALIZER_EVENT_DEFAULT_LAYER = (1 << 1),
+    VISUALIZER_EVENT_MODS          = (1 << 2),
+    VISUALIZER_EVENT_LEDS          = (1 << 3),
+    VISUALIZER_EVENT_SUSPEND       = (1 << 4),
+    VISUALIZER_EVENT_BACKLIGHT     = (1 << 5),
+    VISUALIZER_EVENT_USER_DATA     = (1 << 6),
+} visualizer_event_t;
+
 struct keyframe_animation_t;
 
 typedef struct {
@@ -115,6 +138,8 @@ typedef struct keyframe_animation_t {
     bool       loop;
     int        frame_lengths[MAX_VISUALIZER_KEY_FRAMES];
     frame_func frame_functions[MAX_VISUALIZER_KEY_FRAMES];
+    // VISUALIZER_SURFACE_* drawn to by the frame functions, all of them if left 0
+    uint8_t surfaces;
 
     // Used internally by the system, and can also be read by
     // keyframe update functions
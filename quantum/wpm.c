@@ -15,15 +15,32 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+/* The times of the last WPM_SAMPLES counted key presses are kept in a ring.
+ * The estimate is the number of presses within the last WPM_WINDOW ms, scaled
+ * to words (5 presses) per minute by a precomputed fixed point factor, so a
+ * key press costs no floating point and no division. Presses leave the
+ * window in the order they came in, so decay_wpm() only ever drops the
+ * oldest ones, and the estimate is only recomputed when the count changes.
+ *
+ * When typing is fast enough to fill the ring before its oldest press left
+ * the window, the rate is taken over the time the ring spans instead. That
+ * quotient is found bit by bit with multiplications, so this case needs no
+ * division either.
+ */
+
 #include "wpm.h"
 
+_Static_assert(WPM_SAMPLES >= 2 && WPM_SAMPLES <= 255, "WPM_SAMPLES must be between 2 and 255");
+_Static_assert(WPM_WINDOW >= 1000 && WPM_WINDOW <= 30000, "WPM_WINDOW must be between 1000 and 30000 ms");
+
+// Presses per window to words per minute, in 1/256
+#define WPM_SCALE ((60000UL / 5 * 256 + WPM_WINDOW / 2) / WPM_WINDOW)
+
 // WPM Stuff
 static uint8_t  current_wpm = 0;
-static uint8_t  latest_wpm  = 0;
-static uint16_t wpm_timer   = 0;
-
-// This smoothing is 40 keystrokes
-static const float wpm_smoothing = 0.0487;
+static uint16_t presses[WPM_SAMPLES];
+static uint8_t  presses_head  = 0;  // oldest press
+static uint8_t  presses_count = 0;
 
 void set_current_wpm(uint8_t new_wpm) { current_wpm = new_wpm; }
 
@@ -46,19 +63,60 @@ __attribute__((weak)) bool wpm_keycode_user(uint16_t keycode) {
     return false;
 }
 
+/* WPM_SAMPLES - 1 presses over span ms in words per minute, up to 255 */
+static uint8_t wpm_over_span(uint16_t span) {
+    const uint32_t presses_per_minute = (uint32_t)(WPM_SAMPLES - 1) * (60000 / 5);
+    uint8_t        wpm                = 0;
+    for (uint8_t bit = 0x80; bit; bit >>= 1) {
+        if ((uint32_t)(wpm | bit) * span <= presses_per_minute) {
+            wpm |= bit;
+        }
+    }
+    return wpm;
+}
+
+static void wpm_estimate(uint16_t now) {
+    if (presses_count < WPM_SAMPLES) {
+        uint32_t wpm = (presses_count * WPM_SCALE) >> 8;
+        current_wpm  = wpm > UINT8_MAX ? UINT8_MAX : wpm;
+    } else {
+        current_wpm = wpm_over_span(TIMER_DIFF_16(now, presses[presses_head]));
+    }
+}
+
+/* Drops the presses that left the window, returns true if there were any */
+static bool wpm_expire(uint16_t now) {
+    bool expired = false;
+    while (presses_count && TIMER_DIFF_16(now, presses[presses_head]) >= WPM_WINDOW) {
+        presses_head = (presses_head + 1) % WPM_SAMPLES;
+        presses_count--;
+        expired = true;
+    }
+    return expired;
+}
+
 void update_wpm(uint16_t keycode) {
     if (wpm_keycode(keycode)) {
-        if (wpm_timer > 0) {
-            latest_wpm  = 60000 / timer_elapsed(wpm_timer) / 5;
-            current_wpm = (latest_wpm - current_wpm) * wpm_smoothing + current_wpm;
+        uint16_t now = timer_read();
+        wpm_expire(now);
+        if (presses_count == WPM_SAMPLES) {
+            presses_head = (presses_head + 1) % WPM_SAMPLES;
+            presses_count--;
         }
-        wpm_timer = timer_read();
+        presses[(presses_head + presses_count) % WPM_SAMPLES] = now;
+        presses_count++;
+        wpm_estimate(now);
     }
 }
 
 void decay_wpm(void) {
-    if (timer_elapsed(wpm_timer) > 1000) {
-        current_wpm = (0 - current_wpm) * wpm_smoothing + current_wpm;
-        wpm_timer   = timer_read();
+    uint16_t now = timer_read();
+    if (wpm_expire(now)) {
+        wpm_estimate(now);
     }
 }
+
+bool wpm_sync_needed(uint8_t synced_wpm) {
+    uint8_t difference = current_wpm > synced_wpm ? current_wpm - synced_wpm : synced_wpm - current_wpm;
+    return difference >= WPM_SYNC_THRESHOLD || (difference && current_wpm == 0);
+}
@@ -19,6 +19,22 @@
 
 #include "quantum.h"
 
+/* Time over which key presses are counted, in ms */
+#ifndef WPM_WINDOW
+#    define WPM_WINDOW 5000
+#endif
+
+/* Number of key press times kept. Typing faster than this many presses per
+ * WPM_WINDOW is measured over a shorter time. */
+#ifndef WPM_SAMPLES
+#    define WPM_SAMPLES 64
+#endif
+
+/* Change in WPM after which split keyboards on I2C write the value to the other half */
+#ifndef WPM_SYNC_THRESHOLD
+#    define WPM_SYNC_THRESHOLD 2
+#endif
+
 bool wpm_keycode(uint16_t keycode);
 bool wpm_keycode_kb(uint16_t keycode);
 bool wpm_keycode_user(uint16_t keycode);
@@ -28,3 +44,6 @@ uint8_t get_current_wpm(void);
 void    update_wpm(uint16_t);
 
 void decay_wpm(void);
+
+/* True if synced_wpm, the value the other half has, is out of date */
+bool wpm_sync_needed(uint8_t synced_wpm);
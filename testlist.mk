@@ -3,6 +3,7 @@ FULL_TESTS := $(TEST_LIST)
 
 include $(ROOT_DIR)/quantum/sequencer/tests/testlist.mk
 include $(ROOT_DIR)/quantum/serial_link/tests/testlist.mk
+include $(ROOT_DIR)/tmk_core/protocol/arm_atsam/tests/testlist.mk
 
 define VALIDATE_TEST_LIST
     ifneq ($1,)
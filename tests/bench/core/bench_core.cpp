@@ -0,0 +1,119 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "bench.hpp"
+#include <string.h>
+#include "action.h"
+#include "keyboard.h"
+#include "report.h"
+#include "host.h"
+
+extern "C" {
+#include "action_layer.h"
+#include "matrix.h"
+#include "debounce.h"
+#include "timer.h"
+
+bool process_record_quantum(keyrecord_t* record);
+void advance_time(uint32_t ms);
+
+extern int COMBO_LEN;
+}
+
+namespace {
+const keypos_t key = {.col = 3, .row = 5};
+
+keyevent_t key_event(bool pressed) { return (keyevent_t){.key = key, .pressed = pressed, .time = (uint16_t)(timer_read() | 1)}; }
+
+// Layers 1..layers-1 on top of the base layer, all of them transparent at key
+void enable_layers(long layers) { layer_state_set(((layer_state_t)1 << layers) - 2); }
+}  // namespace
+
+class LayerLookup : public BenchFixture, public testing::WithParamInterface<long> {};
+
+TEST_P(LayerLookup, Transparent) {
+    enable_layers(GetParam());
+    bench_run("layer_switch_get_layer", {{"layers", GetParam()}}, [] { bench_keep(layer_switch_get_layer(key)); });
+    EXPECT_EQ(layer_switch_get_layer(key), 0);
+    layer_clear();
+}
+
+INSTANTIATE_TEST_CASE_P(Layers, LayerLookup, testing::Values(1, 2, 4, 8, BENCH_LAYERS));
+
+class ActionExec : public BenchFixture, public testing::WithParamInterface<long> {};
+
+TEST_P(ActionExec, Tap) {
+    enable_layers(GetParam());
+    bench_run("action_exec", {{"layers", GetParam()}}, [] {
+        action_exec(key_event(true));
+        action_exec(key_event(false));
+    });
+    layer_clear();
+}
+
+INSTANTIATE_TEST_CASE_P(Layers, ActionExec, testing::Values(1, 4, BENCH_LAYERS));
+
+class ProcessRecordQuantum : public BenchFixture, public testing::WithParamInterface<long> {};
+
+TEST_P(ProcessRecordQuantum, Tap) {
+    COMBO_LEN = GetParam();
+    bench_run("process_record_quantum", {{"combos", GetParam()}}, [] {
+        keyrecord_t record = {.event = key_event(true)};
+        bench_keep(process_record_quantum(&record));
+        record.event = key_event(false);
+        bench_keep(process_record_quantum(&record));
+    });
+    COMBO_LEN = 0;
+}
+
+INSTANTIATE_TEST_CASE_P(Combos, ProcessRecordQuantum, testing::Values(0, 8, 32, BENCH_COMBOS));
+
+class AddKeyToReport : public BenchFixture, public testing::WithParamInterface<long> {};
+
+TEST_P(AddKeyToReport, Fill) {
+    long keys = GetParam();
+    bench_run("add_key_to_report", {{"keys", keys}}, [keys] {
+        report_keyboard_t report;
+        memset(&report, 0, sizeof(report));
+        for (long i = 0; i < keys; i++) {
+            add_key_to_report(&report, KC_A + i);
+        }
+        bench_keep(report);
+    });
+}
+
+INSTANTIATE_TEST_CASE_P(Keys, AddKeyToReport, testing::Values(1, 3, KEYBOARD_REPORT_KEYS));
+
+class Debounce : public BenchFixture, public testing::WithParamInterface<long> {};
+
+// One scan per ms with a key chattering on every other scan
+TEST_P(Debounce, Chatter) {
+    uint8_t      rows                = GetParam();
+    matrix_row_t raw[MATRIX_ROWS]    = {0};
+    matrix_row_t cooked[MATRIX_ROWS] = {0};
+    uint32_t     scan                = 0;
+    debounce_init(rows);
+    bench_run(std::string("debounce/") + BENCH_DEBOUNCE_TYPE, {{"rows", rows}}, [&] {
+        bool changed = scan++ & 1;
+        if (changed) {
+            raw[rows - 1] ^= 1;
+        }
+        debounce(raw, cooked, rows, changed);
+        advance_time(1);
+    });
+}
+
+INSTANTIATE_TEST_CASE_P(Rows, Debounce, testing::Values(4, 8, MATRIX_ROWS));
@@ -0,0 +1,39 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "quantum.h"
+
+// Every key is KC_A on the base layer and transparent everywhere else, so a
+// lookup has to walk all active layers
+const uint16_t PROGMEM keymaps[BENCH_LAYERS][MATRIX_ROWS][MATRIX_COLS] = {
+    [0]                      = {[0 ... MATRIX_ROWS - 1] = {[0 ... MATRIX_COLS - 1] = KC_A}},
+    [1 ... BENCH_LAYERS - 1] = {[0 ... MATRIX_ROWS - 1] = {[0 ... MATRIX_COLS - 1] = KC_TRNS}},
+};
+
+// Two key combos on keys that are never pressed, so every combo is checked
+// and none of them fires. COMBO_LEN is set by the benchmarks.
+static uint16_t combo_keys[BENCH_COMBOS][3];
+combo_t         key_combos[BENCH_COMBOS];
+int             COMBO_LEN = 0;
+
+void keyboard_post_init_user(void) {
+    for (int i = 0; i < BENCH_COMBOS; i++) {
+        combo_keys[i][0] = KC_F13 + i % 12;
+        combo_keys[i][1] = KC_F1 + i / 12;
+        combo_keys[i][2] = COMBO_END;
+        key_combos[i]    = (combo_t)COMBO(combo_keys[i], KC_ESC);
+    }
+}
@@ -0,0 +1,72 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "bench.hpp"
+
+extern "C" {
+#include "rgb_matrix.h"
+
+void advance_time(uint32_t ms);
+}
+
+namespace {
+struct Effect {
+    const char* name;
+    uint8_t     mode;
+};
+
+const Effect effects[] = {
+    {"SOLID_COLOR", RGB_MATRIX_SOLID_COLOR},
+    {"BREATHING", RGB_MATRIX_BREATHING},
+    {"CYCLE_LEFT_RIGHT", RGB_MATRIX_CYCLE_LEFT_RIGHT},
+    {"CYCLE_PINWHEEL", RGB_MATRIX_CYCLE_PINWHEEL},
+    {"BAND_SPIRAL_VAL", RGB_MATRIX_BAND_SPIRAL_VAL},
+    {"RAINBOW_BEACON", RGB_MATRIX_RAINBOW_BEACON},
+};
+
+// Runs rgb_matrix_task() until a whole frame has been rendered and flushed
+void render_frame(void) {
+    advance_time(RGB_MATRIX_LED_FLUSH_LIMIT);
+    for (int i = 0; i < DRIVER_LED_TOTAL / RGB_MATRIX_LED_PROCESS_LIMIT + 3; i++) {
+        rgb_matrix_task();
+    }
+}
+}  // namespace
+
+class RenderEffect : public BenchFixture, public testing::WithParamInterface<std::tuple<int, long>> {};
+
+// Restarts the frame and renders the first `leds` LEDs of it
+TEST_P(RenderEffect, Leds) {
+    const Effect& effect = effects[std::get<0>(GetParam())];
+    long          leds   = std::get<1>(GetParam());
+
+    rgb_matrix_enable_noeeprom();
+    rgb_matrix_mode_noeeprom(effect.mode);
+    // The first frame after a mode change runs the effect's init
+    render_frame();
+
+    bench_run(std::string("rgb_matrix/") + effect.name, {{"leds", leds}}, [&] {
+        rgb_matrix_mode_noeeprom(effect.mode);
+        rgb_matrix_task();
+        for (long i = 0; i < leds; i += RGB_MATRIX_LED_PROCESS_LIMIT) {
+            rgb_matrix_task();
+        }
+        advance_time(1);
+    });
+    render_frame();
+}
+
+INSTANTIATE_TEST_CASE_P(Effects, RenderEffect, testing::Combine(testing::Range(0, (int)(sizeof(effects) / sizeof(effects[0]))), testing::Values(16, 32, 64, DRIVER_LED_TOTAL)));
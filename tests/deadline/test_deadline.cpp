@@ -0,0 +1,171 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "test_common.hpp"
+#include "deadline.h"
+#include <vector>
+
+using testing::_;
+using testing::AnyNumber;
+using testing::AtLeast;
+
+static std::vector<deadline_t *> fired;
+
+static void record_fired(deadline_t *deadline) { fired.push_back(deadline); }
+
+static deadline_t repeating;
+static int        repeat_count;
+
+static void repeat(deadline_t *deadline) {
+    fired.push_back(deadline);
+    if (++repeat_count < 3) {
+        deadline_schedule(deadline, 0, repeat);
+    }
+}
+
+class Deadline : public TestFixture {
+   protected:
+    void SetUp() override {
+        fired.clear();
+        repeat_count = 0;
+    }
+};
+
+TEST_F(Deadline, FiresInDueOrder) {
+    TestDriver driver;
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(AnyNumber());
+
+    deadline_t a = {}, b = {}, c = {};
+    deadline_schedule(&a, 30, record_fired);
+    deadline_schedule(&b, 10, record_fired);
+    deadline_schedule(&c, 10, record_fired);
+
+    idle_for(10);
+    EXPECT_TRUE(fired.empty());
+    EXPECT_TRUE(deadline_pending(&b));
+
+    idle_for(1);
+    // Deadlines due at the same time fire in the order they were scheduled
+    EXPECT_EQ(fired, (std::vector<deadline_t *>{&b, &c}));
+    EXPECT_FALSE(deadline_pending(&b));
+    EXPECT_TRUE(deadline_pending(&a));
+
+    idle_for(20);
+    EXPECT_EQ(fired, (std::vector<deadline_t *>{&b, &c, &a}));
+}
+
+TEST_F(Deadline, RescheduleAndCancel) {
+    TestDriver driver;
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(AnyNumber());
+
+    deadline_t a = {}, b = {};
+    deadline_schedule(&a, 10, record_fired);
+    deadline_schedule(&b, 20, record_fired);
+    deadline_schedule(&a, 30, record_fired);
+
+    idle_for(25);
+    EXPECT_EQ(fired, (std::vector<deadline_t *>{&b}));
+
+    deadline_cancel(&a);
+    EXPECT_FALSE(deadline_pending(&a));
+    idle_for(10);
+    EXPECT_EQ(fired, (std::vector<deadline_t *>{&b}));
+}
+
+TEST_F(Deadline, RescheduledFromCallbackFiresOnNextPass) {
+    TestDriver driver;
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(AnyNumber());
+
+    deadline_schedule(&repeating, 5, repeat);
+
+    idle_for(6);
+    EXPECT_EQ(repeat_count, 1);
+    run_one_scan_loop();
+    EXPECT_EQ(repeat_count, 2);
+    run_one_scan_loop();
+    EXPECT_EQ(repeat_count, 3);
+    idle_for(10);
+    EXPECT_EQ(repeat_count, 3);
+    EXPECT_FALSE(deadline_pending(&repeating));
+}
+
+TEST_F(Deadline, ComboKeyIsSentAfterComboTerm) {
+    TestDriver driver;
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(AnyNumber());
+
+    // Combos are only looked for once a key that is not part of one was seen
+    press_key(3, 0);
+    run_one_scan_loop();
+    release_key(3, 0);
+    run_one_scan_loop();
+    testing::Mock::VerifyAndClearExpectations(&driver);
+
+    // A is held back while B may still complete the combo
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(0);
+    press_key(0, 0);
+    idle_for(COMBO_TERM + 1);
+    testing::Mock::VerifyAndClearExpectations(&driver);
+
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_A))).Times(AtLeast(1));
+    run_one_scan_loop();
+    testing::Mock::VerifyAndClearExpectations(&driver);
+
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport())).Times(AtLeast(1));
+    release_key(0, 0);
+    run_one_scan_loop();
+    testing::Mock::VerifyAndClearExpectations(&driver);
+}
+
+TEST_F(Deadline, AutoShiftIsSentWhileHeld) {
+    TestDriver driver;
+
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(0);
+    press_key(2, 0);
+    idle_for(get_autoshift_timeout());
+    testing::Mock::VerifyAndClearExpectations(&driver);
+
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(AnyNumber());
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_LSFT, KC_C)));
+    run_one_scan_loop();
+    testing::Mock::VerifyAndClearExpectations(&driver);
+
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(AnyNumber());
+    release_key(2, 0);
+    run_one_scan_loop();
+    testing::Mock::VerifyAndClearExpectations(&driver);
+}
+
+TEST_F(Deadline, OneShotModsAndLayerTimeOut) {
+    TestDriver driver;
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(AnyNumber());
+
+    press_key(9, 0);
+    run_one_scan_loop();
+    release_key(9, 0);
+    run_one_scan_loop();
+    press_key(8, 0);
+    run_one_scan_loop();
+    release_key(8, 0);
+    run_one_scan_loop();
+    EXPECT_EQ(get_oneshot_mods(), MOD_BIT(KC_LCTL));
+    EXPECT_TRUE(is_oneshot_layer_active());
+
+    idle_for(ONESHOT_TIMEOUT);
+    EXPECT_EQ(get_oneshot_mods(), 0);
+    EXPECT_FALSE(is_oneshot_layer_active());
+    EXPECT_FALSE(layer_state_is(1));
+    testing::Mock::VerifyAndClearExpectations(&driver);
+}
@@ -0,0 +1,160 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "test_common.hpp"
+#include <vector>
+
+using testing::_;
+using testing::AnyNumber;
+using testing::InSequence;
+
+extern "C" {
+#include "eeprom.h"
+extern int dynamic_macro_full;
+}
+
+enum { COL_REC1, COL_REC2, COL_STOP, COL_PLAY1, COL_PLAY2, COL_A, COL_B, COL_C };
+
+class DynamicMacro : public TestFixture {
+   public:
+    void tap(uint8_t col, uint8_t row = 0) {
+        press_key(col, row);
+        run_one_scan_loop();
+        release_key(col, row);
+        run_one_scan_loop();
+    }
+
+    void record(uint8_t rec_col, void (*keys)(DynamicMacro*)) {
+        TestDriver driver;
+        EXPECT_CALL(driver, send_keyboard_mock(_)).Times(AnyNumber());
+        tap(rec_col);
+        keys(this);
+        tap(COL_STOP);
+        testing::Mock::VerifyAndClearExpectations(&driver);
+    }
+
+    /* Plays a macro and returns the first key of every report it sends,
+     * dropping repeated reports */
+    std::vector<uint8_t> play(uint8_t play_col, unsigned ms) {
+        TestDriver           driver;
+        std::vector<uint8_t> keys;
+        EXPECT_CALL(driver, send_keyboard_mock(_)).WillRepeatedly([&keys](report_keyboard_t& report) {
+            if (keys.empty() ? report.keys[0] != 0 : keys.back() != report.keys[0]) {
+                keys.push_back(report.keys[0]);
+            }
+        });
+        tap(play_col);
+        idle_for(ms);
+        testing::Mock::VerifyAndClearExpectations(&driver);
+        return keys;
+    }
+};
+
+// Runs first, the saved macros are only loaded on the first dynamic macro key
+TEST_F(DynamicMacro, DropsCorruptSavedMacro) {
+    // magic, reserved, size, then slot 1 is one byte long but holds the start
+    // of a two byte varint, a key-down of A that only a read past its end finds
+    const uint8_t header[] = {0xD4, 0, DYNAMIC_MACRO_BUFFER_SIZE & 0xFF, DYNAMIC_MACRO_BUFFER_SIZE >> 8, 1, 0, 0, 0};
+    const uint8_t buffer[] = {0x29 | 0x80, 0, 0};
+    eeprom_update_block(header, (void*)DYNAMIC_MACRO_EEPROM_ADDR, sizeof(header));
+    eeprom_update_block(buffer, (void*)(DYNAMIC_MACRO_EEPROM_ADDR + sizeof(header)), sizeof(buffer));
+
+    EXPECT_EQ(play(COL_PLAY1, 20), std::vector<uint8_t>());
+}
+
+TEST_F(DynamicMacro, PlaysBackWithRecordedTiming) {
+    record(COL_REC1, [](DynamicMacro* t) {
+        press_key(COL_A, 0);
+        t->run_one_scan_loop();
+        t->idle_for(49);
+        release_key(COL_A, 0);
+        t->run_one_scan_loop();
+        t->idle_for(199);
+        t->tap(COL_B);
+    });
+
+    TestDriver driver;
+    // clear_keyboard() at the start of the playback
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport())).Times(2);
+    tap(COL_PLAY1);
+    testing::Mock::VerifyAndClearExpectations(&driver);
+
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_A)));
+    run_one_scan_loop();
+    testing::Mock::VerifyAndClearExpectations(&driver);
+
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(0);
+    idle_for(48);
+    testing::Mock::VerifyAndClearExpectations(&driver);
+
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    idle_for(2);
+    testing::Mock::VerifyAndClearExpectations(&driver);
+
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(0);
+    idle_for(197);
+    testing::Mock::VerifyAndClearExpectations(&driver);
+
+    {
+        InSequence s;
+        EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_B)));
+        // The key-up, then clear_keyboard() at the end of the playback
+        EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport())).Times(2);
+    }
+    idle_for(10);
+    testing::Mock::VerifyAndClearExpectations(&driver);
+}
+
+TEST_F(DynamicMacro, BothSlotsShareTheBuffer) {
+    record(COL_REC1, [](DynamicMacro* t) { t->tap(COL_A); });
+    record(COL_REC2, [](DynamicMacro* t) {
+        t->tap(COL_B);
+        t->tap(9, 3);
+    });
+
+    EXPECT_EQ(play(COL_PLAY2, 20), std::vector<uint8_t>({KC_B, 0, KC_D, 0}));
+    EXPECT_EQ(play(COL_PLAY1, 20), std::vector<uint8_t>({KC_A, 0}));
+}
+
+TEST_F(DynamicMacro, HoldsMoreEventsThanKeyrecords) {
+    dynamic_macro_full = 0;
+    // Clear slot 2 so slot 1 can use the whole buffer
+    record(COL_REC2, [](DynamicMacro* t) {});
+    record(COL_REC1, [](DynamicMacro* t) {
+        for (int i = 0; i < DYNAMIC_MACRO_SIZE; i++) {
+            t->tap(COL_A + i % 3);
+        }
+    });
+    // Two events per tap, so this is twice DYNAMIC_MACRO_SIZE key events
+    EXPECT_EQ(dynamic_macro_full, 0);
+
+    std::vector<uint8_t> expected;
+    for (int i = 0; i < DYNAMIC_MACRO_SIZE; i++) {
+        expected.push_back(KC_A + i % 3);
+        expected.push_back(0);
+    }
+    EXPECT_EQ(play(COL_PLAY1, DYNAMIC_MACRO_SIZE * 2 * 2 + 10), expected);
+}
+
+TEST_F(DynamicMacro, SavesToEeprom) {
+    record(COL_REC1, [](DynamicMacro* t) { t->tap(COL_C); });
+
+    // magic, reserved, size and the two lengths, then the buffer
+    EXPECT_EQ(eeprom_read_byte((const uint8_t*)DYNAMIC_MACRO_EEPROM_ADDR), 0xD4);
+    EXPECT_EQ(eeprom_read_word((const uint16_t*)(DYNAMIC_MACRO_EEPROM_ADDR + 2)), DYNAMIC_MACRO_BUFFER_SIZE);
+    // Two bytes each for the key-down and key-up of C
+    EXPECT_EQ(eeprom_read_word((const uint16_t*)(DYNAMIC_MACRO_EEPROM_ADDR + 4)), 4);
+}
@@ -0,0 +1,158 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "test_common.hpp"
+
+extern "C" {
+#include "eeconfig.h"
+#include "eeprom.h"
+}
+
+class Eeconfig : public TestFixture {
+   protected:
+    void SetUp() override { eeconfig_flush(); }
+};
+
+TEST_F(Eeconfig, ChangesAreCommittedAfterDelay) {
+    TestDriver driver;
+
+    eeconfig_update_debug(0);
+    eeconfig_flush();
+    uint8_t checksum = eeprom_read_byte(EECONFIG_CHECKSUM);
+
+    for (uint8_t val = 1; val <= 5; val++) {
+        eeconfig_update_debug(val);
+    }
+    EXPECT_EQ(eeconfig_read_debug(), 5);
+    EXPECT_EQ(eeprom_read_byte(EECONFIG_DEBUG), 0);
+
+    idle_for(EECONFIG_COMMIT_DELAY - 1);
+    EXPECT_EQ(eeprom_read_byte(EECONFIG_DEBUG), 0);
+
+    idle_for(2);
+    EXPECT_EQ(eeprom_read_byte(EECONFIG_DEBUG), 5);
+    EXPECT_NE(eeprom_read_byte(EECONFIG_CHECKSUM), checksum);
+
+    eeconfig_update_debug(0);
+    eeconfig_flush();
+    EXPECT_EQ(eeprom_read_byte(EECONFIG_CHECKSUM), checksum);
+}
+
+TEST_F(Eeconfig, EachChangeRestartsTheDelay) {
+    TestDriver driver;
+
+    eeconfig_update_default_layer(1);
+    idle_for(EECONFIG_COMMIT_DELAY / 2);
+    eeconfig_update_default_layer(2);
+    idle_for(EECONFIG_COMMIT_DELAY - 1);
+    EXPECT_NE(eeprom_read_byte(EECONFIG_DEFAULT_LAYER), 2);
+
+    idle_for(2);
+    EXPECT_EQ(eeprom_read_byte(EECONFIG_DEFAULT_LAYER), 2);
+}
+
+TEST_F(Eeconfig, AddressesPastTheCacheAreWrittenThrough) {
+    uint8_t *addr = (uint8_t *)EECONFIG_SIZE;
+
+    eeconfig_update_byte(addr, 0x5A);
+    EXPECT_EQ(eeprom_read_byte(addr), 0x5A);
+    EXPECT_EQ(eeconfig_read_byte(addr), 0x5A);
+}
+
+TEST_F(Eeconfig, InitPicksUpDirectWrites) {
+    eeconfig_update_user(0);
+    eeconfig_init();
+
+    EXPECT_TRUE(eeconfig_is_enabled());
+    EXPECT_EQ(eeconfig_read_user(), 0x12345678u);
+    EXPECT_EQ(eeprom_read_dword(EECONFIG_USER), 0x12345678u);
+}
+
+TEST_F(Eeconfig, ChecksumMismatchRestoresDefaults) {
+    uint8_t *past = (uint8_t *)EECONFIG_SIZE;
+    eeprom_update_byte(past, 0x5A);
+    eeconfig_update_default_layer(2);
+    eeconfig_update_handedness(true);
+    eeconfig_flush();
+
+    eeprom_update_byte(EECONFIG_DEBUG, 0x0F);
+    eeconfig_reload();
+
+    EXPECT_TRUE(eeconfig_is_enabled());
+    EXPECT_EQ(eeconfig_read_debug(), 0);
+    EXPECT_EQ(eeconfig_read_default_layer(), 0);
+    EXPECT_EQ(eeprom_read_byte(EECONFIG_DEFAULT_LAYER), 0);
+    // Nothing is erased, and the handedness is kept
+    EXPECT_TRUE(eeconfig_read_handedness());
+    EXPECT_EQ(eeprom_read_byte(past), 0x5A);
+
+    // the restored block passes the check
+    eeconfig_update_handedness(false);
+    eeconfig_flush();
+    eeconfig_reload();
+    EXPECT_EQ(eeconfig_read_user(), 0x12345678u);
+    EXPECT_FALSE(eeconfig_read_handedness());
+}
+
+TEST_F(Eeconfig, UnfinishedCommitKeepsTheValues) {
+    eeconfig_update_default_layer(1);
+    eeconfig_update_debug(1);
+    eeconfig_flush();
+    EXPECT_EQ(eeprom_read_byte(EECONFIG_COMMIT), EECONFIG_COMMIT_DONE);
+
+    // Power lost after the first changed byte was written, before the checksum
+    eeprom_update_byte(EECONFIG_COMMIT, EECONFIG_COMMIT_OPEN);
+    eeprom_update_byte(EECONFIG_DEFAULT_LAYER, 3);
+    eeconfig_reload();
+
+    EXPECT_EQ(eeconfig_read_default_layer(), 3);
+    EXPECT_EQ(eeconfig_read_debug(), 1);
+    EXPECT_EQ(eeprom_read_byte(EECONFIG_COMMIT), EECONFIG_COMMIT_DONE);
+
+    // and sealed again
+    eeconfig_reload();
+    EXPECT_EQ(eeconfig_read_default_layer(), 3);
+}
+
+TEST_F(Eeconfig, PreviousLayoutIsMigrated) {
+    eeprom_update_word(EECONFIG_MAGIC, EECONFIG_MAGIC_NUMBER_V0);
+    eeprom_update_byte(EECONFIG_DEFAULT_LAYER, 2);
+    eeprom_update_byte(EECONFIG_HANDEDNESS, 1);
+    // where the previous layout kept VIA data
+    eeprom_update_byte(EECONFIG_CHECKSUM, 0x12);
+    eeprom_update_byte(EECONFIG_COMMIT, 0x34);
+    eeconfig_reload();
+
+    EXPECT_TRUE(eeconfig_is_enabled());
+    EXPECT_EQ(eeprom_read_word(EECONFIG_MAGIC), EECONFIG_MAGIC_NUMBER);
+    EXPECT_EQ(eeconfig_read_default_layer(), 2);
+    EXPECT_TRUE(eeconfig_read_handedness());
+
+    eeconfig_reload();
+    EXPECT_EQ(eeconfig_read_default_layer(), 2);
+    EXPECT_EQ(eeprom_read_byte(EECONFIG_COMMIT), EECONFIG_COMMIT_DONE);
+}
+
+TEST_F(Eeconfig, RequestedFlushSkipsTheDelay) {
+    TestDriver driver;
+
+    eeconfig_update_default_layer(3);
+    eeconfig_request_flush();
+    EXPECT_NE(eeprom_read_byte(EECONFIG_DEFAULT_LAYER), 3);
+
+    idle_for(1);
+    EXPECT_EQ(eeprom_read_byte(EECONFIG_DEFAULT_LAYER), 3);
+}
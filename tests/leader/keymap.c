@@ -0,0 +1,69 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "quantum.h"
+
+// clang-format off
+const uint16_t PROGMEM keymaps[][MATRIX_ROWS][MATRIX_COLS] = {
+    [0] = {
+        // 0      1     2     3     4     5     6     7     8     9
+        {KC_LEAD, KC_A, KC_B, KC_C, KC_D, KC_E, KC_F, KC_G, KC_H, KC_I},
+        {KC_NO,   KC_NO, KC_NO, KC_NO, KC_NO, KC_NO, KC_NO, KC_NO, KC_NO, KC_NO},
+        {KC_NO,   KC_NO, KC_NO, KC_NO, KC_NO, KC_NO, KC_NO, KC_NO, KC_NO, KC_NO},
+        {KC_NO,   KC_NO, KC_NO, KC_NO, KC_NO, KC_NO, KC_NO, KC_NO, KC_NO, KC_NO},
+    },
+};
+// clang-format on
+
+int leader_fired = 0;
+
+static void fire_a(void) { leader_fired = 1; }
+static void fire_ab(void) { leader_fired = 2; }
+static void fire_bc(void) { leader_fired = 3; }
+static void fire_cde(void) { leader_fired = 4; }
+static void fire_ddddd(void) { leader_fired = 5; }
+static void fire_long(void) { leader_fired = 6; }
+static void fire_c(void) { leader_fired = 7; }
+static void fire_cd(void) { leader_fired = 8; }
+
+// clang-format off
+LEADER_TABLE(
+    LEADER_SEQ(fire_a,     KC_A),
+    LEADER_SEQ(fire_ab,    KC_A, KC_B),
+    LEADER_SEQ(fire_bc,    KC_B, KC_C),
+    LEADER_SEQ(fire_c,     KC_C),
+    LEADER_SEQ(fire_cd,    KC_C, KC_D),
+    LEADER_SEQ(fire_cde,   KC_C, KC_D, KC_E),
+    LEADER_SEQ(fire_ddddd, KC_D, KC_D, KC_D, KC_D, KC_D),
+    LEADER_SEQ(fire_long,  KC_E, KC_F, KC_G, KC_H, KC_I, KC_A, KC_B)
+);
+// clang-format on
+
+LEADER_EXTERNS();
+
+/* The same dictionary written with the SEQ_*() macros, every entry but the one
+ * longer than leader_sequence can hold. Evaluated on leader_sequence, as
+ * LEADER_DICTIONARY() does. */
+int leader_macro_dictionary(void) {
+    SEQ_ONE_KEY(KC_A) { return 1; }
+    SEQ_TWO_KEYS(KC_A, KC_B) { return 2; }
+    SEQ_TWO_KEYS(KC_B, KC_C) { return 3; }
+    SEQ_ONE_KEY(KC_C) { return 7; }
+    SEQ_TWO_KEYS(KC_C, KC_D) { return 8; }
+    SEQ_THREE_KEYS(KC_C, KC_D, KC_E) { return 4; }
+    SEQ_FIVE_KEYS(KC_D, KC_D, KC_D, KC_D, KC_D) { return 5; }
+    return 0;
+}
@@ -0,0 +1,183 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "test_common.hpp"
+#include <string.h>
+#include <vector>
+
+using testing::_;
+using testing::AnyNumber;
+
+extern "C" {
+extern int      leader_fired;
+extern bool     leading;
+extern uint16_t leader_sequence[5];
+int             leader_macro_dictionary(void);
+}
+
+// Column of each letter in the test keymap, KC_LEAD is column 0
+#define COL(kc) ((kc)-KC_A + 1)
+
+class Leader : public TestFixture {
+   protected:
+    void tap(uint8_t col) {
+        press_key(col, 0);
+        run_one_scan_loop();
+        release_key(col, 0);
+        run_one_scan_loop();
+    }
+
+    void start(void) {
+        leader_fired = 0;
+        tap(0);
+    }
+
+    int lead(const std::vector<uint16_t>& keys) {
+        start();
+        for (uint16_t key : keys) {
+            tap(COL(key));
+        }
+        idle_for(LEADER_TIMEOUT + 10);
+        return leader_fired;
+    }
+
+    // What LEADER_DICTIONARY() fires once all of keys were typed
+    int legacy(const std::vector<uint16_t>& keys) {
+        memset(leader_sequence, 0, sizeof(leader_sequence));
+        for (size_t i = 0; i < keys.size() && i < 5; i++) {
+            leader_sequence[i] = keys[i];
+        }
+        return leader_macro_dictionary();
+    }
+
+    bool starts_longer_entry(const std::vector<uint16_t>& keys) {
+        for (uint16_t i = 0; i < leader_table_size; i++) {
+            if (keys.size() < LEADER_TABLE_MAX_LENGTH && leader_table[i].keys[keys.size()] != 0 && std::equal(keys.begin(), keys.end(), leader_table[i].keys)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // The table differs from LEADER_DICTIONARY() in one way only: a complete
+    // entry that no longer entry starts with fires at once, so the keys typed
+    // after it are not part of the sequence
+    int expected(const std::vector<uint16_t>& keys) {
+        for (size_t n = 1; n < keys.size(); n++) {
+            std::vector<uint16_t> prefix(keys.begin(), keys.begin() + n);
+            if (legacy(prefix) && !starts_longer_entry(prefix)) {
+                return legacy(prefix);
+            }
+        }
+        return legacy(keys);
+    }
+};
+
+TEST_F(Leader, MatchesMacroDictionary) {
+    TestDriver driver;
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(AnyNumber());
+
+    const uint16_t              letters[] = {KC_A, KC_B, KC_C, KC_D, KC_E};
+    std::vector<std::vector<uint16_t>> sequences;
+    for (uint16_t a : letters) {
+        sequences.push_back({a});
+        for (uint16_t b : letters) {
+            sequences.push_back({a, b});
+            for (uint16_t c : letters) {
+                sequences.push_back({a, b, c});
+            }
+        }
+    }
+    sequences.push_back({KC_D, KC_D, KC_D, KC_D});
+    sequences.push_back({KC_D, KC_D, KC_D, KC_D, KC_D});
+    sequences.push_back({KC_D, KC_D, KC_D, KC_D, KC_A});
+    sequences.push_back({KC_C, KC_D, KC_E, KC_A, KC_B});
+    sequences.push_back({KC_E, KC_F, KC_G, KC_H, KC_I});
+
+    int matched = 0;
+    for (auto& keys : sequences) {
+        int fired = lead(keys);
+        SCOPED_TRACE(testing::PrintToString(keys));
+        EXPECT_FALSE(leading);
+        EXPECT_EQ(fired, expected(keys));
+        matched += fired != 0;
+    }
+    // Prefixes of entries and keys that match nothing are covered as well
+    EXPECT_GT(matched, 0);
+    EXPECT_LT(matched, (int)sequences.size());
+}
+
+TEST_F(Leader, TableIsSorted) { EXPECT_EQ(leader_table_unsorted(leader_table, leader_table_size), leader_table_size); }
+
+TEST_F(Leader, UnsortedTableIsFound) {
+    const leader_entry_t swapped[]   = {LEADER_SEQ(NULL, KC_B), LEADER_SEQ(NULL, KC_A)};
+    const leader_entry_t duplicate[] = {LEADER_SEQ(NULL, KC_A), LEADER_SEQ(NULL, KC_A, KC_B), LEADER_SEQ(NULL, KC_A, KC_B)};
+    const leader_entry_t prefix[]    = {LEADER_SEQ(NULL, KC_A, KC_B), LEADER_SEQ(NULL, KC_A)};
+    EXPECT_EQ(leader_table_unsorted(swapped, 2), 1);
+    EXPECT_EQ(leader_table_unsorted(duplicate, 3), 2);
+    EXPECT_EQ(leader_table_unsorted(prefix, 2), 1);
+}
+
+TEST_F(Leader, UniqueSequenceFiresWithoutTimeout) {
+    TestDriver driver;
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(AnyNumber());
+
+    start();
+    tap(COL(KC_B));
+    EXPECT_TRUE(leading);
+    tap(COL(KC_C));
+    EXPECT_FALSE(leading);
+    EXPECT_EQ(leader_fired, 3);
+}
+
+TEST_F(Leader, PrefixOfLongerSequenceFiresOnTimeout) {
+    TestDriver driver;
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(AnyNumber());
+
+    start();
+    tap(COL(KC_A));
+    idle_for(LEADER_TIMEOUT - 10);
+    EXPECT_TRUE(leading);
+    EXPECT_EQ(leader_fired, 0);
+    idle_for(20);
+    EXPECT_FALSE(leading);
+    EXPECT_EQ(leader_fired, 1);
+}
+
+TEST_F(Leader, SequenceLongerThanFiveKeys) {
+    TestDriver driver;
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(AnyNumber());
+
+    EXPECT_EQ(lead({KC_E, KC_F, KC_G, KC_H, KC_I, KC_A, KC_B}), 6);
+}
+
+TEST_F(Leader, KeysAfterMatchAreSent) {
+    TestDriver driver;
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(AnyNumber());
+
+    start();
+    tap(COL(KC_B));
+    tap(COL(KC_C));
+    testing::Mock::VerifyAndClearExpectations(&driver);
+
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_D)));
+    press_key(COL(KC_D), 0);
+    run_one_scan_loop();
+    testing::Mock::VerifyAndClearExpectations(&driver);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    release_key(COL(KC_D), 0);
+    run_one_scan_loop();
+}
@@ -0,0 +1,129 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "test_common.hpp"
+
+extern "C" {
+#include "mousekey.h"
+#include "eeconfig.h"
+void advance_time(uint32_t ms);
+}
+
+using testing::_;
+using testing::AnyNumber;
+using testing::Invoke;
+
+static int moved_x, moved_y;
+
+static void record_motion(report_mouse_t& report) {
+    moved_x += report.x;
+    moved_y += report.y;
+}
+
+class MousekeyKinetic : public TestFixture {
+   protected:
+    void SetUp() override {
+        moved_x = 0;
+        moved_y = 0;
+    }
+
+    void record_reports(TestDriver& driver) { EXPECT_CALL(driver, send_mouse_mock(_)).WillRepeatedly(Invoke(record_motion)); }
+
+    // Scans every scan_ms until ms have passed since the first scan
+    void hold_for(unsigned ms, unsigned scan_ms) {
+        for (unsigned time = 0; time < ms; time += scan_ms) {
+            keyboard_task();
+            advance_time(scan_ms);
+        }
+    }
+};
+
+TEST_F(MousekeyKinetic, TapMovesOneStep) {
+    TestDriver driver;
+    record_reports(driver);
+
+    press_key(0, 0);
+    run_one_scan_loop();
+    release_key(0, 0);
+    idle_for(MOUSEKEY_DELAY * 2);
+
+    EXPECT_EQ(moved_x, MOUSEKEY_MOVE_DELTA);
+    EXPECT_EQ(moved_y, 0);
+}
+
+TEST_F(MousekeyKinetic, DistanceDoesNotDependOnScanRate) {
+    TestDriver driver;
+    record_reports(driver);
+
+    // One step, then 1000 ms speeding up from 50 to 1000 counts/s and 100 ms at 1000 counts/s
+    const int expected = MOUSEKEY_MOVE_DELTA + 525 + 100;
+
+    for (unsigned scan_ms : {1, 7, 20}) {
+        moved_x = 0;
+        press_key(0, 0);
+        hold_for(1400, scan_ms);
+        release_key(0, 0);
+        idle_for(MOUSEKEY_DELAY);
+
+        EXPECT_NEAR(moved_x, expected, 2) << "scanning every " << scan_ms << " ms";
+    }
+}
+
+TEST_F(MousekeyKinetic, AccelKeyMovesAtMaximumSpeed) {
+    TestDriver driver;
+    record_reports(driver);
+
+    press_key(2, 0);
+    press_key(0, 0);
+    press_key(1, 0);
+    idle_for(MOUSEKEY_DELAY + 1);
+    moved_x = 0;
+    moved_y = 0;
+
+    idle_for(1000);
+    // 1000 counts/s, diagonally
+    EXPECT_NEAR(moved_x, 707, 2);
+    EXPECT_NEAR(moved_y, 707, 2);
+
+    release_key(0, 0);
+    release_key(1, 0);
+    release_key(2, 0);
+    run_one_scan_loop();
+}
+
+TEST_F(MousekeyKinetic, CurveIsStoredInEeprom) {
+    TestDriver driver;
+    record_reports(driver);
+
+    mousekey_set_curve(1);
+    EXPECT_EQ(eeconfig_read_mousekey(), 1);
+
+    // Curves that do not exist are ignored
+    mousekey_set_curve(200);
+    EXPECT_EQ(mousekey_get_curve(), 1);
+
+    mousekey_init();
+    EXPECT_EQ(mousekey_get_curve(), 1);
+
+    // Half the speed of the default curve
+    press_key(0, 0);
+    hold_for(1400, 1);
+    release_key(0, 0);
+    idle_for(MOUSEKEY_DELAY);
+    EXPECT_NEAR(moved_x, MOUSEKEY_MOVE_DELTA + 262 + 50, 2);
+
+    mousekey_set_curve(0);
+}
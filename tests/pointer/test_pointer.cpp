@@ -0,0 +1,165 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "test_common.hpp"
+#include <vector>
+
+extern "C" {
+#include "pointer.h"
+#include "mousekey.h"
+
+// pointing_device.h is not valid C++
+report_mouse_t pointing_device_get_report(void);
+void           pointing_device_set_report(report_mouse_t newMouseReport);
+}
+
+using testing::_;
+using testing::AnyNumber;
+using testing::Invoke;
+
+static std::vector<report_mouse_t> reports;
+
+static void record_report(report_mouse_t& report) { reports.push_back(report); }
+
+class Pointer : public TestFixture {
+   protected:
+    void record_reports(TestDriver& driver) {
+        EXPECT_CALL(driver, send_mouse_mock(_)).WillRepeatedly(Invoke(record_report));
+        // Start at the beginning of a report interval
+        idle_for(POINTER_REPORT_INTERVAL);
+        reports.clear();
+    }
+
+    void move_device(mouse_xy_report_t x, mouse_xy_report_t y) {
+        report_mouse_t report = pointing_device_get_report();
+        report.x              = x;
+        report.y              = y;
+        pointing_device_set_report(report);
+    }
+
+    void set_device_buttons(uint8_t buttons) {
+        report_mouse_t report = pointing_device_get_report();
+        report.buttons        = buttons;
+        pointing_device_set_report(report);
+    }
+};
+
+TEST_F(Pointer, SourcesAreMergedIntoOneReport) {
+    TestDriver driver;
+    record_reports(driver);
+
+    move_device(3, -2);
+    press_key(1, 0);
+    run_one_scan_loop();
+
+    ASSERT_EQ(reports.size(), 1u);
+    EXPECT_EQ(reports[0].x, MOUSEKEY_MOVE_DELTA + 3);
+    EXPECT_EQ(reports[0].y, -2);
+
+    release_key(1, 0);
+    idle_for(POINTER_REPORT_INTERVAL);
+    EXPECT_EQ(reports.size(), 1u);
+}
+
+TEST_F(Pointer, MotionIsPacedAndCarriedOver) {
+    TestDriver driver;
+    record_reports(driver);
+
+    move_device(300, 0);
+    run_one_scan_loop();
+    ASSERT_EQ(reports.size(), 1u);
+    EXPECT_EQ(reports[0].x, 300);
+
+    // Both moves are sent together once the interval is over
+    move_device(30000, 0);
+    run_one_scan_loop();
+    move_device(30000, 0);
+    run_one_scan_loop();
+    EXPECT_EQ(reports.size(), 1u);
+
+    idle_for(POINTER_REPORT_INTERVAL - 2);
+    ASSERT_EQ(reports.size(), 2u);
+    EXPECT_EQ(reports[1].x, INT16_MAX);
+
+    // What did not fit is sent with the next report
+    idle_for(POINTER_REPORT_INTERVAL);
+    ASSERT_EQ(reports.size(), 3u);
+    EXPECT_EQ(reports[2].x, 60000 - INT16_MAX);
+
+    idle_for(POINTER_REPORT_INTERVAL);
+    EXPECT_EQ(reports.size(), 3u);
+}
+
+TEST_F(Pointer, QuickClickIsNotLost) {
+    TestDriver driver;
+    record_reports(driver);
+
+    move_device(1, 0);
+    run_one_scan_loop();
+    ASSERT_EQ(reports.size(), 1u);
+
+    // Pressed and released within one report interval
+    press_key(0, 0);
+    run_one_scan_loop();
+    release_key(0, 0);
+    run_one_scan_loop();
+    ASSERT_EQ(reports.size(), 2u);
+    EXPECT_EQ(reports[1].buttons, MOUSE_BTN1);
+
+    idle_for(POINTER_REPORT_INTERVAL);
+    ASSERT_EQ(reports.size(), 3u);
+    EXPECT_EQ(reports[2].buttons, 0);
+}
+
+TEST_F(Pointer, ButtonsOfAllSourcesAreCombined) {
+    TestDriver driver;
+    record_reports(driver);
+
+    set_device_buttons(MOUSE_BTN2);
+    press_key(0, 0);
+    idle_for(POINTER_REPORT_INTERVAL);
+    release_key(0, 0);
+    idle_for(POINTER_REPORT_INTERVAL);
+    set_device_buttons(0);
+    idle_for(POINTER_REPORT_INTERVAL);
+
+    ASSERT_EQ(reports.size(), 3u);
+    EXPECT_EQ(reports[0].buttons, MOUSE_BTN1 | MOUSE_BTN2);
+    // The device still holds its button
+    EXPECT_EQ(reports[1].buttons, MOUSE_BTN2);
+    EXPECT_EQ(reports[2].buttons, 0);
+}
+
+TEST_F(Pointer, FractionsAddUp) {
+    TestDriver driver;
+    record_reports(driver);
+
+    // A quarter count per scan
+    const int32_t quarter = (1 << POINTER_FRACTION_BITS) / 4;
+    for (int i = 0; i < 4 * POINTER_REPORT_INTERVAL; i++) {
+        pointer_move_fraction(quarter, -quarter, 0, 0);
+        run_one_scan_loop();
+    }
+    idle_for(POINTER_REPORT_INTERVAL);
+
+    int x = 0, y = 0;
+    for (auto& report : reports) {
+        x += report.x;
+        y += report.y;
+    }
+    EXPECT_EQ(x, POINTER_REPORT_INTERVAL);
+    EXPECT_EQ(y, -POINTER_REPORT_INTERVAL);
+}
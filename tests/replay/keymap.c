@@ -0,0 +1,41 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "quantum.h"
+
+/* A small typing layout with the features that change report timing: mod-taps,
+ * a layer-tap, a combo and space cadet shift */
+// clang-format off
+const uint16_t PROGMEM keymaps[][MATRIX_ROWS][MATRIX_COLS] = {
+    [0] = {
+        {KC_Q,         KC_W,         KC_E,         KC_R,         KC_T,           KC_Y,    KC_U,         KC_I,         KC_O,         KC_P},
+        {LSFT_T(KC_A), LCTL_T(KC_S), LALT_T(KC_D), KC_F,         KC_G,           KC_H,    KC_J,         KC_K,         KC_L,         KC_SCLN},
+        {KC_Z,         KC_X,         KC_C,         KC_V,         KC_B,           KC_N,    KC_M,         KC_COMM,      KC_DOT,       KC_SLSH},
+        {KC_LSPO,      KC_NO,        KC_NO,        LT(1, KC_SPC), KC_NO,         KC_NO,   KC_BSPC,      KC_ENT,       KC_NO,        KC_RSPC},
+    },
+    [1] = {
+        {KC_1,         KC_2,         KC_3,         KC_4,         KC_5,           KC_6,    KC_7,         KC_8,         KC_9,         KC_0},
+        {_______,      _______,      _______,      _______,      _______,        KC_LEFT, KC_DOWN,      KC_UP,        KC_RGHT,      _______},
+        {_______,      _______,      _______,      _______,      _______,        _______, _______,      _______,      _______,      _______},
+        {_______,      _______,      _______,      _______,      _______,        _______, _______,      _______,      _______,      _______},
+    },
+};
+// clang-format on
+
+const uint16_t PROGMEM jk_combo[] = {KC_J, KC_K, COMBO_END};
+
+combo_t key_combos[COMBO_COUNT] = {COMBO(jk_combo, KC_ESC)};
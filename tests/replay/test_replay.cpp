@@ -0,0 +1,89 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "test_common.hpp"
+#include "replay.hpp"
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+
+/* Replays a recorded session and checks the keyboard reports against a
+ * baseline. The defaults replay the sample session in this directory, and
+ * these environment variables point it elsewhere:
+ *
+ *   QMK_REPLAY_LOG             matrix event log to replay
+ *   QMK_REPLAY_BASELINE        expected reports
+ *   QMK_REPLAY_UPDATE          if set, writes the reports to the baseline instead
+ *   QMK_REPLAY_STATS           file to write the timing summary to
+ *   QMK_REPLAY_STATS_BASELINE  timing summary of an earlier run to compare with
+ *   QMK_REPLAY_TOLERANCE       allowed slowdown of the mean event time, in % (default 20)
+ */
+static std::string env_or(const char* name, const char* fallback) {
+    const char* value = getenv(name);
+    return value ? value : fallback;
+}
+
+class Replay : public ReplayFixture {};
+
+TEST_F(Replay, ParsesKeyLoggerOutput) {
+    std::string   path = testing::TempDir() + "replay_kl.log";
+    std::ofstream log(path);
+    log << "KL: kc: 0x0004, col: 0, row: 1, pressed: 1, time: 5001, interrupt: 0, count: 0\n"
+        << "# comment\n"
+        << "KL: kc: 0x0005, col: 4, row: 2, pressed: 1, time: 4999, interrupt: 0, count: 0\n"
+        << "KL: kc: 0x0004, col: 0, row: 1, pressed: 1, time: 5001, interrupt: 0, count: 1\n"
+        << "5100 1 0 0\n";
+    log.close();
+
+    auto events = load_log(path);
+    ASSERT_EQ(events.size(), 3u);
+    EXPECT_EQ(events[0].time, 0u);
+    EXPECT_EQ(events[0].row, 2);
+    EXPECT_EQ(events[0].col, 4);
+    EXPECT_EQ(events[1].time, 2u);
+    EXPECT_TRUE(events[1].pressed);
+    EXPECT_EQ(events[2].time, 101u);
+    EXPECT_FALSE(events[2].pressed);
+}
+
+TEST_F(Replay, SessionMatchesBaseline) {
+    std::string baseline = env_or("QMK_REPLAY_BASELINE", "tests/replay/session.reports");
+
+    replay(load_log(env_or("QMK_REPLAY_LOG", "tests/replay/session.log")));
+    ReplayStats stats = this->stats();
+    std::cout << format_stats(stats) << std::endl;
+
+    if (getenv("QMK_REPLAY_STATS")) {
+        save_lines(getenv("QMK_REPLAY_STATS"), {std::to_string(stats.mean_ns)});
+    }
+    if (getenv("QMK_REPLAY_STATS_BASELINE")) {
+        auto     lines     = load_lines(getenv("QMK_REPLAY_STATS_BASELINE"));
+        uint64_t tolerance = strtoull(env_or("QMK_REPLAY_TOLERANCE", "20").c_str(), nullptr, 10);
+        ASSERT_FALSE(lines.empty());
+        EXPECT_LE(stats.mean_ns, strtoull(lines[0].c_str(), nullptr, 10) * (100 + tolerance) / 100) << "mean event time regressed";
+    }
+
+    if (getenv("QMK_REPLAY_UPDATE")) {
+        save_lines(baseline, reports());
+        return;
+    }
+
+    auto differences = diff(load_lines(baseline), reports());
+    for (const auto& line : differences) {
+        std::cout << line << std::endl;
+    }
+    EXPECT_TRUE(differences.empty()) << differences.size() << " report lines differ from " << baseline;
+}
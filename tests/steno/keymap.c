@@ -0,0 +1,44 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "quantum.h"
+#include "keymap_steno.h"
+
+// clang-format off
+const uint16_t PROGMEM keymaps[][MATRIX_ROWS][MATRIX_COLS] = {
+    [0] = {
+        {STN_S1, STN_TL, STN_KL, STN_PL, STN_WL, STN_HL, STN_RL, STN_A,  STN_O,  STN_ST1},
+        {STN_E,  STN_U,  STN_FR, STN_RR, STN_PR, STN_BR, STN_LR, STN_GR, STN_TR, STN_SR},
+        {STN_DR, STN_ZR, STN_N1, KC_NO,  KC_NO,  KC_NO,  KC_NO,  KC_NO,  KC_NO,  KC_NO},
+        {KC_NO,  KC_NO,  KC_NO,  KC_NO,  KC_NO,  KC_NO,  KC_NO,  KC_NO,  KC_NO,  KC_NO},
+    },
+};
+// clang-format on
+
+/* The virtual serial port, as seen by the host */
+uint8_t serial_data[64];
+uint8_t serial_length = 0;
+uint8_t serial_writes = 0;
+
+void virtser_send_buffer(const uint8_t *data, uint8_t length) {
+    for (uint8_t i = 0; i < length && serial_length < sizeof(serial_data); i++) {
+        serial_data[serial_length++] = data[i];
+    }
+    serial_writes++;
+}
+
+void virtser_send(const uint8_t byte) { virtser_send_buffer(&byte, 1); }
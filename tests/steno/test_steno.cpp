@@ -0,0 +1,113 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "test_common.hpp"
+#include "process_steno.h"
+#include <vector>
+
+using testing::_;
+using testing::AnyNumber;
+
+extern "C" {
+extern uint8_t serial_data[];
+extern uint8_t serial_length;
+extern uint8_t serial_writes;
+}
+
+class Steno : public TestFixture {
+   protected:
+    void SetUp() override {
+        serial_length = 0;
+        serial_writes = 0;
+    }
+
+    /* Presses all keys one scan apart, then releases them in the same order */
+    void stroke(const std::vector<std::pair<uint8_t, uint8_t>>& keys) {
+        for (auto key : keys) {
+            press_key(key.first, key.second);
+            run_one_scan_loop();
+        }
+        for (auto key : keys) {
+            release_key(key.first, key.second);
+            run_one_scan_loop();
+        }
+    }
+
+    std::vector<uint8_t> sent(void) { return std::vector<uint8_t>(serial_data, serial_data + serial_length); }
+};
+
+TEST_F(Steno, GeminiPacket) {
+    TestDriver driver;
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(AnyNumber());
+    steno_set_mode(STENO_MODE_GEMINI);
+
+    // S- T- -E -Z
+    stroke({{0, 0}, {1, 0}, {0, 1}, {1, 2}});
+
+    EXPECT_EQ(sent(), (std::vector<uint8_t>{0x80, 0x50, 0x00, 0x08, 0x00, 0x01}));
+    EXPECT_EQ(serial_writes, 1);
+}
+
+TEST_F(Steno, BoltPacket) {
+    TestDriver driver;
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(AnyNumber());
+    steno_set_mode(STENO_MODE_BOLT);
+
+    // S- A- -F, the second group has no keys and is left out
+    stroke({{0, 0}, {7, 0}, {2, 1}});
+    // -Z alone
+    stroke({{1, 2}});
+
+    EXPECT_EQ(sent(), (std::vector<uint8_t>{0x01, 0x42, 0x81, 0x00, 0xC8, 0x00}));
+    EXPECT_EQ(serial_writes, 2);
+}
+
+TEST_F(Steno, ChordHistory) {
+    TestDriver driver;
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(AnyNumber());
+    steno_set_mode(STENO_MODE_GEMINI);
+
+    uint8_t count = steno_history_count();
+    // S- T- held for about 30ms, then -E for about 50ms
+    press_key(0, 0);
+    press_key(1, 0);
+    idle_for(30);
+    release_key(0, 0);
+    release_key(1, 0);
+    idle_for(20);
+    press_key(0, 1);
+    idle_for(50);
+    release_key(0, 1);
+    run_one_scan_loop();
+
+    EXPECT_EQ(steno_history_count(), std::min(count + 2, STENO_HISTORY_SIZE));
+
+    // Event times have a resolution of 2ms
+    const steno_stroke_t* last = steno_history_get(0);
+    ASSERT_NE(last, nullptr);
+    EXPECT_EQ(last->mode, STENO_MODE_GEMINI);
+    EXPECT_EQ(last->chord[3], 0x08);
+    EXPECT_NEAR(last->released - last->pressed, 50, 1);
+    EXPECT_NEAR((int16_t)(last->sent - last->released), 0, 1);
+
+    const steno_stroke_t* first = steno_history_get(1);
+    ASSERT_NE(first, nullptr);
+    EXPECT_EQ(first->chord[1], 0x50);
+    EXPECT_NEAR(first->released - first->pressed, 30, 1);
+    EXPECT_NEAR(last->pressed - first->released, 20, 1);
+
+    EXPECT_EQ(steno_history_get(STENO_HISTORY_SIZE), nullptr);
+}
@@ -0,0 +1,62 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "quantum.h"
+
+#include <stdio.h>
+#include <string.h>
+
+enum { TD_LOG, TD_LOG2, TD_SHORT, TD_AB, TD_LOG3 };
+
+char tap_dance_log[512];
+
+static void log_event(const char *name, qk_tap_dance_state_t *state) {
+    size_t len = strlen(tap_dance_log);
+    snprintf(tap_dance_log + len, sizeof(tap_dance_log) - len, "%s%s%d:%d%s", len ? " " : "", name, state->keycode - QK_TAP_DANCE, state->count, state->interrupted ? "i" : "");
+}
+
+static void log_each_tap(qk_tap_dance_state_t *state, void *user_data) { log_event("each", state); }
+static void log_finished(qk_tap_dance_state_t *state, void *user_data) { log_event("finished", state); }
+static void log_reset(qk_tap_dance_state_t *state, void *user_data) { log_event("reset", state); }
+
+qk_tap_dance_action_t tap_dance_actions[] = {
+    [TD_LOG]   = ACTION_TAP_DANCE_FN_ADVANCED(log_each_tap, log_finished, log_reset),
+    [TD_LOG2]  = ACTION_TAP_DANCE_FN_ADVANCED(log_each_tap, log_finished, log_reset),
+    [TD_SHORT] = ACTION_TAP_DANCE_FN_ADVANCED_TIME(log_each_tap, log_finished, log_reset, 50),
+    [TD_AB]    = ACTION_TAP_DANCE_DOUBLE(KC_A, KC_B),
+    [TD_LOG3]  = ACTION_TAP_DANCE_FN_ADVANCED(log_each_tap, log_finished, log_reset),
+};
+
+uint16_t tap_dance_term_lookups = 0;
+
+// Counts how often the dances look up their term, which they do while they can time out
+uint16_t get_tapping_term(uint16_t keycode, keyrecord_t *record) {
+    if (keycode >= QK_TAP_DANCE && keycode <= QK_TAP_DANCE_MAX) {
+        tap_dance_term_lookups++;
+    }
+    return TAPPING_TERM;
+}
+
+// clang-format off
+const uint16_t PROGMEM keymaps[][MATRIX_ROWS][MATRIX_COLS] = {
+    [0] = {
+        {TD(TD_LOG), TD(TD_LOG2), TD(TD_SHORT), TD(TD_AB), KC_C,  TD(TD_LOG3), KC_NO, KC_NO, KC_NO, KC_NO},
+        {KC_NO,      KC_NO,       KC_NO,        KC_NO,     KC_NO, KC_NO,       KC_NO, KC_NO, KC_NO, KC_NO},
+        {KC_NO,      KC_NO,       KC_NO,        KC_NO,     KC_NO, KC_NO,       KC_NO, KC_NO, KC_NO, KC_NO},
+        {KC_NO,      KC_NO,       KC_NO,        KC_NO,     KC_NO, KC_NO,       KC_NO, KC_NO, KC_NO, KC_NO},
+    },
+};
+// clang-format on
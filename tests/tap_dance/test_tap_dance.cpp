@@ -0,0 +1,197 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "test_common.hpp"
+#include <string>
+
+using testing::_;
+using testing::AnyNumber;
+using testing::InSequence;
+
+extern "C" {
+extern char     tap_dance_log[512];
+extern uint16_t tap_dance_term_lookups;
+}
+
+enum { COL_LOG, COL_LOG2, COL_SHORT, COL_AB, COL_C, COL_LOG3 };
+
+class TapDance : public TestFixture {
+   public:
+    TestDriver driver;
+
+    TapDance() {
+        tap_dance_log[0] = '\0';
+        EXPECT_CALL(driver, send_keyboard_mock(_)).Times(AnyNumber());
+    }
+
+    void tap(uint8_t col) {
+        press_key(col, 0);
+        run_one_scan_loop();
+        release_key(col, 0);
+        run_one_scan_loop();
+    }
+
+    std::string log(void) {
+        std::string result = tap_dance_log;
+        tap_dance_log[0]   = '\0';
+        return result;
+    }
+};
+
+TEST_F(TapDance, SingleTapTimesOut) {
+    tap(COL_LOG);
+    EXPECT_EQ(log(), "each0:1");
+    idle_for(TAPPING_TERM);
+    EXPECT_EQ(log(), "finished0:1 reset0:1");
+}
+
+TEST_F(TapDance, TapsAreCounted) {
+    tap(COL_LOG);
+    tap(COL_LOG);
+    tap(COL_LOG);
+    idle_for(TAPPING_TERM);
+    EXPECT_EQ(log(), "each0:1 each0:2 each0:3 finished0:3 reset0:3");
+}
+
+TEST_F(TapDance, HeldPastTimeoutResetsOnRelease) {
+    press_key(COL_LOG, 0);
+    idle_for(TAPPING_TERM + 10);
+    EXPECT_EQ(log(), "each0:1 finished0:1");
+    release_key(COL_LOG, 0);
+    run_one_scan_loop();
+    EXPECT_EQ(log(), "reset0:1");
+}
+
+TEST_F(TapDance, HeldPastTimeoutIsNotPolled) {
+    press_key(COL_LOG, 0);
+    idle_for(TAPPING_TERM + 10);
+    EXPECT_EQ(log(), "each0:1 finished0:1");
+    // The finished dance only waits for its release, its timeout is not checked again
+    tap_dance_term_lookups = 0;
+    idle_for(100);
+    EXPECT_EQ(tap_dance_term_lookups, 0);
+    release_key(COL_LOG, 0);
+    run_one_scan_loop();
+    EXPECT_EQ(log(), "reset0:1");
+}
+
+TEST_F(TapDance, InterruptedByRegularKey) {
+    tap(COL_LOG);
+    tap(COL_C);
+    EXPECT_EQ(log(), "each0:1 finished0:1i reset0:1i");
+    idle_for(TAPPING_TERM);
+    EXPECT_EQ(log(), "");
+}
+
+TEST_F(TapDance, InterruptedByAnotherDance) {
+    tap(COL_LOG);
+    tap(COL_LOG2);
+    EXPECT_EQ(log(), "each0:1 finished0:1i reset0:1i each1:1");
+    idle_for(TAPPING_TERM);
+    EXPECT_EQ(log(), "finished1:1 reset1:1");
+}
+
+TEST_F(TapDance, HeldDancesAreInterruptedInStartOrder) {
+    // Start the higher index first, the order must not depend on the index
+    press_key(COL_SHORT, 0);
+    run_one_scan_loop();
+    press_key(COL_LOG2, 0);
+    run_one_scan_loop();
+    EXPECT_EQ(log(), "each2:1 finished2:1i each1:1");
+
+    press_key(COL_LOG, 0);
+    run_one_scan_loop();
+    EXPECT_EQ(log(), "finished1:1i each0:1");
+
+    release_key(COL_SHORT, 0);
+    run_one_scan_loop();
+    release_key(COL_LOG2, 0);
+    run_one_scan_loop();
+    EXPECT_EQ(log(), "reset2:1i reset1:1i");
+
+    release_key(COL_LOG, 0);
+    run_one_scan_loop();
+    idle_for(TAPPING_TERM);
+    EXPECT_EQ(log(), "finished0:1 reset0:1");
+}
+
+TEST_F(TapDance, FullListEndsTheOldestDance) {
+    // TAP_DANCE_MAX_ACTIVE is 3, the fourth held dance pushes out the first
+    press_key(COL_SHORT, 0);
+    run_one_scan_loop();
+    press_key(COL_LOG2, 0);
+    run_one_scan_loop();
+    press_key(COL_LOG, 0);
+    run_one_scan_loop();
+    log();
+
+    press_key(COL_LOG3, 0);
+    run_one_scan_loop();
+    EXPECT_EQ(log(), "finished0:1i each4:1");
+
+    release_key(COL_SHORT, 0);
+    run_one_scan_loop();
+    release_key(COL_LOG2, 0);
+    run_one_scan_loop();
+    release_key(COL_LOG, 0);
+    run_one_scan_loop();
+    EXPECT_EQ(log(), "reset2:1i reset1:1i reset0:1i");
+
+    release_key(COL_LOG3, 0);
+    run_one_scan_loop();
+    idle_for(TAPPING_TERM);
+    EXPECT_EQ(log(), "finished4:1 reset4:1");
+
+    // Every dance starts over afterwards
+    tap(COL_SHORT);
+    idle_for(50);
+    EXPECT_EQ(log(), "each2:1 finished2:1 reset2:1");
+}
+
+TEST_F(TapDance, CustomTappingTerm) {
+    tap(COL_SHORT);
+    idle_for(50);
+    EXPECT_EQ(log(), "each2:1 finished2:1 reset2:1");
+}
+
+TEST_F(TapDance, IndependentTimeouts) {
+    press_key(COL_LOG, 0);
+    run_one_scan_loop();
+    press_key(COL_SHORT, 0);
+    run_one_scan_loop();
+    EXPECT_EQ(log(), "each0:1 finished0:1i each2:1");
+    release_key(COL_SHORT, 0);
+    run_one_scan_loop();
+    idle_for(50);
+    EXPECT_EQ(log(), "finished2:1 reset2:1");
+    release_key(COL_LOG, 0);
+    run_one_scan_loop();
+    EXPECT_EQ(log(), "reset0:1i");
+}
+
+TEST_F(TapDance, DoubleSendsSecondKey) {
+    testing::Mock::VerifyAndClearExpectations(&driver);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport())).Times(AnyNumber());
+    {
+        InSequence s;
+        EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_B)));
+        EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport())).RetiresOnSaturation();
+    }
+    tap(COL_AB);
+    tap(COL_AB);
+    idle_for(TAPPING_TERM);
+    testing::Mock::VerifyAndClearExpectations(&driver);
+}
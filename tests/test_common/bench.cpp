@@ -0,0 +1,83 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "bench.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include "host.h"
+#include "keyboard.h"
+
+extern "C" {
+#include "version.h"
+}
+
+namespace {
+uint8_t bench_keyboard_leds(void) { return 0; }
+void    bench_send_keyboard(report_keyboard_t* report) {}
+void    bench_send_mouse(report_mouse_t* report) {}
+void    bench_send_system(uint16_t data) {}
+void    bench_send_consumer(uint16_t data) {}
+
+host_driver_t bench_driver = {bench_keyboard_leds, bench_send_keyboard, bench_send_mouse, bench_send_system, bench_send_consumer};
+
+unsigned long env_number(const char* name, unsigned long fallback) {
+    const char* value = getenv(name);
+    if (!value || !*value) {
+        return fallback;
+    }
+    return strtoul(value, nullptr, 10);
+}
+
+std::string format_params(const BenchParams& params, const char* separator, const char* quote, const char* assign) {
+    std::string text;
+    for (auto& param : params) {
+        if (!text.empty()) {
+            text += separator;
+        }
+        text += quote + param.first + quote + assign + std::to_string(param.second);
+    }
+    return text;
+}
+}  // namespace
+
+void BenchFixture::SetUpTestCase() {
+    host_set_driver(&bench_driver);
+    keyboard_init();
+}
+
+std::chrono::nanoseconds bench_min_time() { return std::chrono::milliseconds(env_number("QMK_BENCH_MIN_MS", 5)); }
+
+unsigned bench_repeats() { return std::max(1UL, env_number("QMK_BENCH_REPEATS", 5)); }
+
+BenchResult bench_report(const std::string& name, const BenchParams& params, uint64_t iterations, std::vector<double> samples) {
+    std::sort(samples.begin(), samples.end());
+    BenchResult result = {samples.front(), samples[samples.size() / 2], iterations, (unsigned)samples.size()};
+
+    printf("[    BENCH ] %s %s: %.1f ns/op (median %.1f, %llu ops x %u)\n", name.c_str(), format_params(params, " ", "", "=").c_str(), result.best_ns, result.median_ns, (unsigned long long)iterations, result.repeats);
+
+    const char* output = getenv("QMK_BENCH_OUTPUT");
+    if (output && *output) {
+        FILE* file = fopen(output, "a");
+        if (!file) {
+            ADD_FAILURE() << "Could not open " << output;
+            return result;
+        }
+        fprintf(file, "{\"version\": \"%s\", \"bench\": \"%s\", \"params\": {%s}, \"best_ns\": %.2f, \"median_ns\": %.2f, \"iterations\": %llu, \"repeats\": %u}\n", QMK_VERSION, name.c_str(), format_params(params, ", ", "\"", ": ").c_str(), result.best_ns, result.median_ns, (unsigned long long)iterations, result.repeats);
+        fclose(file);
+    }
+    return result;
+}
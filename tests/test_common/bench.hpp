@@ -0,0 +1,86 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <chrono>
+#include <string>
+#include <utility>
+#include <vector>
+#include "gtest/gtest.h"
+
+typedef std::vector<std::pair<std::string, long>> BenchParams;
+
+struct BenchResult {
+    double   best_ns;     // fastest repeat, per operation
+    double   median_ns;   // median repeat, per operation
+    uint64_t iterations;  // operations per repeat
+    unsigned repeats;
+};
+
+/* Base for the benchmark suites in tests/bench. Sets up the firmware once per
+ * suite with a host driver that discards all reports, so that the measured
+ * code is not slowed down by the mocks of TestDriver. */
+class BenchFixture : public testing::Test {
+   public:
+    static void SetUpTestCase();
+};
+
+/* Keeps the compiler from optimising away a value that is never used */
+template <typename T>
+inline void bench_keep(const T& value) {
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+std::chrono::nanoseconds bench_min_time();
+unsigned                 bench_repeats();
+
+/* Prints a result and appends it to the file named by QMK_BENCH_OUTPUT as
+ * one JSON object per line */
+BenchResult bench_report(const std::string& name, const BenchParams& params, uint64_t iterations, std::vector<double> samples);
+
+/* Measures op(), which should do one operation and restore whatever state the
+ * next call depends on. The batch size is doubled until a batch takes at least
+ * QMK_BENCH_MIN_MS, then QMK_BENCH_REPEATS batches of that size are timed. */
+template <typename F>
+BenchResult bench_run(const std::string& name, const BenchParams& params, F op) {
+    typedef std::chrono::steady_clock clock;
+
+    uint64_t iterations = 1;
+    while (iterations < (1ULL << 32)) {
+        auto start = clock::now();
+        for (uint64_t i = 0; i < iterations; i++) {
+            op();
+        }
+        if (clock::now() - start >= bench_min_time()) {
+            break;
+        }
+        iterations *= 2;
+    }
+
+    std::vector<double> samples;
+    for (unsigned r = 0; r < bench_repeats(); r++) {
+        auto start = clock::now();
+        for (uint64_t i = 0; i < iterations; i++) {
+            op();
+        }
+        std::chrono::duration<double, std::nano> elapsed = clock::now() - start;
+        samples.push_back(elapsed.count() / iterations);
+    }
+
+    return bench_report(name, params, iterations, samples);
+}
@@ -0,0 +1,240 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "replay.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include "gmock/gmock.h"
+#include "test_driver.hpp"
+#include "test_matrix.h"
+#include "keyboard.h"
+
+extern "C" {
+void advance_time(uint32_t ms);
+}
+
+using testing::_;
+using testing::AnyNumber;
+using testing::Invoke;
+
+namespace {
+bool parse_kl_line(const std::string& line, ReplayEvent& event) {
+    unsigned col, row, pressed, time;
+    auto     fields = line.find("col:");
+    if (fields == std::string::npos || line.find("time:") == std::string::npos) {
+        return false;
+    }
+    if (sscanf(line.c_str() + fields, "col: %u, row: %u, pressed: %u, time: %u", &col, &row, &pressed, &time) != 4) {
+        return false;
+    }
+    event = {time, (uint8_t)row, (uint8_t)col, pressed != 0};
+    return true;
+}
+
+bool parse_plain_line(const std::string& line, ReplayEvent& event) {
+    unsigned time, row, col, pressed;
+    if (sscanf(line.c_str(), "%u %u %u %u", &time, &row, &col, &pressed) != 4) {
+        return false;
+    }
+    event = {time, (uint8_t)row, (uint8_t)col, pressed != 0};
+    return true;
+}
+
+std::string format_report(uint32_t time, const report_keyboard_t& report) {
+    char buffer[32];
+    snprintf(buffer, sizeof(buffer), "%u mods %02X keys", time, report.mods);
+    std::string          line = buffer;
+    std::vector<uint8_t> keys;
+    for (size_t i = 0; i < KEYBOARD_REPORT_KEYS; i++) {
+        if (report.keys[i]) {
+            keys.push_back(report.keys[i]);
+        }
+    }
+    std::sort(keys.begin(), keys.end());
+    for (uint8_t key : keys) {
+        snprintf(buffer, sizeof(buffer), " %02X", key);
+        line += buffer;
+    }
+    return line;
+}
+}  // namespace
+
+std::vector<ReplayEvent> ReplayFixture::load_log(const std::string& path) {
+    std::ifstream file(path);
+    if (!file) {
+        ADD_FAILURE() << "cannot open " << path;
+        return {};
+    }
+
+    std::vector<ReplayEvent> events;
+    std::string              line;
+    while (std::getline(file, line)) {
+        ReplayEvent event;
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+        if (line.compare(0, 3, "KL:") == 0 ? parse_kl_line(line, event) : parse_plain_line(line, event)) {
+            events.push_back(event);
+        }
+    }
+
+    // Key logs are written as events get processed, which the tapping code
+    // may delay, so put them back in the order they happened. A key that is
+    // logged twice in the same state (e.g. a tap resolved later) is only
+    // replayed once.
+    std::stable_sort(events.begin(), events.end(), [](const ReplayEvent& a, const ReplayEvent& b) { return a.time < b.time; });
+
+    std::map<uint16_t, bool> state;
+    std::vector<ReplayEvent> result;
+    for (const auto& event : events) {
+        uint16_t key = event.row << 8 | event.col;
+        if (state[key] != event.pressed) {
+            state[key] = event.pressed;
+            result.push_back(event);
+        }
+    }
+
+    if (!result.empty()) {
+        uint32_t start = result.front().time;
+        for (auto& event : result) {
+            event.time -= start;
+        }
+    }
+    return result;
+}
+
+void ReplayFixture::replay(const std::vector<ReplayEvent>& events, uint32_t settle_ms) {
+    TestDriver driver;
+    uint32_t   now = 0;
+
+    m_reports.clear();
+    m_event_ns.clear();
+    m_idle_ns    = 0;
+    m_idle_scans = 0;
+
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(AnyNumber()).WillRepeatedly(Invoke([&](report_keyboard_t& report) { m_reports.push_back(format_report(now, report)); }));
+
+    auto scan = [&](bool changed) {
+        auto start = std::chrono::steady_clock::now();
+        keyboard_task();
+        auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+        if (changed) {
+            m_event_ns.push_back(elapsed);
+        } else {
+            m_idle_ns += elapsed;
+            m_idle_scans++;
+        }
+        advance_time(1);
+        now++;
+    };
+
+    for (size_t i = 0; i < events.size();) {
+        if (events[i].time > now) {
+            scan(false);
+            continue;
+        }
+        // Everything due by now changes the matrix before the same scan
+        for (; i < events.size() && events[i].time <= now; i++) {
+            if (events[i].pressed) {
+                press_key(events[i].col, events[i].row);
+            } else {
+                release_key(events[i].col, events[i].row);
+            }
+        }
+        scan(true);
+    }
+
+    for (uint32_t i = 0; i < settle_ms; i++) {
+        scan(false);
+    }
+    testing::Mock::VerifyAndClearExpectations(&driver);
+}
+
+ReplayStats ReplayFixture::stats() const {
+    ReplayStats stats = {};
+    stats.events      = m_event_ns.size();
+    if (m_idle_scans) {
+        stats.idle_scan_ns = m_idle_ns / m_idle_scans;
+    }
+    if (m_event_ns.empty()) {
+        return stats;
+    }
+
+    std::vector<uint64_t> sorted(m_event_ns);
+    std::sort(sorted.begin(), sorted.end());
+    uint64_t total = 0;
+    for (uint64_t ns : sorted) {
+        total += ns;
+    }
+    stats.mean_ns = total / sorted.size();
+    stats.p50_ns  = sorted[sorted.size() / 2];
+    stats.p99_ns  = sorted[std::min(sorted.size() - 1, sorted.size() * 99 / 100)];
+    stats.max_ns  = sorted.back();
+    return stats;
+}
+
+std::vector<std::string> ReplayFixture::load_lines(const std::string& path) {
+    std::vector<std::string> lines;
+    std::ifstream            file(path);
+    std::string              line;
+    while (std::getline(file, line)) {
+        if (!line.empty() && line[0] != '#') {
+            lines.push_back(line);
+        }
+    }
+    return lines;
+}
+
+void ReplayFixture::save_lines(const std::string& path, const std::vector<std::string>& lines) {
+    std::ofstream file(path);
+    for (const auto& line : lines) {
+        file << line << '\n';
+    }
+}
+
+std::vector<std::string> ReplayFixture::diff(const std::vector<std::string>& baseline, const std::vector<std::string>& actual) {
+    // Longest common subsequence, the logs are a few thousand lines at most
+    size_t                           n = baseline.size(), m = actual.size();
+    std::vector<std::vector<size_t>> lcs(n + 1, std::vector<size_t>(m + 1, 0));
+    for (size_t i = n; i-- > 0;) {
+        for (size_t j = m; j-- > 0;) {
+            lcs[i][j] = baseline[i] == actual[j] ? lcs[i + 1][j + 1] + 1 : std::max(lcs[i + 1][j], lcs[i][j + 1]);
+        }
+    }
+
+    std::vector<std::string> result;
+    size_t                   i = 0, j = 0;
+    while (i < n || j < m) {
+        if (i < n && j < m && baseline[i] == actual[j]) {
+            i++, j++;
+        } else if (j < m && (i == n || lcs[i][j + 1] >= lcs[i + 1][j])) {
+            result.push_back("+" + actual[j++]);
+        } else {
+            result.push_back("-" + baseline[i++]);
+        }
+    }
+    return result;
+}
+
+std::string format_stats(const ReplayStats& stats) {
+    std::ostringstream out;
+    out << stats.events << " events, per event ns: mean " << stats.mean_ns << ", p50 " << stats.p50_ns << ", p99 " << stats.p99_ns << ", max " << stats.max_ns << "; idle scan ns: " << stats.idle_scan_ns;
+    return out.str();
+}
@@ -0,0 +1,72 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include "test_fixture.hpp"
+
+struct ReplayEvent {
+    uint32_t time;  // ms since the start of the log
+    uint8_t  row;
+    uint8_t  col;
+    bool     pressed;
+};
+
+struct ReplayStats {
+    size_t   events;
+    uint64_t mean_ns;
+    uint64_t p50_ns;
+    uint64_t p99_ns;
+    uint64_t max_ns;
+    uint64_t idle_scan_ns;  // mean cost of a scan without matrix changes
+};
+
+/* Replays a recorded matrix event log through the whole firmware, scan by
+ * scan, and collects the keyboard reports it sends along with the time spent
+ * in each keyboard_task() that saw a matrix change.
+ *
+ * A log holds one event per line, either as "<ms> <row> <col> <0|1>" or as
+ * the "KL: ..." lines printed by the key logging snippet in faq_debug.md,
+ * which must include the time field. Blank lines and '#' comments are
+ * ignored. */
+class ReplayFixture : public TestFixture {
+   public:
+    static std::vector<ReplayEvent> load_log(const std::string& path);
+
+    /* Runs the events, then idles for settle_ms so that timeouts expire */
+    void replay(const std::vector<ReplayEvent>& events, uint32_t settle_ms = 1000);
+
+    /* One line per keyboard report: "<ms> mods <hex> keys <hex>..." */
+    const std::vector<std::string>& reports() const { return m_reports; }
+    ReplayStats                     stats() const;
+
+    static std::vector<std::string> load_lines(const std::string& path);
+    static void                     save_lines(const std::string& path, const std::vector<std::string>& lines);
+
+    /* Lines prefixed with '-' are only in the baseline, '+' only in the replay */
+    static std::vector<std::string> diff(const std::vector<std::string>& baseline, const std::vector<std::string>& actual);
+
+   private:
+    std::vector<std::string> m_reports;
+    std::vector<uint64_t>    m_event_ns;
+    uint64_t                 m_idle_ns    = 0;
+    uint64_t                 m_idle_scans = 0;
+};
+
+std::string format_stats(const ReplayStats& stats);
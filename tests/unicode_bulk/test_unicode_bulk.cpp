@@ -0,0 +1,167 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "test_common.hpp"
+#include <cstdio>
+#include <utility>
+#include <vector>
+
+using testing::_;
+
+extern "C" {
+#include "process_unicode_common.h"
+}
+
+typedef std::vector<std::pair<uint8_t, uint8_t>> presses_t;
+
+static const char *const TEXT = "h\xC3\xA9llo \xE2\x98\xBA \xF0\x9F\x98\x80";  // "héllo ☺ 😀"
+
+class UnicodeBulk : public TestFixture {
+   public:
+    std::vector<std::pair<uint8_t, uint8_t>> reports;
+
+    /* Runs f and collects every report it sends, then runs the main loop until
+     * the bulk output is done */
+    template <typename F>
+    void capture(F f) {
+        TestDriver driver;
+        reports.clear();
+        EXPECT_CALL(driver, send_keyboard_mock(_)).WillRepeatedly([this](report_keyboard_t &report) { reports.emplace_back(report.mods, report.keys[0]); });
+        f();
+        for (int i = 0; i < 10000 && unicode_bulk_busy(); i++) {
+            run_one_scan_loop();
+        }
+        testing::Mock::VerifyAndClearExpectations(&driver);
+    }
+
+    /* Mods and key of every key-down, which is what the host types */
+    presses_t presses(void) {
+        presses_t result;
+        uint8_t   previous = KC_NO;
+        for (auto &report : reports) {
+            if (report.second != KC_NO && report.second != previous) {
+                result.push_back(report);
+            }
+            previous = report.second;
+        }
+        return result;
+    }
+
+    /* register_unicode() without the bulk output */
+    static void register_unicode_blocking(uint32_t code_point) {
+        if (code_point > 0xFFFF && get_unicode_input_mode() == UC_WIN) {
+            return;
+        }
+        unicode_input_start();
+        if (code_point > 0xFFFF && get_unicode_input_mode() == UC_MAC) {
+            code_point -= 0x10000;
+            register_hex32((code_point >> 10) + 0xD800);
+            register_hex32((code_point & 0x3FF) + 0xDC00);
+        } else {
+            register_hex32(code_point);
+        }
+        unicode_input_finish();
+    }
+};
+
+TEST_F(UnicodeBulk, MatchesBlockingOutputAndBenchmark) {
+    static const char *const names[] = {"UC_MAC", "UC_LNX", "UC_WIN", "UC_BSD", "UC_WINC"};
+
+    std::printf("Reports per code point for \"%s\":\n", TEXT);
+    for (uint8_t mode = UC_MAC; mode < UC__COUNT; mode++) {
+        set_unicode_input_mode(mode);
+
+        int       code_points = 0;
+        presses_t expected;
+        capture([&] {
+            for (const char *str = TEXT; *str;) {
+                int32_t code_point;
+                str = decode_utf8(str, &code_point);
+                register_unicode_blocking(code_point);
+                code_points++;
+            }
+        });
+        expected        = presses();
+        size_t blocking = reports.size();
+
+        capture([] { send_unicode_string(TEXT); });
+        SCOPED_TRACE(names[mode]);
+        EXPECT_EQ(presses(), expected);
+        EXPECT_LE(reports.size(), blocking * 3 / 4);
+        EXPECT_EQ(reports.back(), std::make_pair((uint8_t)0, (uint8_t)KC_NO));
+
+        std::printf("  %-8s blocking %5.2f  bulk %5.2f\n", names[mode], (double)blocking / code_points, (double)reports.size() / code_points);
+    }
+}
+
+TEST_F(UnicodeBulk, DoesNotBlock) {
+    set_unicode_input_mode(UC_LNX);
+
+    TestDriver driver;
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(0);
+    EXPECT_TRUE(unicode_bulk_string(TEXT));
+    EXPECT_TRUE(unicode_bulk_busy());
+    testing::Mock::VerifyAndClearExpectations(&driver);
+
+    capture([] {});
+    EXPECT_FALSE(unicode_bulk_busy());
+    EXPECT_GT(reports.size(), 0u);
+}
+
+TEST_F(UnicodeBulk, KeepsOrderWithRegularReports) {
+    set_unicode_input_mode(UC_LNX);
+
+    capture([] {
+        register_unicode(0x00E9);
+        tap_code(KC_A);
+    });
+    presses_t typed = presses();
+    ASSERT_GE(typed.size(), 2u);
+    // The space that finishes the code point comes before A
+    EXPECT_EQ(typed[typed.size() - 2].second, KC_SPC);
+    EXPECT_EQ(typed.back().second, KC_A);
+}
+
+TEST_F(UnicodeBulk, RegularReportsDoNotBlock) {
+    set_unicode_input_mode(UC_LNX);
+
+    TestDriver driver;
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(0);
+    register_unicode(0x00E9);
+    tap_code(KC_A);
+    EXPECT_TRUE(unicode_bulk_busy());
+    testing::Mock::VerifyAndClearExpectations(&driver);
+
+    capture([] {});
+    presses_t typed = presses();
+    ASSERT_GE(typed.size(), 2u);
+    EXPECT_EQ(typed[typed.size() - 2].second, KC_SPC);
+    EXPECT_EQ(typed.back().second, KC_A);
+}
+
+TEST_F(UnicodeBulk, KeyPress) {
+    set_unicode_input_mode(UC_WINC);
+
+    capture([this] {
+        press_key(0, 0);
+        run_one_scan_loop();
+        release_key(0, 0);
+        run_one_scan_loop();
+    });
+    // Right Alt is tapped first, but only key-downs are listed here
+    presses_t expected = {{0, KC_U}, {0, KC_0}, {0, KC_0}, {0, KC_E}, {0, KC_9}, {0, KC_ENTER}};
+    EXPECT_EQ(presses(), expected);
+}
@@ -0,0 +1,145 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "test_common.hpp"
+#include "replay.hpp"
+#include <algorithm>
+#include <cmath>
+
+extern "C" {
+#include "wpm.h"
+}
+
+using testing::_;
+using testing::AnyNumber;
+
+/* Plays typing traces and compares the estimate with the speed they were
+ * typed at. */
+class Wpm : public ReplayFixture {
+   protected:
+    struct Sample {
+        uint32_t time;
+        uint8_t  wpm;
+    };
+
+    /* Plays the events scan by scan and samples the estimate every ms,
+     * including settle_ms after the last event */
+    std::vector<Sample> play(const std::vector<ReplayEvent>& events, uint32_t settle_ms) {
+        std::vector<Sample> samples;
+        uint32_t            time = 0;
+        auto                scan = [&]() {
+            run_one_scan_loop();
+            samples.push_back({time++, get_current_wpm()});
+        };
+
+        for (const auto& event : events) {
+            while (time < event.time) {
+                scan();
+            }
+            if (event.pressed) {
+                press_key(event.col, event.row);
+            } else {
+                release_key(event.col, event.row);
+            }
+        }
+        for (uint32_t end = time + settle_ms; time < end;) {
+            scan();
+        }
+        return samples;
+    }
+
+    static double typed_wpm(const std::vector<ReplayEvent>& events, uint32_t from, uint32_t to) {
+        unsigned presses = 0;
+        for (const auto& event : events) {
+            presses += event.pressed && event.time >= from && event.time < to;
+        }
+        return presses / 5.0 * 60000.0 / (to - from);
+    }
+};
+
+TEST_F(Wpm, SteadyTypingIsTracked) {
+    TestDriver driver;
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(AnyNumber());
+
+    auto events  = load_log("tests/wpm/steady.log");
+    auto samples = play(events, 0);
+    auto typed   = typed_wpm(events, 0, events.back().time);
+
+    // Once the window filled up the estimate stays close to the typing speed
+    double   error = 0, worst = 0;
+    unsigned count = 0;
+    for (const auto& sample : samples) {
+        if (sample.time < WPM_WINDOW) {
+            continue;
+        }
+        double difference = std::abs(sample.wpm - typed);
+        error += difference;
+        worst = std::max(worst, difference);
+        count++;
+    }
+    ASSERT_GT(count, 0u);
+    EXPECT_LT(error / count, typed * 0.08) << "mean error against " << typed << " WPM";
+    EXPECT_LT(worst, typed * 0.25) << "worst error against " << typed << " WPM";
+}
+
+TEST_F(Wpm, BurstIsPickedUpWithinOneWindow) {
+    TestDriver driver;
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(AnyNumber());
+
+    // The trace speeds up 20 s in and stops 15 s later
+    const uint32_t burst   = 20000;
+    auto           events  = load_log("tests/wpm/burst.log");
+    auto           samples = play(events, WPM_WINDOW + 1);
+    auto           slow    = typed_wpm(events, 0, burst);
+    auto           fast    = typed_wpm(events, burst, events.back().time);
+
+    EXPECT_NEAR(samples[burst - 1].wpm, slow, slow * 0.2);
+    EXPECT_NEAR(samples[burst + WPM_WINDOW].wpm, fast, fast * 0.15);
+    EXPECT_NEAR(samples[events.back().time].wpm, fast, fast * 0.15);
+
+    // Nothing is left one window after the last key press
+    EXPECT_EQ(samples.back().wpm, 0);
+}
+
+TEST_F(Wpm, TypingFasterThanTheRingHoldsIsMeasured) {
+    TestDriver driver;
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(AnyNumber());
+
+    // 240 WPM fills the ring before a window passed
+    for (int i = 0; i < WPM_SAMPLES * 2; i++) {
+        press_key(0, 0);
+        run_one_scan_loop();
+        release_key(0, 0);
+        idle_for(49);
+    }
+    EXPECT_NEAR(get_current_wpm(), 240, 5);
+
+    idle_for(WPM_WINDOW);
+    EXPECT_EQ(get_current_wpm(), 0);
+}
+
+TEST_F(Wpm, SyncFollowsThreshold) {
+    set_current_wpm(60);
+    EXPECT_FALSE(wpm_sync_needed(60));
+    EXPECT_FALSE(wpm_sync_needed(60 - WPM_SYNC_THRESHOLD + 1));
+    EXPECT_TRUE(wpm_sync_needed(60 - WPM_SYNC_THRESHOLD));
+    EXPECT_TRUE(wpm_sync_needed(60 + WPM_SYNC_THRESHOLD));
+
+    // Stopping is always passed on
+    set_current_wpm(0);
+    EXPECT_TRUE(wpm_sync_needed(1));
+    EXPECT_FALSE(wpm_sync_needed(0));
+}
@@ -12,6 +12,8 @@ TMK_COMMON_SRC +=	$(COMMON_DIR)/host.c \
 	$(COMMON_DIR)/action_util.c \
 	$(COMMON_DIR)/print.c \
 	$(COMMON_DIR)/debug.c \
+	$(COMMON_DIR)/deadline.c \
+	$(COMMON_DIR)/pointer.c \
 	$(COMMON_DIR)/sendchar_null.c \
 	$(COMMON_DIR)/eeconfig.c \
 	$(COMMON_DIR)/report.c \
@@ -151,6 +153,11 @@ ifeq ($(strip $(SHARED_EP_ENABLE)), yes)
     TMK_COMMON_DEFS += -DSHARED_EP_ENABLE
 endif
 
+ifeq ($(strip $(TASK_SCHEDULER_ENABLE)), yes)
+    TMK_COMMON_SRC += $(COMMON_DIR)/task_scheduler.c
+    TMK_COMMON_DEFS += -DTASK_SCHEDULER_ENABLE
+endif
+
 ifeq ($(strip $(LTO_ENABLE)), yes)
     ifeq ($(PLATFORM),CHIBIOS)
         $(info Enabling LTO on ChibiOS-targeting boards is known to have a high likelihood of failure.)
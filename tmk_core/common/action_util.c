@@ -20,7 +20,11 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "action_util.h"
 #include "action_layer.h"
 #include "timer.h"
+#include "deadline.h"
 #include "keycode_config.h"
+#ifdef UNICODE_BULK_ENABLE
+#    include "process_unicode_bulk.h"
+#endif
 
 extern keymap_config_t keymap_config;
 
@@ -63,8 +67,21 @@ void clear_oneshot_locked_mods(void) {
     }
 }
 #    if (defined(ONESHOT_TIMEOUT) && (ONESHOT_TIMEOUT > 0))
-static uint16_t oneshot_time = 0;
-bool            has_oneshot_mods_timed_out(void) { return TIMER_DIFF_16(timer_read(), oneshot_time) >= ONESHOT_TIMEOUT; }
+static uint16_t   oneshot_time = 0;
+static deadline_t oneshot_mods_deadline;
+bool              has_oneshot_mods_timed_out(void) { return TIMER_DIFF_16(timer_read(), oneshot_time) >= ONESHOT_TIMEOUT; }
+
+static void oneshot_mods_timeout(deadline_t *deadline) { clear_oneshot_mods(); }
+
+static void start_oneshot_mods_timer(void) {
+    oneshot_time = timer_read();
+    deadline_schedule(&oneshot_mods_deadline, ONESHOT_TIMEOUT, oneshot_mods_timeout);
+}
+
+static void stop_oneshot_mods_timer(void) {
+    oneshot_time = 0;
+    deadline_cancel(&oneshot_mods_deadline);
+}
 #    else
 bool has_oneshot_mods_timed_out(void) { return false; }
 #    endif
@@ -93,11 +110,37 @@ enum {
 #    endif
 
 #    if (defined(ONESHOT_TIMEOUT) && (ONESHOT_TIMEOUT > 0))
-static uint16_t oneshot_layer_time = 0;
-inline bool     has_oneshot_layer_timed_out() { return TIMER_DIFF_16(timer_read(), oneshot_layer_time) >= ONESHOT_TIMEOUT && !(get_oneshot_layer_state() & ONESHOT_TOGGLED); }
+static uint16_t   oneshot_layer_time = 0;
+static deadline_t oneshot_layer_deadline;
+inline bool       has_oneshot_layer_timed_out() { return TIMER_DIFF_16(timer_read(), oneshot_layer_time) >= ONESHOT_TIMEOUT && !(get_oneshot_layer_state() & ONESHOT_TOGGLED); }
+#        ifdef SWAP_HANDS_ENABLE
+static uint16_t   oneshot_swaphands_time = 0;
+static deadline_t oneshot_swaphands_deadline;
+inline bool       has_oneshot_swaphands_timed_out() { return TIMER_DIFF_16(timer_read(), oneshot_swaphands_time) >= ONESHOT_TIMEOUT && (swap_hands_oneshot == SHO_ACTIVE); }
+#        endif
+
+/* The timeouts are checked when their deadline is due instead of on every
+ * scan. A toggled one-shot layer does not time out, its deadline is set again
+ * if the toggle is cleared while the layer stays on. */
+static uint32_t oneshot_time_left(uint16_t since) {
+    uint16_t elapsed = TIMER_DIFF_16(timer_read(), since);
+    return elapsed >= ONESHOT_TIMEOUT ? 0 : ONESHOT_TIMEOUT - elapsed;
+}
+
+static void oneshot_layer_timeout(deadline_t *deadline) {
+    if (has_oneshot_layer_timed_out()) {
+        clear_oneshot_layer_state(ONESHOT_OTHER_KEY_PRESSED);
+    }
+}
+
+static void schedule_oneshot_layer_timeout(void) { deadline_schedule(&oneshot_layer_deadline, oneshot_time_left(oneshot_layer_time), oneshot_layer_timeout); }
+
 #        ifdef SWAP_HANDS_ENABLE
-static uint16_t oneshot_swaphands_time = 0;
-inline bool     has_oneshot_swaphands_timed_out() { return TIMER_DIFF_16(timer_read(), oneshot_swaphands_time) >= ONESHOT_TIMEOUT && (swap_hands_oneshot == SHO_ACTIVE); }
+static void oneshot_swaphands_timeout(deadline_t *deadline) {
+    if (has_oneshot_swaphands_timed_out()) {
+        clear_oneshot_swaphands();
+    }
+}
 #        endif
 #    endif
 
@@ -110,6 +153,7 @@ void set_oneshot_swaphands(void) {
     oneshot_swaphands_time = timer_read();
     if (oneshot_layer_time != 0) {
         oneshot_layer_time = oneshot_swaphands_time;
+        schedule_oneshot_layer_timeout();
     }
 #        endif
 }
@@ -117,6 +161,9 @@ void set_oneshot_swaphands(void) {
 void release_oneshot_swaphands(void) {
     if (swap_hands_oneshot == SHO_PRESSED) {
         swap_hands_oneshot = SHO_ACTIVE;
+#        if (defined(ONESHOT_TIMEOUT) && (ONESHOT_TIMEOUT > 0))
+        deadline_schedule(&oneshot_swaphands_deadline, oneshot_time_left(oneshot_swaphands_time), oneshot_swaphands_timeout);
+#        endif
     }
     if (swap_hands_oneshot == SHO_USED) {
         clear_oneshot_swaphands();
@@ -137,6 +184,7 @@ void clear_oneshot_swaphands(void) {
     swap_hands         = false;
 #        if (defined(ONESHOT_TIMEOUT) && (ONESHOT_TIMEOUT > 0))
     oneshot_swaphands_time = 0;
+    deadline_cancel(&oneshot_swaphands_deadline);
 #        endif
 }
 
@@ -151,6 +199,7 @@ void set_oneshot_layer(uint8_t layer, uint8_t state) {
     layer_on(layer);
 #    if (defined(ONESHOT_TIMEOUT) && (ONESHOT_TIMEOUT > 0))
     oneshot_layer_time = timer_read();
+    schedule_oneshot_layer_timeout();
 #    endif
     oneshot_layer_changed_kb(get_oneshot_layer());
 }
@@ -162,6 +211,7 @@ void reset_oneshot_layer(void) {
     oneshot_layer_data = 0;
 #    if (defined(ONESHOT_TIMEOUT) && (ONESHOT_TIMEOUT > 0))
     oneshot_layer_time = 0;
+    deadline_cancel(&oneshot_layer_deadline);
 #    endif
     oneshot_layer_changed_kb(get_oneshot_layer());
 }
@@ -176,6 +226,11 @@ void clear_oneshot_layer_state(oneshot_fullfillment_t state) {
         layer_off(get_oneshot_layer());
         reset_oneshot_layer();
     }
+#    if (defined(ONESHOT_TIMEOUT) && (ONESHOT_TIMEOUT > 0))
+    if (get_oneshot_layer_state() && (start_state & ONESHOT_TOGGLED) && !(oneshot_layer_data & ONESHOT_TOGGLED)) {
+        schedule_oneshot_layer_timeout();
+    }
+#    endif
 }
 /** \brief Is oneshot layer active
  *
@@ -206,6 +261,12 @@ void send_keyboard_report(void) {
         }
     }
 
+#endif
+#ifdef UNICODE_BULK_ENABLE
+    // Queued Unicode input has to reach the host first
+    if (unicode_bulk_defer_report(keyboard_report)) {
+        return;
+    }
 #endif
     host_keyboard_send(keyboard_report);
 }
@@ -299,7 +360,7 @@ uint8_t get_oneshot_mods(void) { return oneshot_mods; }
 void add_oneshot_mods(uint8_t mods) {
     if ((oneshot_mods & mods) != mods) {
 #    if (defined(ONESHOT_TIMEOUT) && (ONESHOT_TIMEOUT > 0))
-        oneshot_time = timer_read();
+        start_oneshot_mods_timer();
 #    endif
         oneshot_mods |= mods;
         oneshot_mods_changed_kb(mods);
@@ -310,7 +371,11 @@ void del_oneshot_mods(uint8_t mods) {
     if (oneshot_mods & mods) {
         oneshot_mods &= ~mods;
 #    if (defined(ONESHOT_TIMEOUT) && (ONESHOT_TIMEOUT > 0))
-        oneshot_time = oneshot_mods ? timer_read() : 0;
+        if (oneshot_mods) {
+            start_oneshot_mods_timer();
+        } else {
+            stop_oneshot_mods_timer();
+        }
 #    endif
         oneshot_mods_changed_kb(oneshot_mods);
     }
@@ -323,7 +388,7 @@ void del_oneshot_mods(uint8_t mods) {
 void set_oneshot_mods(uint8_t mods) {
     if (oneshot_mods != mods) {
 #    if (defined(ONESHOT_TIMEOUT) && (ONESHOT_TIMEOUT > 0))
-        oneshot_time = timer_read();
+        start_oneshot_mods_timer();
 #    endif
         oneshot_mods = mods;
         oneshot_mods_changed_kb(mods);
@@ -337,7 +402,7 @@ void clear_oneshot_mods(void) {
     if (oneshot_mods) {
         oneshot_mods = 0;
 #    if (defined(ONESHOT_TIMEOUT) && (ONESHOT_TIMEOUT > 0))
-        oneshot_time = 0;
+        stop_oneshot_mods_timer();
 #    endif
         oneshot_mods_changed_kb(oneshot_mods);
     }
@@ -2,6 +2,7 @@
 #include "i2c_master.h"
 #include "md_rgb_matrix.h"
 #include "suspend.h"
+#include "eeconfig.h"
 
 /** \brief Suspend idle
  *
@@ -31,6 +32,8 @@ void suspend_power_down(void) {
     I2C3733_Control_Set(0);  // Disable LED driver
 #endif
 
+    eeconfig_flush();
+
     suspend_power_down_kb();
 }
 
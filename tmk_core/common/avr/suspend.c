@@ -9,6 +9,7 @@
 #include "timer.h"
 #include "led.h"
 #include "host.h"
+#include "eeconfig.h"
 
 #ifdef PROTOCOL_LUFA
 #    include "lufa.h"
@@ -127,6 +128,9 @@ static void power_down(uint8_t wdto) {
  * FIXME: needs doc
  */
 void suspend_power_down(void) {
+    // Commit settings changed just before the host went to sleep
+    eeconfig_flush();
+
     suspend_power_down_kb();
 
 #ifndef NO_SUSPEND_POWER_DOWN
@@ -11,6 +11,7 @@
 #include "suspend.h"
 #include "led.h"
 #include "wait.h"
+#include "eeconfig.h"
 
 #ifdef BACKLIGHT_ENABLE
 #    include "backlight.h"
@@ -62,10 +63,14 @@ void suspend_power_down(void) {
     // TODO: figure out what to power down and how
     // shouldn't power down TPM/FTM if we want a breathing LED
     // also shouldn't power down USB
-#if defined(RGBLIGHT_SLEEP) && defined(RGBLIGHT_ENABLE)
+#if defined(RGBLIGHT_SLEEP) && defined(RGBLIGHT_ENABLE) && !defined(EFFECTS_THREAD_ENABLE)
+    // the effects thread follows the USB state itself
     rgblight_suspend();
 #endif
 
+    // The host may cut power while suspended
+    eeconfig_flush();
+
     suspend_power_down_kb();
     // on AVR, this enables the watchdog for 15ms (max), and goes to
     // SLEEP_MODE_PWR_DOWN
@@ -127,7 +132,7 @@ void suspend_wakeup_init(void) {
     backlight_init();
 #endif /* BACKLIGHT_ENABLE */
     led_set(host_keyboard_leds());
-#if defined(RGBLIGHT_SLEEP) && defined(RGBLIGHT_ENABLE)
+#if defined(RGBLIGHT_SLEEP) && defined(RGBLIGHT_ENABLE) && !defined(EFFECTS_THREAD_ENABLE)
     rgblight_wakeup();
 #endif
     suspend_wakeup_init_kb();
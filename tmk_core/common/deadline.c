@@ -0,0 +1,89 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Shared deadline queue.
+ *
+ * Timeout driven features used to compare their own timer against a term on
+ * every scan. Instead they schedule a deadline when the timeout starts, and
+ * deadline_task() only has to look at the head of a list sorted by due time,
+ * so an idle keyboard costs a single comparison per scan whatever the number
+ * of features. Deadlines due at the same time fire in the order they were
+ * scheduled.
+ */
+
+#include <stddef.h>
+#include "deadline.h"
+#include "timer.h"
+
+static deadline_t *queue = NULL;
+
+/* Set while deadline_task() runs callbacks, see deadline_schedule() */
+static bool     running = false;
+static uint32_t running_now;
+
+static void deadline_unlink(deadline_t *deadline) {
+    for (deadline_t **link = &queue; *link; link = &(*link)->next) {
+        if (*link == deadline) {
+            *link = deadline->next;
+            break;
+        }
+    }
+    deadline->pending = false;
+}
+
+void deadline_schedule(deadline_t *deadline, uint32_t delay, deadline_func_t func) {
+    if (deadline->pending) {
+        deadline_unlink(deadline);
+    }
+
+    deadline->func = func;
+    deadline->due  = timer_read32() + delay;
+    // A deadline scheduled from a callback never fires in the same pass, so a
+    // callback that reschedules itself with no delay cannot stall the loop
+    if (running && timer_expired32(running_now, deadline->due)) {
+        deadline->due = running_now + 1;
+    }
+
+    deadline_t **link = &queue;
+    while (*link && timer_expired32(deadline->due, (*link)->due)) {
+        link = &(*link)->next;
+    }
+    deadline->next    = *link;
+    *link             = deadline;
+    deadline->pending = true;
+}
+
+void deadline_cancel(deadline_t *deadline) {
+    if (deadline->pending) {
+        deadline_unlink(deadline);
+    }
+}
+
+void deadline_task(void) {
+    if (!queue) {
+        return;
+    }
+
+    running     = true;
+    running_now = timer_read32();
+    while (queue && timer_expired32(running_now, queue->due)) {
+        deadline_t *deadline = queue;
+        queue                = deadline->next;
+        deadline->pending    = false;
+        deadline->func(deadline);
+    }
+    running = false;
+}
@@ -0,0 +1,52 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct deadline deadline_t;
+
+typedef void (*deadline_func_t)(deadline_t *deadline);
+
+/* A pending timeout. The caller owns the storage, usually a static variable,
+ * and the queue links it in place so scheduling never allocates. */
+struct deadline {
+    deadline_t *    next;
+    deadline_func_t func;
+    uint32_t        due;
+    bool            pending;
+};
+
+/* Calls func once delay ms have passed. A deadline that is already pending is
+ * moved to its new due time. */
+void deadline_schedule(deadline_t *deadline, uint32_t delay, deadline_func_t func);
+void deadline_cancel(deadline_t *deadline);
+
+static inline bool deadline_pending(const deadline_t *deadline) { return deadline->pending; }
+
+/* Runs the callbacks of every deadline that is due, earliest first. Called by
+ * keyboard_task() right after the matrix scan. */
+void deadline_task(void);
+
+#ifdef __cplusplus
+}
+#endif
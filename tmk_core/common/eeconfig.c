@@ -1,8 +1,11 @@
 #include <stdint.h>
 #include <stdbool.h>
+#include <string.h>
 #include "eeprom.h"
 #include "eeconfig.h"
 #include "action_layer.h"
+#include "timer.h"
+#include "debug.h"
 
 #ifdef STM32_EEPROM_ENABLE
 #    include <hal.h>
@@ -17,6 +20,274 @@
 #    include "haptic.h"
 #endif
 
+#ifdef EFFECTS_THREAD_ENABLE
+#    include "atomic_util.h"
+#    define EECONFIG_ATOMIC ATOMIC_BLOCK_FORCEON
+#else
+#    define EECONFIG_ATOMIC
+#endif
+
+/* RAM copy of the EECONFIG_* block
+ *
+ * It is read once, on first access, and changes only mark their bytes dirty.
+ * eeconfig_task() writes them all in one go once no change has been made for
+ * EECONFIG_COMMIT_DELAY ms. Holding down an RGB key then costs one EEPROM
+ * write instead of one per step, which matters most where the EEPROM is
+ * emulated in flash.
+ *
+ * A commit clears EECONFIG_COMMIT, writes the changed bytes and
+ * EECONFIG_CHECKSUM, then sets EECONFIG_COMMIT to EECONFIG_COMMIT_DONE. On
+ * load:
+ * - a commit that was cut short, by a power loss or a reset, left every byte
+ *   with its old or its new value, so the values are kept and sealed again;
+ * - a sealed block that fails the checksum was corrupted or written around
+ *   the cache, so the settings go back to their defaults. Nothing is erased,
+ *   and EECONFIG_HANDEDNESS is kept;
+ * - the EECONFIG_MAGIC_NUMBER_V0 layout, identical up to EECONFIG_CHECKSUM,
+ *   is kept and sealed under the current magic number.
+ *
+ * With EFFECTS_THREAD_ENABLE the cache is also used from the effects thread.
+ * Every access to it is then a short critical section, and eeconfig_flush()
+ * writes a copy taken in one, so neither thread waits for the EEPROM.
+ */
+#define CHECKSUM_OFFSET ((uintptr_t)EECONFIG_CHECKSUM)
+#define COMMIT_OFFSET ((uintptr_t)EECONFIG_COMMIT)
+
+static uint8_t       cache[EECONFIG_SIZE];
+static bool          cache_loaded = false;
+static uint8_t       dirty[(EECONFIG_SIZE + 7) / 8];
+static bool          pending = false;
+static uint16_t      pending_timer;
+static volatile bool flush_requested = false;
+
+static uint8_t eeconfig_checksum(const uint8_t *data) {
+    // CRC-8, polynomial 0x07
+    uint8_t crc = 0;
+    for (uint8_t i = 0; i < CHECKSUM_OFFSET; i++) {
+        crc ^= data[i];
+        for (uint8_t bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x80) ? (crc << 1) ^ 0x07 : crc << 1;
+        }
+    }
+    return crc;
+}
+
+static void eeconfig_read_cache(void) {
+    eeprom_read_block(cache, (const void *)0, EECONFIG_SIZE);
+    memset(dirty, 0, sizeof(dirty));
+    cache_loaded = true;
+    pending      = false;
+}
+
+// Covers data with the checksum and closes the commit
+static void eeconfig_seal(const uint8_t *data) {
+    cache[CHECKSUM_OFFSET] = eeconfig_checksum(data);
+    eeprom_update_byte(EECONFIG_CHECKSUM, cache[CHECKSUM_OFFSET]);
+    cache[COMMIT_OFFSET] = EECONFIG_COMMIT_DONE;
+    eeprom_update_byte(EECONFIG_COMMIT, EECONFIG_COMMIT_DONE);
+}
+
+static void eeconfig_write_defaults(void);
+
+static void eeconfig_load(void) {
+    eeconfig_read_cache();
+
+    uint16_t magic;
+    memcpy(&magic, &cache[(uintptr_t)EECONFIG_MAGIC], sizeof(magic));
+    if (magic == EECONFIG_MAGIC_NUMBER) {
+        if (cache[COMMIT_OFFSET] != EECONFIG_COMMIT_DONE) {
+            dprintf("eeconfig: unfinished commit, keeping the values\n");
+            eeconfig_seal(cache);
+        } else if (cache[CHECKSUM_OFFSET] != eeconfig_checksum(cache)) {
+            dprintf("eeconfig: checksum mismatch, restoring defaults\n");
+            uint8_t handedness = cache[(uintptr_t)EECONFIG_HANDEDNESS];
+            eeconfig_write_defaults();
+            eeconfig_update_byte(EECONFIG_HANDEDNESS, handedness);
+            eeconfig_flush();
+        }
+    } else if (magic == EECONFIG_MAGIC_NUMBER_V0) {
+        dprintf("eeconfig: migrating the previous layout\n");
+        eeconfig_update_word(EECONFIG_MAGIC, EECONFIG_MAGIC_NUMBER);
+        eeconfig_flush();
+    }
+}
+
+static inline bool eeconfig_cached(const void *addr) { return (uintptr_t)addr < CHECKSUM_OFFSET; }
+
+static void eeconfig_cache_write(uint8_t offset, uint8_t val) {
+    if (!cache_loaded) {
+        eeconfig_load();
+    }
+    uint16_t now = timer_read();
+    EECONFIG_ATOMIC {
+        if (cache[offset] != val) {
+            cache[offset] = val;
+            dirty[offset / 8] |= 1 << (offset % 8);
+            pending = true;
+        }
+        if (pending) {
+            pending_timer = now;
+        }
+    }
+}
+
+/** \brief eeconfig flush
+ *
+ * Writes the pending changes, and the checksum after them, to the EEPROM.
+ */
+void eeconfig_flush(void) {
+    if (!pending) {
+        return;
+    }
+
+    // Changes made while the EEPROM is written are left for the next flush
+    uint8_t data[CHECKSUM_OFFSET];
+    uint8_t data_dirty[sizeof(dirty)];
+    EECONFIG_ATOMIC {
+        memcpy(data, cache, sizeof(data));
+        memcpy(data_dirty, dirty, sizeof(data_dirty));
+        memset(dirty, 0, sizeof(dirty));
+        pending = false;
+    }
+
+    // Until it is sealed again, a load knows the block may be half written
+    cache[COMMIT_OFFSET] = EECONFIG_COMMIT_OPEN;
+    eeprom_update_byte(EECONFIG_COMMIT, EECONFIG_COMMIT_OPEN);
+
+    uint8_t offset = 0;
+    while (offset < CHECKSUM_OFFSET) {
+        if (!(data_dirty[offset / 8] & (1 << (offset % 8)))) {
+            offset++;
+            continue;
+        }
+
+        // Contiguous dirty bytes go out as a single block
+        uint8_t end = offset;
+        while (end < CHECKSUM_OFFSET && (data_dirty[end / 8] & (1 << (end % 8)))) {
+            end++;
+        }
+        eeprom_update_block(&data[offset], (void *)(uintptr_t)offset, end - offset);
+        offset = end;
+    }
+
+    eeconfig_seal(data);
+}
+
+/** \brief eeconfig task
+ *
+ * Commits the pending changes once they have settled.
+ */
+void eeconfig_task(void) {
+    if (pending && (flush_requested || timer_elapsed(pending_timer) >= EECONFIG_COMMIT_DELAY)) {
+        eeconfig_flush();
+    }
+    flush_requested = false;
+}
+
+/** \brief eeconfig request flush
+ *
+ * Has the next eeconfig_task() commit the pending changes without waiting
+ * for them to settle. Safe to call from an interrupt, e.g. on USB disconnect.
+ */
+void eeconfig_request_flush(void) { flush_requested = true; }
+
+/** \brief eeconfig reload
+ *
+ * Drops the cache, and any pending changes, and reads the EEPROM again.
+ */
+void eeconfig_reload(void) { eeconfig_load(); }
+
+/** \brief eeconfig read block
+ *
+ * Reads len bytes at addr, from the cache as far as it covers them.
+ */
+void eeconfig_read_block(void *buf, const void *addr, size_t len) {
+    uint8_t * dst    = buf;
+    uintptr_t offset = (uintptr_t)addr;
+
+    if (offset < CHECKSUM_OFFSET) {
+        if (!cache_loaded) {
+            eeconfig_load();
+        }
+        size_t cached = CHECKSUM_OFFSET - offset < len ? CHECKSUM_OFFSET - offset : len;
+        EECONFIG_ATOMIC { memcpy(dst, &cache[offset], cached); }
+        dst += cached;
+        offset += cached;
+        len -= cached;
+    }
+    if (len) {
+        eeprom_read_block(dst, (const void *)offset, len);
+    }
+}
+
+/** \brief eeconfig update block
+ *
+ * Writes len bytes at addr, to the cache as far as it covers them.
+ */
+void eeconfig_update_block(const void *buf, void *addr, size_t len) {
+    const uint8_t *src    = buf;
+    uintptr_t      offset = (uintptr_t)addr;
+
+    for (; len && offset < CHECKSUM_OFFSET; len--) {
+        eeconfig_cache_write(offset++, *src++);
+    }
+    if (len) {
+        eeprom_update_block(src, (void *)offset, len);
+    }
+}
+
+/* Typed versions of eeconfig_read_block() and eeconfig_update_block() */
+uint8_t eeconfig_read_byte(const uint8_t *addr) {
+    if (!eeconfig_cached(addr)) {
+        return eeprom_read_byte(addr);
+    }
+    uint8_t val;
+    eeconfig_read_block(&val, addr, sizeof(val));
+    return val;
+}
+
+uint16_t eeconfig_read_word(const uint16_t *addr) {
+    if (!eeconfig_cached(addr)) {
+        return eeprom_read_word(addr);
+    }
+    uint16_t val;
+    eeconfig_read_block(&val, addr, sizeof(val));
+    return val;
+}
+
+uint32_t eeconfig_read_dword(const uint32_t *addr) {
+    if (!eeconfig_cached(addr)) {
+        return eeprom_read_dword(addr);
+    }
+    uint32_t val;
+    eeconfig_read_block(&val, addr, sizeof(val));
+    return val;
+}
+
+void eeconfig_update_byte(uint8_t *addr, uint8_t val) {
+    if (!eeconfig_cached(addr)) {
+        eeprom_update_byte(addr, val);
+        return;
+    }
+    eeconfig_update_block(&val, addr, sizeof(val));
+}
+
+void eeconfig_update_word(uint16_t *addr, uint16_t val) {
+    if (!eeconfig_cached(addr)) {
+        eeprom_update_word(addr, val);
+        return;
+    }
+    eeconfig_update_block(&val, addr, sizeof(val));
+}
+
+void eeconfig_update_dword(uint32_t *addr, uint32_t val) {
+    if (!eeconfig_cached(addr)) {
+        eeprom_update_dword(addr, val);
+        return;
+    }
+    eeconfig_update_block(&val, addr, sizeof(val));
+}
+
 /** \brief eeconfig enable
  *
  * FIXME: needs doc
@@ -33,40 +304,32 @@ __attribute__((weak)) void eeconfig_init_kb(void) {
     eeconfig_init_user();
 }
 
-/*
- * FIXME: needs doc
- */
-void eeconfig_init_quantum(void) {
-#ifdef STM32_EEPROM_ENABLE
-    EEPROM_Erase();
-#endif
-#if defined(EEPROM_DRIVER)
-    eeprom_driver_erase();
-#endif
-    eeprom_update_word(EECONFIG_MAGIC, EECONFIG_MAGIC_NUMBER);
-    eeprom_update_byte(EECONFIG_DEBUG, 0);
-    eeprom_update_byte(EECONFIG_DEFAULT_LAYER, 0);
+/* Writes the default settings over the cached block, and commits them */
+static void eeconfig_write_defaults(void) {
+    eeconfig_update_word(EECONFIG_MAGIC, EECONFIG_MAGIC_NUMBER);
+    eeconfig_update_byte(EECONFIG_DEBUG, 0);
+    eeconfig_update_byte(EECONFIG_DEFAULT_LAYER, 0);
     default_layer_state = 0;
-    eeprom_update_byte(EECONFIG_KEYMAP_LOWER_BYTE, 0);
-    eeprom_update_byte(EECONFIG_KEYMAP_UPPER_BYTE, 0);
-    eeprom_update_byte(EECONFIG_MOUSEKEY_ACCEL, 0);
-    eeprom_update_byte(EECONFIG_BACKLIGHT, 0);
-    eeprom_update_byte(EECONFIG_AUDIO, 0xFF);  // On by default
-    eeprom_update_dword(EECONFIG_RGBLIGHT, 0);
-    eeprom_update_byte(EECONFIG_STENOMODE, 0);
-    eeprom_update_dword(EECONFIG_HAPTIC, 0);
-    eeprom_update_byte(EECONFIG_VELOCIKEY, 0);
-    eeprom_update_dword(EECONFIG_RGB_MATRIX, 0);
-    eeprom_update_byte(EECONFIG_RGB_MATRIX_SPEED, 0);
+    eeconfig_update_byte(EECONFIG_KEYMAP_LOWER_BYTE, 0);
+    eeconfig_update_byte(EECONFIG_KEYMAP_UPPER_BYTE, 0);
+    eeconfig_update_byte(EECONFIG_MOUSEKEY_ACCEL, 0);
+    eeconfig_update_byte(EECONFIG_BACKLIGHT, 0);
+    eeconfig_update_byte(EECONFIG_AUDIO, 0xFF);  // On by default
+    eeconfig_update_dword(EECONFIG_RGBLIGHT, 0);
+    eeconfig_update_byte(EECONFIG_STENOMODE, 0);
+    eeconfig_update_dword(EECONFIG_HAPTIC, 0);
+    eeconfig_update_byte(EECONFIG_VELOCIKEY, 0);
+    eeconfig_update_dword(EECONFIG_RGB_MATRIX, 0);
+    eeconfig_update_byte(EECONFIG_RGB_MATRIX_SPEED, 0);
 
     // TODO: Remove once ARM has a way to configure EECONFIG_HANDEDNESS
     //        within the emulated eeprom via dfu-util or another tool
 #if defined INIT_EE_HANDS_LEFT
 #    pragma message "Faking EE_HANDS for left hand"
-    eeprom_update_byte(EECONFIG_HANDEDNESS, 1);
+    eeconfig_update_byte(EECONFIG_HANDEDNESS, 1);
 #elif defined INIT_EE_HANDS_RIGHT
 #    pragma message "Faking EE_HANDS for right hand"
-    eeprom_update_byte(EECONFIG_HANDEDNESS, 0);
+    eeconfig_update_byte(EECONFIG_HANDEDNESS, 0);
 #endif
 
 #if defined(HAPTIC_ENABLE)
@@ -75,10 +338,30 @@ void eeconfig_init_quantum(void) {
     // this is used in case haptic is disabled, but we still want sane defaults
     // in the haptic configuration eeprom. All zero will trigger a haptic_reset
     // when a haptic-enabled firmware is loaded onto the keyboard.
-    eeprom_update_dword(EECONFIG_HAPTIC, 0);
+    eeconfig_update_dword(EECONFIG_HAPTIC, 0);
 #endif
 
+    eeconfig_flush();
     eeconfig_init_kb();
+    eeconfig_flush();
+    // Pick up anything eeconfig_init_kb() wrote without going through the cache,
+    // and cover it with the checksum
+    eeconfig_read_cache();
+    eeconfig_seal(cache);
+}
+
+/*
+ * FIXME: needs doc
+ */
+void eeconfig_init_quantum(void) {
+#ifdef STM32_EEPROM_ENABLE
+    EEPROM_Erase();
+#endif
+#if defined(EEPROM_DRIVER)
+    eeprom_driver_erase();
+#endif
+    eeconfig_read_cache();
+    eeconfig_write_defaults();
 }
 
 /** \brief eeconfig initialization
@@ -91,7 +374,10 @@ void eeconfig_init(void) { eeconfig_init_quantum(); }
  *
  * FIXME: needs doc
  */
-void eeconfig_enable(void) { eeprom_update_word(EECONFIG_MAGIC, EECONFIG_MAGIC_NUMBER); }
+void eeconfig_enable(void) {
+    eeconfig_update_word(EECONFIG_MAGIC, EECONFIG_MAGIC_NUMBER);
+    eeconfig_flush();
+}
 
 /** \brief eeconfig disable
  *
@@ -105,118 +391,130 @@ void eeconfig_disable(void) {
     eeprom_driver_erase();
 #endif
     eeprom_update_word(EECONFIG_MAGIC, EECONFIG_MAGIC_NUMBER_OFF);
+    eeconfig_read_cache();
 }
 
 /** \brief eeconfig is enabled
  *
  * FIXME: needs doc
  */
-bool eeconfig_is_enabled(void) { return (eeprom_read_word(EECONFIG_MAGIC) == EECONFIG_MAGIC_NUMBER); }
+bool eeconfig_is_enabled(void) { return (eeconfig_read_word(EECONFIG_MAGIC) == EECONFIG_MAGIC_NUMBER); }
 
 /** \brief eeconfig is disabled
  *
  * FIXME: needs doc
  */
-bool eeconfig_is_disabled(void) { return (eeprom_read_word(EECONFIG_MAGIC) == EECONFIG_MAGIC_NUMBER_OFF); }
+bool eeconfig_is_disabled(void) { return (eeconfig_read_word(EECONFIG_MAGIC) == EECONFIG_MAGIC_NUMBER_OFF); }
 
 /** \brief eeconfig read debug
  *
  * FIXME: needs doc
  */
-uint8_t eeconfig_read_debug(void) { return eeprom_read_byte(EECONFIG_DEBUG); }
+uint8_t eeconfig_read_debug(void) { return eeconfig_read_byte(EECONFIG_DEBUG); }
 /** \brief eeconfig update debug
  *
  * FIXME: needs doc
  */
-void eeconfig_update_debug(uint8_t val) { eeprom_update_byte(EECONFIG_DEBUG, val); }
+void eeconfig_update_debug(uint8_t val) { eeconfig_update_byte(EECONFIG_DEBUG, val); }
 
 /** \brief eeconfig read default layer
  *
  * FIXME: needs doc
  */
-uint8_t eeconfig_read_default_layer(void) { return eeprom_read_byte(EECONFIG_DEFAULT_LAYER); }
+uint8_t eeconfig_read_default_layer(void) { return eeconfig_read_byte(EECONFIG_DEFAULT_LAYER); }
 /** \brief eeconfig update default layer
  *
  * FIXME: needs doc
  */
-void eeconfig_update_default_layer(uint8_t val) { eeprom_update_byte(EECONFIG_DEFAULT_LAYER, val); }
+void eeconfig_update_default_layer(uint8_t val) { eeconfig_update_byte(EECONFIG_DEFAULT_LAYER, val); }
 
 /** \brief eeconfig read keymap
  *
  * FIXME: needs doc
  */
-uint16_t eeconfig_read_keymap(void) { return (eeprom_read_byte(EECONFIG_KEYMAP_LOWER_BYTE) | (eeprom_read_byte(EECONFIG_KEYMAP_UPPER_BYTE) << 8)); }
+uint16_t eeconfig_read_keymap(void) { return (eeconfig_read_byte(EECONFIG_KEYMAP_LOWER_BYTE) | (eeconfig_read_byte(EECONFIG_KEYMAP_UPPER_BYTE) << 8)); }
 /** \brief eeconfig update keymap
  *
  * FIXME: needs doc
  */
 void eeconfig_update_keymap(uint16_t val) {
-    eeprom_update_byte(EECONFIG_KEYMAP_LOWER_BYTE, val & 0xFF);
-    eeprom_update_byte(EECONFIG_KEYMAP_UPPER_BYTE, (val >> 8) & 0xFF);
+    eeconfig_update_byte(EECONFIG_KEYMAP_LOWER_BYTE, val & 0xFF);
+    eeconfig_update_byte(EECONFIG_KEYMAP_UPPER_BYTE, (val >> 8) & 0xFF);
 }
 
 /** \brief eeconfig read backlight
  *
  * FIXME: needs doc
  */
-uint8_t eeconfig_read_backlight(void) { return eeprom_read_byte(EECONFIG_BACKLIGHT); }
+uint8_t eeconfig_read_backlight(void) { return eeconfig_read_byte(EECONFIG_BACKLIGHT); }
 /** \brief eeconfig update backlight
  *
  * FIXME: needs doc
  */
-void eeconfig_update_backlight(uint8_t val) { eeprom_update_byte(EECONFIG_BACKLIGHT, val); }
+void eeconfig_update_backlight(uint8_t val) { eeconfig_update_byte(EECONFIG_BACKLIGHT, val); }
 
 /** \brief eeconfig read audio
  *
  * FIXME: needs doc
  */
-uint8_t eeconfig_read_audio(void) { return eeprom_read_byte(EECONFIG_AUDIO); }
+uint8_t eeconfig_read_audio(void) { return eeconfig_read_byte(EECONFIG_AUDIO); }
 /** \brief eeconfig update audio
  *
  * FIXME: needs doc
  */
-void eeconfig_update_audio(uint8_t val) { eeprom_update_byte(EECONFIG_AUDIO, val); }
+void eeconfig_update_audio(uint8_t val) { eeconfig_update_byte(EECONFIG_AUDIO, val); }
+
+/** \brief eeconfig read mousekey
+ *
+ * Index of the selected kinetic mouse keys curve
+ */
+uint8_t eeconfig_read_mousekey(void) { return eeconfig_read_byte(EECONFIG_MOUSEKEY_ACCEL); }
+/** \brief eeconfig update mousekey
+ *
+ * Index of the selected kinetic mouse keys curve
+ */
+void eeconfig_update_mousekey(uint8_t val) { eeconfig_update_byte(EECONFIG_MOUSEKEY_ACCEL, val); }
 
 /** \brief eeconfig read kb
  *
  * FIXME: needs doc
  */
-uint32_t eeconfig_read_kb(void) { return eeprom_read_dword(EECONFIG_KEYBOARD); }
+uint32_t eeconfig_read_kb(void) { return eeconfig_read_dword(EECONFIG_KEYBOARD); }
 /** \brief eeconfig update kb
  *
  * FIXME: needs doc
  */
-void eeconfig_update_kb(uint32_t val) { eeprom_update_dword(EECONFIG_KEYBOARD, val); }
+void eeconfig_update_kb(uint32_t val) { eeconfig_update_dword(EECONFIG_KEYBOARD, val); }
 
 /** \brief eeconfig read user
  *
  * FIXME: needs doc
  */
-uint32_t eeconfig_read_user(void) { return eeprom_read_dword(EECONFIG_USER); }
+uint32_t eeconfig_read_user(void) { return eeconfig_read_dword(EECONFIG_USER); }
 /** \brief eeconfig update user
  *
  * FIXME: needs doc
  */
-void eeconfig_update_user(uint32_t val) { eeprom_update_dword(EECONFIG_USER, val); }
+void eeconfig_update_user(uint32_t val) { eeconfig_update_dword(EECONFIG_USER, val); }
 
 /** \brief eeconfig read haptic
  *
  * FIXME: needs doc
  */
-uint32_t eeconfig_read_haptic(void) { return eeprom_read_dword(EECONFIG_HAPTIC); }
+uint32_t eeconfig_read_haptic(void) { return eeconfig_read_dword(EECONFIG_HAPTIC); }
 /** \brief eeconfig update haptic
  *
  * FIXME: needs doc
  */
-void eeconfig_update_haptic(uint32_t val) { eeprom_update_dword(EECONFIG_HAPTIC, val); }
+void eeconfig_update_haptic(uint32_t val) { eeconfig_update_dword(EECONFIG_HAPTIC, val); }
 
 /** \brief eeconfig read split handedness
  *
  * FIXME: needs doc
  */
-bool eeconfig_read_handedness(void) { return !!eeprom_read_byte(EECONFIG_HANDEDNESS); }
+bool eeconfig_read_handedness(void) { return !!eeconfig_read_byte(EECONFIG_HANDEDNESS); }
 /** \brief eeconfig update split handedness
  *
  * FIXME: needs doc
  */
-void eeconfig_update_handedness(bool val) { eeprom_update_byte(EECONFIG_HANDEDNESS, !!val); }
+void eeconfig_update_handedness(bool val) { eeconfig_update_byte(EECONFIG_HANDEDNESS, !!val); }
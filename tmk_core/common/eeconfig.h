@@ -19,10 +19,14 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include <stdint.h>
 #include <stdbool.h>
+#include <stddef.h>
 
+/* The magic number also versions the layout, it changes whenever the layout does */
 #ifndef EECONFIG_MAGIC_NUMBER
-#    define EECONFIG_MAGIC_NUMBER (uint16_t)0xFEEC
+#    define EECONFIG_MAGIC_NUMBER (uint16_t)0xFEEB
 #endif
+// The 34 byte layout without checksum and commit marker, migrated on load
+#define EECONFIG_MAGIC_NUMBER_V0 (uint16_t)0xFEEC
 #define EECONFIG_MAGIC_NUMBER_OFF (uint16_t)0xFFFF
 
 /* EEPROM parameter address */
@@ -47,8 +51,12 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #define EECONFIG_RGB_MATRIX_SPEED (uint8_t *)32
 // TODO: Combine these into a single word and single block of EEPROM
 #define EECONFIG_KEYMAP_UPPER_BYTE (uint8_t *)33
+// Checksum of the bytes above, written by eeconfig_flush() after them
+#define EECONFIG_CHECKSUM (uint8_t *)34
+// EECONFIG_COMMIT_DONE once the checksum covers the bytes above, cleared while eeconfig_flush() writes them
+#define EECONFIG_COMMIT (uint8_t *)35
 // Size of EEPROM being used, other code can refer to this for available EEPROM
-#define EECONFIG_SIZE 34
+#define EECONFIG_SIZE 36
 /* debug bit */
 #define EECONFIG_DEBUG_ENABLE (1 << 0)
 #define EECONFIG_DEBUG_MATRIX (1 << 1)
@@ -67,6 +75,16 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #define EECONFIG_KEYMAP_LOWER_BYTE EECONFIG_KEYMAP
 
+/* commit marker */
+#define EECONFIG_COMMIT_OPEN 0x00
+#define EECONFIG_COMMIT_DONE 0xC0
+
+/* Time in ms the cached configuration is kept dirty after the last change
+ * before it is written to EEPROM */
+#ifndef EECONFIG_COMMIT_DELAY
+#    define EECONFIG_COMMIT_DELAY 1000
+#endif
+
 bool eeconfig_is_enabled(void);
 bool eeconfig_is_disabled(void);
 
@@ -79,6 +97,23 @@ void eeconfig_enable(void);
 
 void eeconfig_disable(void);
 
+/* Cached access to the EECONFIG_* addresses. Changes are kept in RAM until
+ * EECONFIG_COMMIT_DELAY ms after the last one, or until eeconfig_flush().
+ * Addresses past EECONFIG_SIZE go straight to the EEPROM. */
+uint8_t  eeconfig_read_byte(const uint8_t *addr);
+uint16_t eeconfig_read_word(const uint16_t *addr);
+uint32_t eeconfig_read_dword(const uint32_t *addr);
+void     eeconfig_read_block(void *buf, const void *addr, size_t len);
+void     eeconfig_update_byte(uint8_t *addr, uint8_t val);
+void     eeconfig_update_word(uint16_t *addr, uint16_t val);
+void     eeconfig_update_dword(uint32_t *addr, uint32_t val);
+void     eeconfig_update_block(const void *buf, void *addr, size_t len);
+
+void eeconfig_task(void);
+void eeconfig_flush(void);
+void eeconfig_request_flush(void);
+void eeconfig_reload(void);
+
 uint8_t eeconfig_read_debug(void);
 void    eeconfig_update_debug(uint8_t val);
 
@@ -98,6 +133,11 @@ uint8_t eeconfig_read_audio(void);
 void    eeconfig_update_audio(uint8_t val);
 #endif
 
+#ifdef MOUSEKEY_ENABLE
+uint8_t eeconfig_read_mousekey(void);
+void    eeconfig_update_mousekey(uint8_t val);
+#endif
+
 uint32_t eeconfig_read_kb(void);
 void     eeconfig_update_kb(uint32_t val);
 uint32_t eeconfig_read_user(void);
@@ -23,6 +23,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "led.h"
 #include "keycode.h"
 #include "timer.h"
+#include "deadline.h"
 #include "print.h"
 #include "debug.h"
 #include "command.h"
@@ -41,6 +42,9 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #ifdef MOUSEKEY_ENABLE
 #    include "mousekey.h"
 #endif
+#ifdef MOUSE_ENABLE
+#    include "pointer.h"
+#endif
 #ifdef PS2_MOUSE_ENABLE
 #    include "ps2_mouse.h"
 #endif
@@ -95,6 +99,9 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #ifdef DIP_SWITCH_ENABLE
 #    include "dip_switch.h"
 #endif
+#ifdef TASK_SCHEDULER_ENABLE
+#    include "task_scheduler.h"
+#endif
 
 // Only enable this if console is enabled to print to
 #if defined(DEBUG_MATRIX_SCAN_RATE)
@@ -121,6 +128,22 @@ uint32_t get_matrix_scan_rate(void) { return last_matrix_scan_count; }
 #    define matrix_scan_perf_task()
 #endif
 
+#ifdef MATRIX_THREAD_SCAN
+#    ifdef MATRIX_HAS_GHOST
+#        error "MATRIX_HAS_GHOST is not supported with MATRIX_THREAD_SCAN"
+#    endif
+
+/* Report key events the scan thread could not queue */
+static void matrix_thread_drop_task(void) {
+    static uint16_t last_dropped = 0;
+    uint16_t        dropped      = matrix_events_dropped();
+    if (dropped != last_dropped) {
+        dprintf("matrix: event queue overflow, %u total\n", dropped);
+        last_dropped = dropped;
+    }
+}
+#endif
+
 #ifdef MATRIX_HAS_GHOST
 extern const uint16_t keymaps[][MATRIX_ROWS][MATRIX_COLS];
 static matrix_row_t   get_real_keys(uint8_t row, matrix_row_t rowdata) {
@@ -254,6 +277,127 @@ __attribute__((weak)) void housekeeping_task_kb(void) {}
  */
 __attribute__((weak)) void housekeeping_task_user(void) {}
 
+#ifdef VISUALIZER_ENABLE
+static void visualizer_task(void) { visualizer_update(default_layer_state, layer_state, visualizer_get_mods(), host_keyboard_leds()); }
+#endif
+
+#ifdef VELOCIKEY_ENABLE
+static void velocikey_task(void) {
+    if (velocikey_enabled()) {
+        velocikey_decelerate();
+    }
+}
+#endif
+
+/** \brief effects_task_quantum
+ *
+ * Lighting work owned by quantum (RGB/LED matrix), when it runs on the effects thread.
+ */
+__attribute__((weak)) void effects_task_quantum(void) {}
+
+/** \brief keyboard_effects_task
+ *
+ * Lighting and display work. Runs from keyboard_task(), or from the effects
+ * thread when EFFECTS_THREAD_ENABLE is set.
+ */
+void keyboard_effects_task(void) {
+#if defined(RGBLIGHT_ENABLE)
+    rgblight_task();
+#endif
+
+#if defined(BACKLIGHT_ENABLE)
+#    if defined(BACKLIGHT_PIN) || defined(BACKLIGHT_PINS)
+    backlight_task();
+#    endif
+#endif
+
+#ifdef OLED_DRIVER_ENABLE
+    oled_task();
+#endif
+
+#ifdef VISUALIZER_ENABLE
+    visualizer_task();
+#endif
+
+    effects_task_quantum();
+}
+
+#ifdef TASK_SCHEDULER_ENABLE
+#    ifndef RGBLIGHT_TASK_PERIOD
+#        define RGBLIGHT_TASK_PERIOD 0
+#    endif
+#    ifndef BACKLIGHT_TASK_PERIOD
+#        define BACKLIGHT_TASK_PERIOD 0
+#    endif
+#    ifndef OLED_TASK_PERIOD
+#        define OLED_TASK_PERIOD 0
+#    endif
+#    ifndef VISUALIZER_TASK_PERIOD
+#        define VISUALIZER_TASK_PERIOD 0
+#    endif
+
+/** \brief keyboard_register_tasks
+ *
+ * Registers the builtin periodic work with the task scheduler. Pointer and encoder
+ * input is high priority so it is never deferred; lighting and displays can be.
+ */
+static void keyboard_register_tasks(void) {
+#    ifdef ENCODER_ENABLE
+    task_scheduler_register(encoder_read, "encoder", 0, TASK_PRIORITY_HIGH, 1);
+#    endif
+#    ifdef MOUSEKEY_ENABLE
+    task_scheduler_register(mousekey_task, "mousekey", 0, TASK_PRIORITY_HIGH, 1);
+#    endif
+#    ifdef PS2_MOUSE_ENABLE
+    task_scheduler_register(ps2_mouse_task, "ps2_mouse", 0, TASK_PRIORITY_HIGH, 1);
+#    endif
+#    ifdef SERIAL_MOUSE_ENABLE
+    task_scheduler_register(serial_mouse_task, "serial_mouse", 0, TASK_PRIORITY_HIGH, 1);
+#    endif
+#    ifdef ADB_MOUSE_ENABLE
+    task_scheduler_register(adb_mouse_task, "adb_mouse", 0, TASK_PRIORITY_HIGH, 1);
+#    endif
+#    ifdef POINTING_DEVICE_ENABLE
+    task_scheduler_register(pointing_device_task, "pointing", 0, TASK_PRIORITY_HIGH, 1);
+#    endif
+#    ifdef MOUSE_ENABLE
+    // after all mouse sources, it sends what they reported
+    task_scheduler_register(pointer_task, "pointer", 0, TASK_PRIORITY_HIGH, 1);
+#    endif
+#    ifdef JOYSTICK_ENABLE
+    task_scheduler_register(joystick_task, "joystick", 0, TASK_PRIORITY_HIGH, 1);
+#    endif
+#    ifdef SERIAL_LINK_ENABLE
+    task_scheduler_register(serial_link_update, "serial_link", 0, TASK_PRIORITY_NORMAL, 1);
+#    endif
+#    ifdef MIDI_ENABLE
+    task_scheduler_register(midi_task, "midi", 0, TASK_PRIORITY_NORMAL, 1);
+#    endif
+#    ifdef QWIIC_ENABLE
+    task_scheduler_register(qwiic_task, "qwiic", 0, TASK_PRIORITY_NORMAL, 1);
+#    endif
+#    ifdef VELOCIKEY_ENABLE
+    task_scheduler_register(velocikey_task, "velocikey", 0, TASK_PRIORITY_NORMAL, 1);
+#    endif
+#    ifndef EFFECTS_THREAD_ENABLE
+    // with the effects thread these run on the worker instead
+#        if defined(BACKLIGHT_ENABLE) && (defined(BACKLIGHT_PIN) || defined(BACKLIGHT_PINS))
+    task_scheduler_register(backlight_task, "backlight", BACKLIGHT_TASK_PERIOD, TASK_PRIORITY_LOW, 1);
+#        endif
+#        ifdef RGBLIGHT_ENABLE
+    task_scheduler_register(rgblight_task, "rgblight", RGBLIGHT_TASK_PERIOD, TASK_PRIORITY_LOW, 1);
+#        endif
+#        ifdef VISUALIZER_ENABLE
+    task_scheduler_register(visualizer_task, "visualizer", VISUALIZER_TASK_PERIOD, TASK_PRIORITY_LOW, 1);
+#        endif
+#        ifdef OLED_DRIVER_ENABLE
+    task_scheduler_register(oled_task, "oled", OLED_TASK_PERIOD, TASK_PRIORITY_LOW, 2);
+#        endif
+#    endif
+    task_scheduler_register(eeconfig_task, "eeconfig", 0, TASK_PRIORITY_LOW, 1);
+}
+#endif
+
 /** \brief keyboard_init
  *
  * FIXME: needs doc
@@ -299,6 +443,9 @@ void keyboard_init(void) {
 #ifdef FAUXCLICKY_ENABLE
     fauxclicky_init();
 #endif
+#if defined(MOUSEKEY_ENABLE) && defined(MK_KINETIC_SPEED)
+    mousekey_init();
+#endif
 #ifdef POINTING_DEVICE_ENABLE
     pointing_device_init();
 #endif
@@ -313,6 +460,9 @@ void keyboard_init(void) {
 #if defined(DEBUG_MATRIX_SCAN_RATE) && defined(CONSOLE_ENABLE)
     debug_enable = true;
 #endif
+#ifdef TASK_SCHEDULER_ENABLE
+    keyboard_register_tasks();
+#endif
 
     keyboard_post_init_kb(); /* Always keep this last */
 }
@@ -330,10 +480,12 @@ void keyboard_init(void) {
  * This is repeatedly called as fast as possible.
  */
 void keyboard_task(void) {
+#ifndef MATRIX_THREAD_SCAN
     static matrix_row_t matrix_prev[MATRIX_ROWS];
-    static uint8_t      led_status    = 0;
     matrix_row_t        matrix_row    = 0;
     matrix_row_t        matrix_change = 0;
+#endif
+    static uint8_t led_status = 0;
 #ifdef QMK_KEYS_PER_SCAN
     uint8_t keys_processed = 0;
 #endif
@@ -347,16 +499,35 @@ void keyboard_task(void) {
     matrix_scan();
 #endif
 
+    // Timeouts expire before the keys of this scan are processed, as they did
+    // when every feature polled its own timer from matrix_scan_quantum()
+    deadline_task();
+
+#ifdef MATRIX_THREAD_SCAN
+    // key events were queued by the scan thread, with the time they were seen
+    keyevent_t event;
+    if (should_process_keypress()) {
+        while (matrix_event_pop(&event)) {
+            action_exec(event);
+#    ifdef QMK_KEYS_PER_SCAN
+            // only jump out if we have processed "enough" keys.
+            if (++keys_processed >= QMK_KEYS_PER_SCAN)
+#    endif
+                // process a key per task call
+                goto MATRIX_LOOP_END;
+        }
+    }
+#else
     if (should_process_keypress()) {
         for (uint8_t r = 0; r < MATRIX_ROWS; r++) {
             matrix_row    = matrix_get_row(r);
             matrix_change = matrix_row ^ matrix_prev[r];
             if (matrix_change) {
-#ifdef MATRIX_HAS_GHOST
+#    ifdef MATRIX_HAS_GHOST
                 if (has_ghost_in_row(r, matrix_row)) {
                     continue;
                 }
-#endif
+#    endif
                 if (debug_matrix) matrix_print();
                 matrix_row_t col_mask = 1;
                 for (uint8_t c = 0; c < MATRIX_COLS; c++, col_mask <<= 1) {
@@ -366,10 +537,10 @@ void keyboard_task(void) {
                         });
                         // record a processed key
                         matrix_prev[r] ^= col_mask;
-#ifdef QMK_KEYS_PER_SCAN
+#    ifdef QMK_KEYS_PER_SCAN
                         // only jump out if we have processed "enough" keys.
                         if (++keys_processed >= QMK_KEYS_PER_SCAN)
-#endif
+#    endif
                             // process a key per task call
                             goto MATRIX_LOOP_END;
                     }
@@ -377,6 +548,7 @@ void keyboard_task(void) {
             }
         }
     }
+#endif
     // call with pseudo tick event when no real key event.
 #ifdef QMK_KEYS_PER_SCAN
     // we can get here with some keys processed now.
@@ -390,14 +562,21 @@ MATRIX_LOOP_END:
     matrix_scan_perf_task();
 #endif
 
-#if defined(RGBLIGHT_ENABLE)
-    rgblight_task();
+#ifdef MATRIX_THREAD_SCAN
+    matrix_thread_drop_task();
 #endif
 
-#if defined(BACKLIGHT_ENABLE)
-#    if defined(BACKLIGHT_PIN) || defined(BACKLIGHT_PINS)
-    backlight_task();
-#    endif
+#if defined(OLED_DRIVER_ENABLE) && !defined(OLED_DISABLE_TIMEOUT)
+    // Wake up oled if user is using those fabulous keys!
+    if (ret) oled_on();
+#endif
+
+#ifdef TASK_SCHEDULER_ENABLE
+    task_scheduler_run();
+#else
+
+#ifndef EFFECTS_THREAD_ENABLE
+    keyboard_effects_task();
 #endif
 
 #ifdef ENCODER_ENABLE
@@ -408,14 +587,6 @@ MATRIX_LOOP_END:
     qwiic_task();
 #endif
 
-#ifdef OLED_DRIVER_ENABLE
-    oled_task();
-#    ifndef OLED_DISABLE_TIMEOUT
-    // Wake up oled if user is using those fabulous keys!
-    if (ret) oled_on();
-#    endif
-#endif
-
 #ifdef MOUSEKEY_ENABLE
     // mousekey repeat & acceleration
     mousekey_task();
@@ -437,28 +608,30 @@ MATRIX_LOOP_END:
     serial_link_update();
 #endif
 
-#ifdef VISUALIZER_ENABLE
-    visualizer_update(default_layer_state, layer_state, visualizer_get_mods(), host_keyboard_leds());
-#endif
-
 #ifdef POINTING_DEVICE_ENABLE
     pointing_device_task();
 #endif
 
+#ifdef MOUSE_ENABLE
+    // send what the mouse sources above reported
+    pointer_task();
+#endif
+
 #ifdef MIDI_ENABLE
     midi_task();
 #endif
 
 #ifdef VELOCIKEY_ENABLE
-    if (velocikey_enabled()) {
-        velocikey_decelerate();
-    }
+    velocikey_task();
 #endif
 
 #ifdef JOYSTICK_ENABLE
     joystick_task();
 #endif
 
+    eeconfig_task();
+#endif  // TASK_SCHEDULER_ENABLE
+
     // update LED
     if (led_status != host_keyboard_leds()) {
         led_status = host_keyboard_leds();
@@ -73,6 +73,10 @@ void keyboard_post_init_user(void);
 void housekeeping_task_kb(void);
 void housekeeping_task_user(void);
 
+/* it runs lighting and display tasks, on the effects thread if enabled */
+void keyboard_effects_task(void);
+void effects_task_quantum(void);
+
 uint32_t get_matrix_scan_rate(void);
 
 #ifdef __cplusplus
@@ -22,6 +22,10 @@
 #include "print.h"
 #include "debug.h"
 #include "mousekey.h"
+#include "pointer.h"
+#ifdef MK_KINETIC_SPEED
+#    include "eeconfig.h"
+#endif
 
 inline int8_t times_inv_sqrt2(int8_t x) {
     // 181/256 is pretty close to 1/sqrt(2)
@@ -37,7 +41,222 @@ static uint8_t        mousekey_accel        = 0;
 static uint8_t        mousekey_repeat       = 0;
 static uint8_t        mousekey_wheel_repeat = 0;
 
-#ifndef MK_3_SPEED
+#if defined(MK_KINETIC_SPEED)
+
+/*
+ * Kinetic mouse keys
+ *
+ * Pressing a key moves by MOUSEKEY_MOVE_DELTA (MOUSEKEY_WHEEL_DELTA) right
+ * away. Once the key has been held for MOUSEKEY_DELAY (MOUSEKEY_WHEEL_DELAY),
+ * the cursor starts to move at the initial speed of the selected curve and
+ * speeds up linearly to its maximum. Speed and distance are integrated every
+ * scan over the time that actually passed, so motion does not depend on the
+ * scan rate, and the fractions are handed to the pointer pipeline, which sends
+ * them at the USB polling rate.
+ */
+
+static const mousekey_curve_t mousekey_curves[]    = MOUSEKEY_CURVES;
+static const mousekey_curve_t mousekey_wheel_curve = MOUSEKEY_WHEEL_CURVE;
+
+#    define MOUSEKEY_CURVE_COUNT (sizeof(mousekey_curves) / sizeof(mousekey_curves[0]))
+
+typedef struct {
+    int8_t   dir[2];      // held direction on each axis, -1, 0 or 1
+    uint16_t held;        // ms since the first key of this group was pressed
+    uint16_t last_frame;  // time of the last integration
+    uint32_t speed;       // counts per second, in 1/256 counts
+    uint16_t remainder;   // distance left over from the last frame, in 1/512000 counts
+} mousekey_motion_t;
+
+static mousekey_motion_t mousekey_cursor;
+static mousekey_motion_t mousekey_wheel;
+static uint8_t           mousekey_curve = 0;
+
+void mousekey_init(void) {
+    mousekey_curve = eeconfig_read_mousekey();
+    if (mousekey_curve >= MOUSEKEY_CURVE_COUNT) {
+        mousekey_curve = 0;
+    }
+}
+
+uint8_t mousekey_get_curve(void) { return mousekey_curve; }
+
+void mousekey_set_curve(uint8_t curve) {
+    if (curve >= MOUSEKEY_CURVE_COUNT) {
+        return;
+    }
+    mousekey_curve = curve;
+    eeconfig_update_mousekey(curve);
+}
+
+static void mousekey_motion_start(mousekey_motion_t *motion, const mousekey_curve_t *curve) {
+    if (motion->dir[0] || motion->dir[1]) {
+        return;
+    }
+    motion->held       = 0;
+    motion->last_frame = timer_read();
+    motion->speed      = (uint32_t)curve->initial_speed << 8;
+    motion->remainder  = 0;
+}
+
+/* Advances a group of keys to now and returns the distance it moved along
+ * each held axis, in 1/256 counts */
+static uint32_t mousekey_motion_frame(mousekey_motion_t *motion, const mousekey_curve_t *curve, uint16_t delay) {
+    uint16_t now       = timer_read();
+    uint16_t elapsed   = TIMER_DIFF_16(now, motion->last_frame);
+    motion->last_frame = now;
+
+    if (!motion->dir[0] && !motion->dir[1]) {
+        return 0;
+    }
+
+    uint16_t held = motion->held;
+    motion->held  = (UINT16_MAX - held < elapsed) ? UINT16_MAX : held + elapsed;
+    if (motion->held <= delay) {
+        return 0;
+    }
+    // Only the part of the frame after the delay moves
+    uint16_t dt = (held < delay) ? motion->held - delay : elapsed;
+    if (dt > MOUSEKEY_FRAME_MAX) {
+        dt = MOUSEKEY_FRAME_MAX;
+    }
+
+    uint32_t max_speed = (uint32_t)curve->max_speed << 8;
+    uint32_t v0        = motion->speed;
+    uint32_t v1;
+    if (mousekey_accel & (1 << 0)) {
+        v1 = max_speed / 4;
+    } else if (mousekey_accel & (1 << 1)) {
+        v1 = max_speed / 2;
+    } else if (mousekey_accel & (1 << 2)) {
+        v1 = max_speed;
+    } else if (v0 >= max_speed || curve->time_to_max == 0) {
+        v1 = max_speed;
+    } else {
+        v1 = v0 + ((max_speed - ((uint32_t)curve->initial_speed << 8)) * dt) / curve->time_to_max;
+        if (v1 > max_speed) {
+            v1 = max_speed;
+        }
+    }
+    if (mousekey_accel) {
+        v0 = v1;
+    }
+    motion->speed = v1;
+
+    // Trapezoid over the frame: (v0 + v1) / 2 counts per second for dt ms
+    uint32_t distance = (v0 + v1) * dt + motion->remainder;
+    motion->remainder = distance % 2000;
+    distance /= 2000;
+
+    // diagonal move [1/sqrt(2)]
+    if (motion->dir[0] && motion->dir[1]) {
+        distance = (distance * 181) >> 8;
+    }
+    return distance;
+}
+
+void mousekey_task(void) {
+    uint32_t move  = mousekey_motion_frame(&mousekey_cursor, &mousekey_curves[mousekey_curve], MOUSEKEY_DELAY);
+    uint32_t wheel = mousekey_motion_frame(&mousekey_wheel, &mousekey_wheel_curve, MOUSEKEY_WHEEL_DELAY);
+    if (move || wheel) {
+        pointer_move_fraction(mousekey_cursor.dir[0] * (int32_t)move, mousekey_cursor.dir[1] * (int32_t)move, mousekey_wheel.dir[0] * (int32_t)wheel, mousekey_wheel.dir[1] * (int32_t)wheel);
+    }
+}
+
+static void mousekey_press(mousekey_motion_t *motion, const mousekey_curve_t *curve, uint8_t axis, int8_t dir) {
+    mousekey_motion_start(motion, curve);
+    motion->dir[axis] = dir;
+}
+
+static void mousekey_release(mousekey_motion_t *motion, uint8_t axis, int8_t dir) {
+    if (motion->dir[axis] == dir) {
+        motion->dir[axis] = 0;
+    }
+}
+
+void mousekey_on(uint8_t code) {
+    const mousekey_curve_t *curve = &mousekey_curves[mousekey_curve];
+    // Keys held so far move up to now
+    mousekey_task();
+    if (code == KC_MS_UP) {
+        mousekey_press(&mousekey_cursor, curve, 1, -1);
+        mouse_report.y = -MOUSEKEY_MOVE_DELTA;
+    } else if (code == KC_MS_DOWN) {
+        mousekey_press(&mousekey_cursor, curve, 1, 1);
+        mouse_report.y = MOUSEKEY_MOVE_DELTA;
+    } else if (code == KC_MS_LEFT) {
+        mousekey_press(&mousekey_cursor, curve, 0, -1);
+        mouse_report.x = -MOUSEKEY_MOVE_DELTA;
+    } else if (code == KC_MS_RIGHT) {
+        mousekey_press(&mousekey_cursor, curve, 0, 1);
+        mouse_report.x = MOUSEKEY_MOVE_DELTA;
+    } else if (code == KC_MS_WH_UP) {
+        mousekey_press(&mousekey_wheel, &mousekey_wheel_curve, 0, 1);
+        mouse_report.v = MOUSEKEY_WHEEL_DELTA;
+    } else if (code == KC_MS_WH_DOWN) {
+        mousekey_press(&mousekey_wheel, &mousekey_wheel_curve, 0, -1);
+        mouse_report.v = -MOUSEKEY_WHEEL_DELTA;
+    } else if (code == KC_MS_WH_LEFT) {
+        mousekey_press(&mousekey_wheel, &mousekey_wheel_curve, 1, -1);
+        mouse_report.h = -MOUSEKEY_WHEEL_DELTA;
+    } else if (code == KC_MS_WH_RIGHT) {
+        mousekey_press(&mousekey_wheel, &mousekey_wheel_curve, 1, 1);
+        mouse_report.h = MOUSEKEY_WHEEL_DELTA;
+    } else if (code == KC_MS_BTN1)
+        mouse_report.buttons |= MOUSE_BTN1;
+    else if (code == KC_MS_BTN2)
+        mouse_report.buttons |= MOUSE_BTN2;
+    else if (code == KC_MS_BTN3)
+        mouse_report.buttons |= MOUSE_BTN3;
+    else if (code == KC_MS_BTN4)
+        mouse_report.buttons |= MOUSE_BTN4;
+    else if (code == KC_MS_BTN5)
+        mouse_report.buttons |= MOUSE_BTN5;
+    else if (code == KC_MS_ACCEL0)
+        mousekey_accel |= (1 << 0);
+    else if (code == KC_MS_ACCEL1)
+        mousekey_accel |= (1 << 1);
+    else if (code == KC_MS_ACCEL2)
+        mousekey_accel |= (1 << 2);
+}
+
+void mousekey_off(uint8_t code) {
+    mousekey_task();
+    if (code == KC_MS_UP)
+        mousekey_release(&mousekey_cursor, 1, -1);
+    else if (code == KC_MS_DOWN)
+        mousekey_release(&mousekey_cursor, 1, 1);
+    else if (code == KC_MS_LEFT)
+        mousekey_release(&mousekey_cursor, 0, -1);
+    else if (code == KC_MS_RIGHT)
+        mousekey_release(&mousekey_cursor, 0, 1);
+    else if (code == KC_MS_WH_UP)
+        mousekey_release(&mousekey_wheel, 0, 1);
+    else if (code == KC_MS_WH_DOWN)
+        mousekey_release(&mousekey_wheel, 0, -1);
+    else if (code == KC_MS_WH_LEFT)
+        mousekey_release(&mousekey_wheel, 1, -1);
+    else if (code == KC_MS_WH_RIGHT)
+        mousekey_release(&mousekey_wheel, 1, 1);
+    else if (code == KC_MS_BTN1)
+        mouse_report.buttons &= ~MOUSE_BTN1;
+    else if (code == KC_MS_BTN2)
+        mouse_report.buttons &= ~MOUSE_BTN2;
+    else if (code == KC_MS_BTN3)
+        mouse_report.buttons &= ~MOUSE_BTN3;
+    else if (code == KC_MS_BTN4)
+        mouse_report.buttons &= ~MOUSE_BTN4;
+    else if (code == KC_MS_BTN5)
+        mouse_report.buttons &= ~MOUSE_BTN5;
+    else if (code == KC_MS_ACCEL0)
+        mousekey_accel &= ~(1 << 0);
+    else if (code == KC_MS_ACCEL1)
+        mousekey_accel &= ~(1 << 1);
+    else if (code == KC_MS_ACCEL2)
+        mousekey_accel &= ~(1 << 2);
+}
+
+#elif !defined(MK_3_SPEED)
 
 static uint16_t last_timer_c = 0;
 static uint16_t last_timer_w = 0;
@@ -264,7 +483,7 @@ void mousekey_off(uint8_t code) {
     if (mouse_report.v == 0 && mouse_report.h == 0) mousekey_wheel_repeat = 0;
 }
 
-#else /* #ifndef MK_3_SPEED */
+#else /* #if defined(MK_KINETIC_SPEED) */
 
 enum { mkspd_unmod, mkspd_0, mkspd_1, mkspd_2, mkspd_COUNT };
 #    ifndef MK_MOMENTARY_ACCEL
@@ -409,18 +628,31 @@ void mousekey_off(uint8_t code) {
 #    endif
 }
 
-#endif /* #ifndef MK_3_SPEED */
+#endif /* #if defined(MK_KINETIC_SPEED) */
 
 void mousekey_send(void) {
     mousekey_debug();
+#ifndef MK_KINETIC_SPEED
     uint16_t time = timer_read();
     if (mouse_report.x || mouse_report.y) last_timer_c = time;
     if (mouse_report.v || mouse_report.h) last_timer_w = time;
-    host_mouse_send(&mouse_report);
+    pointer_update(POINTER_SOURCE_MOUSEKEY, &mouse_report);
+#else
+    pointer_update(POINTER_SOURCE_MOUSEKEY, &mouse_report);
+    // The steps of mousekey_on() are sent once, mousekey_task() does the rest
+    mouse_report.x = 0;
+    mouse_report.y = 0;
+    mouse_report.v = 0;
+    mouse_report.h = 0;
+#endif
 }
 
 void mousekey_clear(void) {
     mouse_report          = (report_mouse_t){};
+#ifdef MK_KINETIC_SPEED
+    mousekey_cursor = (mousekey_motion_t){};
+    mousekey_wheel  = (mousekey_motion_t){};
+#endif
     mousekey_repeat       = 0;
     mousekey_wheel_repeat = 0;
     mousekey_accel        = 0;
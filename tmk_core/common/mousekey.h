@@ -120,6 +120,37 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #endif /* #ifndef MK_3_SPEED */
 
+#ifdef MK_KINETIC_SPEED
+
+#    ifdef MK_3_SPEED
+#        error MK_KINETIC_SPEED cannot be used together with MK_3_SPEED
+#    endif
+
+/* Speeds are in counts per second, times in ms */
+typedef struct {
+    uint16_t initial_speed;  // speed once MOUSEKEY_DELAY is over
+    uint16_t max_speed;      // speed at which acceleration stops
+    uint16_t time_to_max;    // time from initial_speed to max_speed
+} mousekey_curve_t;
+
+/* Cursor curves to choose from with mousekey_set_curve() */
+#    ifndef MOUSEKEY_CURVES
+#        define MOUSEKEY_CURVES \
+            { {50, 1000, 1000}, {25, 500, 1000}, {100, 2000, 750} }
+#    endif
+#    ifndef MOUSEKEY_WHEEL_CURVE
+#        define MOUSEKEY_WHEEL_CURVE \
+            { 2, 80, 4000 }
+#    endif
+/* Longest time integrated in one go, so that a stalled scan does not throw the cursor */
+#    ifndef MOUSEKEY_FRAME_MAX
+#        define MOUSEKEY_FRAME_MAX 64
+#    elif MOUSEKEY_FRAME_MAX > 64
+#        error MOUSEKEY_FRAME_MAX needs to be 64 or less
+#    endif
+
+#endif /* #ifdef MK_KINETIC_SPEED */
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -137,6 +168,13 @@ void mousekey_off(uint8_t code);
 void mousekey_clear(void);
 void mousekey_send(void);
 
+#ifdef MK_KINETIC_SPEED
+void    mousekey_init(void);
+uint8_t mousekey_get_curve(void);
+/* Selects one of MOUSEKEY_CURVES and stores it in EEPROM */
+void mousekey_set_curve(uint8_t curve);
+#endif
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,152 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Pointer pipeline.
+ *
+ * Mouse keys, PS/2 and serial mice and the pointing device hand their reports
+ * to the pipeline instead of sending them. It adds up the motion of every
+ * source and sends it as one report, at most once per POINTER_REPORT_INTERVAL.
+ * Motion is accumulated with 8 fractional bits, so sources can move by less
+ * than a count per scan, and whatever does not fit into one report is sent
+ * with the next one instead of being clipped.
+ *
+ * A button change is never merged with a later one: if a second change comes
+ * in before the first was sent, the first one is sent right away, so that a
+ * quick click is not lost.
+ */
+
+#include "pointer.h"
+#include "host.h"
+#include "timer.h"
+#if defined(PROTOCOL_LUFA) || defined(PROTOCOL_CHIBIOS)
+#    include "usb_descriptor.h"
+#endif
+
+/* Minimum time between two mouse reports, in ms. There is no point in sending
+ * more often than the host polls the endpoint, the USB drivers would only wait
+ * for it to become free. */
+#ifndef POINTER_REPORT_INTERVAL
+#    ifdef USB_POLLING_INTERVAL_MS
+#        define POINTER_REPORT_INTERVAL USB_POLLING_INTERVAL_MS
+#    else
+#        define POINTER_REPORT_INTERVAL 1
+#    endif
+#endif
+
+#define POINTER_FRACTION_ONE ((int32_t)1 << POINTER_FRACTION_BITS)
+
+// Keeps a stuck source from overflowing the accumulators
+#define POINTER_ACCUMULATOR_MAX ((int32_t)INT16_MAX * POINTER_FRACTION_ONE * 4)
+
+enum { AXIS_X, AXIS_Y, AXIS_V, AXIS_H, AXIS_COUNT };
+
+static int32_t        accumulated[AXIS_COUNT];
+static uint8_t        source_buttons[POINTER_SOURCE_COUNT];
+static report_mouse_t last_report;
+static uint16_t       last_time;
+
+static uint8_t pointer_buttons(void) {
+    uint8_t buttons = 0;
+    for (uint8_t i = 0; i < POINTER_SOURCE_COUNT; i++) {
+        buttons |= source_buttons[i];
+    }
+    return buttons;
+}
+
+static void pointer_accumulate(uint8_t axis, int32_t fraction) {
+    int32_t value = accumulated[axis] + fraction;
+    if (value > POINTER_ACCUMULATOR_MAX) {
+        value = POINTER_ACCUMULATOR_MAX;
+    } else if (value < -POINTER_ACCUMULATOR_MAX) {
+        value = -POINTER_ACCUMULATOR_MAX;
+    }
+    accumulated[axis] = value;
+}
+
+/* Takes as many whole counts off an accumulator as fit into a report, rounding
+ * towards zero so that the remainder keeps its sign */
+static int16_t pointer_take(uint8_t axis, int16_t max) {
+    int32_t counts = accumulated[axis] / POINTER_FRACTION_ONE;
+    if (counts > max) {
+        counts = max;
+    } else if (counts < -max) {
+        counts = -max;
+    }
+    accumulated[axis] -= counts * POINTER_FRACTION_ONE;
+    return counts;
+}
+
+static bool pointer_pending(void) {
+    if (pointer_buttons() != last_report.buttons) {
+        return true;
+    }
+    for (uint8_t axis = 0; axis < AXIS_COUNT; axis++) {
+        if (accumulated[axis] >= POINTER_FRACTION_ONE || accumulated[axis] <= -POINTER_FRACTION_ONE) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void pointer_send(void) {
+    report_mouse_t report = {
+        .buttons = pointer_buttons(),
+        .x       = pointer_take(AXIS_X, MOUSE_XY_REPORT_MAX),
+        .y       = pointer_take(AXIS_Y, MOUSE_XY_REPORT_MAX),
+        .v       = pointer_take(AXIS_V, 127),
+        .h       = pointer_take(AXIS_H, 127),
+    };
+    host_mouse_send(&report);
+    last_report = report;
+    last_time   = timer_read();
+}
+
+void pointer_update(pointer_source_t source, const report_mouse_t *report) {
+    if (source >= POINTER_SOURCE_COUNT) {
+        return;
+    }
+
+    if (report->buttons != source_buttons[source] && pointer_buttons() != last_report.buttons) {
+        pointer_send();
+    }
+    source_buttons[source] = report->buttons;
+
+    pointer_accumulate(AXIS_X, (int32_t)report->x * POINTER_FRACTION_ONE);
+    pointer_accumulate(AXIS_Y, (int32_t)report->y * POINTER_FRACTION_ONE);
+    pointer_accumulate(AXIS_V, (int32_t)report->v * POINTER_FRACTION_ONE);
+    pointer_accumulate(AXIS_H, (int32_t)report->h * POINTER_FRACTION_ONE);
+}
+
+void pointer_move_fraction(int32_t x, int32_t y, int32_t v, int32_t h) {
+    pointer_accumulate(AXIS_X, x);
+    pointer_accumulate(AXIS_Y, y);
+    pointer_accumulate(AXIS_V, v);
+    pointer_accumulate(AXIS_H, h);
+}
+
+void pointer_task(void) {
+    if (timer_elapsed(last_time) >= POINTER_REPORT_INTERVAL && pointer_pending()) {
+        pointer_send();
+    }
+}
+
+void pointer_flush(void) {
+    if (pointer_pending()) {
+        pointer_send();
+    }
+}
+
+report_mouse_t pointer_last_report(void) { return last_report; }
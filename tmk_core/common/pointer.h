@@ -0,0 +1,61 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "report.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Motion passed to pointer_move_fraction() is in 1/256 counts */
+#define POINTER_FRACTION_BITS 8
+
+typedef enum {
+    POINTER_SOURCE_MOUSEKEY,
+    POINTER_SOURCE_PS2,
+    POINTER_SOURCE_SERIAL,
+    POINTER_SOURCE_DEVICE,
+    POINTER_SOURCE_USER,
+    POINTER_SOURCE_COUNT,
+} pointer_source_t;
+
+/* Adds the motion and scrolling of report to what is waiting to be sent, and
+ * sets the buttons held on that source. The buttons of all sources are
+ * combined. */
+void pointer_update(pointer_source_t source, const report_mouse_t *report);
+
+/* Adds motion with sub-count precision. Fractions are kept until they add up
+ * to whole counts. */
+void pointer_move_fraction(int32_t x, int32_t y, int32_t v, int32_t h);
+
+/* Sends whatever is waiting, at most once per POINTER_REPORT_INTERVAL. Motion
+ * that does not fit into one report is carried over to the next. Called by
+ * keyboard_task() after all pointer sources have run. */
+void pointer_task(void);
+
+/* Sends whatever is waiting right away */
+void pointer_flush(void);
+
+/* The last report that was sent */
+report_mouse_t pointer_last_report(void);
+
+#ifdef __cplusplus
+}
+#endif
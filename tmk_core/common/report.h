@@ -173,15 +173,24 @@ typedef struct {
     uint16_t usage;
 } __attribute__((packed)) report_extra_t;
 
+/* Define MOUSE_EXTENDED_REPORT for 16-bit X/Y motion */
+#ifdef MOUSE_EXTENDED_REPORT
+typedef int16_t mouse_xy_report_t;
+#    define MOUSE_XY_REPORT_MAX INT16_MAX
+#else
+typedef int8_t mouse_xy_report_t;
+#    define MOUSE_XY_REPORT_MAX 127
+#endif
+
 typedef struct {
 #ifdef MOUSE_SHARED_EP
     uint8_t report_id;
 #endif
-    uint8_t buttons;
-    int8_t  x;
-    int8_t  y;
-    int8_t  v;
-    int8_t  h;
+    uint8_t           buttons;
+    mouse_xy_report_t x;
+    mouse_xy_report_t y;
+    int8_t            v;
+    int8_t            h;
 } __attribute__((packed)) report_mouse_t;
 
 typedef struct {
@@ -0,0 +1,75 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+/* Lock-free single-producer/single-consumer ring buffer.
+ *
+ * SPSC_QUEUE_DECLARE(name, type, size) declares the type name_t and the functions
+ * name_push(), name_pop(), name_peek() and name_empty(). Exactly one context (a
+ * thread or an ISR) may push and exactly one other context may pop; no locking is
+ * needed because the producer only ever writes head and the consumer only ever
+ * writes tail. Indices are single bytes so they are updated atomically on every
+ * supported MCU, which limits size to 255 entries; one slot is always kept free.
+ *
+ * This relies on a compiler barrier only and is intended for single-core MCUs.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define SPSC_QUEUE_BARRIER() __atomic_signal_fence(__ATOMIC_SEQ_CST)
+
+#define SPSC_QUEUE_DECLARE(name, type, size)                                          \
+    _Static_assert((size) > 1 && (size) <= 255, #name " size must be 2..255");        \
+    typedef struct {                                                                  \
+        volatile uint8_t head;                                                        \
+        volatile uint8_t tail;                                                        \
+        type             items[size];                                                 \
+    } name##_t;                                                                       \
+                                                                                      \
+    static inline bool name##_push(name##_t *queue, const type *item) {               \
+        uint8_t head = queue->head;                                                   \
+        uint8_t next = (uint8_t)(head + 1) % (size);                                  \
+        if (next == queue->tail) {                                                    \
+            return false;                                                             \
+        }                                                                             \
+        queue->items[head] = *item;                                                   \
+        SPSC_QUEUE_BARRIER();                                                         \
+        queue->head = next;                                                           \
+        return true;                                                                  \
+    }                                                                                 \
+                                                                                      \
+    static inline bool name##_peek(name##_t *queue, type *item) {                     \
+        uint8_t tail = queue->tail;                                                   \
+        if (tail == queue->head) {                                                    \
+            return false;                                                             \
+        }                                                                             \
+        SPSC_QUEUE_BARRIER();                                                         \
+        *item = queue->items[tail];                                                   \
+        return true;                                                                  \
+    }                                                                                 \
+                                                                                      \
+    static inline bool name##_pop(name##_t *queue, type *item) {                      \
+        if (!name##_peek(queue, item)) {                                              \
+            return false;                                                             \
+        }                                                                             \
+        SPSC_QUEUE_BARRIER();                                                         \
+        queue->tail = (uint8_t)(queue->tail + 1) % (size);                            \
+        return true;                                                                  \
+    }                                                                                 \
+                                                                                      \
+    static inline bool name##_empty(name##_t *queue) { return queue->head == queue->tail; }
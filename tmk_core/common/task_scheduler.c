@@ -0,0 +1,136 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stddef.h>
+#include "task_scheduler.h"
+#include "timer.h"
+#include "print.h"
+#include "debug.h"
+
+static task_t  tasks[TASK_SCHEDULER_MAX_TASKS];
+static uint8_t task_count = 0;
+
+#if TASK_SCHEDULER_STATS_INTERVAL > 0
+static uint16_t stats_timer = 0;
+#endif
+
+/** \brief Register a task to be run from keyboard_task()
+ *
+ * Tasks are kept sorted by priority; tasks of equal priority run in registration order.
+ * Returns false if the task table is full.
+ */
+bool task_scheduler_register(task_func_t func, const char *name, uint16_t period, uint8_t priority, uint16_t budget) {
+    if (task_count >= TASK_SCHEDULER_MAX_TASKS) {
+        dprintf("task_scheduler: no room for %s\n", name);
+        return false;
+    }
+
+    uint8_t index = task_count;
+    while (index > 0 && tasks[index - 1].priority > priority) {
+        tasks[index] = tasks[index - 1];
+        index--;
+    }
+
+    tasks[index] = (task_t){
+        .func     = func,
+        .name     = name,
+        .period   = period,
+        .budget   = budget,
+        .priority = priority,
+        .last_run = timer_read(),
+    };
+    task_count++;
+    return true;
+}
+
+/** \brief Change how often an already registered task runs
+ *
+ * Returns false if the task is not registered.
+ */
+bool task_scheduler_set_period(task_func_t func, uint16_t period) {
+    for (uint8_t i = 0; i < task_count; i++) {
+        if (tasks[i].func == func) {
+            tasks[i].period = period;
+            return true;
+        }
+    }
+    return false;
+}
+
+/** \brief Run every task that is due
+ *
+ * High priority tasks always run. Other tasks are deferred to a later call once
+ * TASK_SCHEDULER_BUDGET ms have been spent in this call, unless they have already
+ * been deferred TASK_SCHEDULER_MAX_DEFERRALS times in a row.
+ */
+void task_scheduler_run(void) {
+    uint16_t loop_start = timer_read();
+
+    for (uint8_t i = 0; i < task_count; i++) {
+        task_t * task = &tasks[i];
+        uint16_t now  = timer_read();
+
+        if (task->period && TIMER_DIFF_16(now, task->last_run) < task->period) {
+            continue;
+        }
+
+        if (task->priority != TASK_PRIORITY_HIGH && TIMER_DIFF_16(now, loop_start) >= TASK_SCHEDULER_BUDGET && task->deferrals < TASK_SCHEDULER_MAX_DEFERRALS) {
+            task->deferrals++;
+            task->stats.deferred++;
+            continue;
+        }
+
+        task->func();
+
+        uint16_t elapsed = timer_elapsed(now);
+        task->last_run   = now;
+        task->deferrals  = 0;
+        task->stats.runs++;
+        task->stats.total_time += elapsed;
+        if (elapsed > task->stats.max_time) {
+            task->stats.max_time = elapsed;
+        }
+        if (task->budget && elapsed > task->budget) {
+            task->stats.overruns++;
+        }
+    }
+
+#if TASK_SCHEDULER_STATS_INTERVAL > 0
+    if (debug_enable && timer_elapsed(stats_timer) > TASK_SCHEDULER_STATS_INTERVAL) {
+        task_scheduler_print_stats();
+        task_scheduler_clear_stats();
+        stats_timer = timer_read();
+    }
+#endif
+}
+
+uint8_t task_scheduler_count(void) { return task_count; }
+
+const task_stats_t *task_scheduler_get_stats(uint8_t index) { return index < task_count ? &tasks[index].stats : NULL; }
+
+void task_scheduler_clear_stats(void) {
+    for (uint8_t i = 0; i < task_count; i++) {
+        tasks[i].stats = (task_stats_t){0};
+    }
+}
+
+/** \brief Dump per-task timing statistics to the console */
+void task_scheduler_print_stats(void) {
+    xprintf("task          prio period  runs  defer  over  max  total\n");
+    for (uint8_t i = 0; i < task_count; i++) {
+        xprintf("%-13s %4u %6u %5u %6u %5u %4u %6lu\n", tasks[i].name, tasks[i].priority, tasks[i].period, tasks[i].stats.runs, tasks[i].stats.deferred, tasks[i].stats.overruns, tasks[i].stats.max_time, tasks[i].stats.total_time);
+    }
+}
@@ -0,0 +1,86 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Maximum number of tasks that can be registered, including the builtin ones */
+#ifndef TASK_SCHEDULER_MAX_TASKS
+#    define TASK_SCHEDULER_MAX_TASKS 16
+#endif
+
+/* Time (ms) each keyboard_task() iteration may spend in deferrable tasks */
+#ifndef TASK_SCHEDULER_BUDGET
+#    define TASK_SCHEDULER_BUDGET 1
+#endif
+
+/* A deferred task runs regardless of the budget after this many consecutive deferrals */
+#ifndef TASK_SCHEDULER_MAX_DEFERRALS
+#    define TASK_SCHEDULER_MAX_DEFERRALS 8
+#endif
+
+/* Interval (ms) at which task statistics are dumped to the console when debug is enabled, 0 disables */
+#ifndef TASK_SCHEDULER_STATS_INTERVAL
+#    define TASK_SCHEDULER_STATS_INTERVAL 0
+#endif
+
+typedef void (*task_func_t)(void);
+
+/* Tasks run in ascending priority order. TASK_PRIORITY_HIGH tasks are never
+ * deferred, everything else is skipped once the loop budget is exhausted. */
+enum task_priority {
+    TASK_PRIORITY_HIGH = 0,
+    TASK_PRIORITY_NORMAL,
+    TASK_PRIORITY_LOW,
+};
+
+typedef struct {
+    uint16_t runs;      // number of times the task was run
+    uint16_t deferred;  // number of times the task was due but skipped for lack of budget
+    uint16_t overruns;  // number of runs that took longer than the task's own budget
+    uint16_t max_time;  // longest single run, in ms
+    uint32_t total_time;
+} task_stats_t;
+
+typedef struct {
+    task_func_t  func;
+    const char * name;
+    uint16_t     period;  // minimum ms between runs, 0 runs every loop
+    uint16_t     budget;  // expected ms per run, exceeding it counts an overrun
+    uint8_t      priority;
+    uint8_t      deferrals;
+    uint16_t     last_run;
+    task_stats_t stats;
+} task_t;
+
+bool task_scheduler_register(task_func_t func, const char *name, uint16_t period, uint8_t priority, uint16_t budget);
+bool task_scheduler_set_period(task_func_t func, uint16_t period);
+void task_scheduler_run(void);
+
+uint8_t             task_scheduler_count(void);
+const task_stats_t *task_scheduler_get_stats(uint8_t index);
+void                task_scheduler_clear_stats(void);
+void                task_scheduler_print_stats(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -5,3 +5,6 @@ void virtser_recv(const uint8_t ch);
 
 /* Call this to send a character over the Virtual Serial Device */
 void virtser_send(const uint8_t byte);
+
+/* Call this to send several bytes at once, as a single USB transfer where possible */
+void virtser_send_buffer(const uint8_t *data, uint8_t length);
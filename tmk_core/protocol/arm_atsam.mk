@@ -5,6 +5,7 @@ SRC += $(ARM_ATSAM_DIR)/clks.c
 SRC += $(ARM_ATSAM_DIR)/d51_util.c
 SRC += $(ARM_ATSAM_DIR)/i2c_master.c
 ifeq ($(RGB_MATRIX_DRIVER),custom)
+  SRC += $(ARM_ATSAM_DIR)/md_rgb_matrix_pattern.c
   SRC += $(ARM_ATSAM_DIR)/md_rgb_matrix_programs.c
   SRC += $(ARM_ATSAM_DIR)/md_rgb_matrix.c
 endif
@@ -27,10 +27,17 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 // From protocol directory
 #include "arm_atsam_protocol.h"
+#ifdef VIRTSER_ENABLE
+#    include "virtser.h"
+#endif
 
 // From keyboard's directory
 #include "config_led.h"
 
+#ifdef MOUSE_EXTENDED_REPORT
+#    error "MOUSE_EXTENDED_REPORT is not supported on arm_atsam, its mouse report descriptor has 8-bit motion"
+#endif
+
 uint8_t g_usb_state = USB_FSMSTATUS_FSMSTATE_OFF_Val;  // Saved USB state from hardware value to detect changes
 
 void    main_subtasks(void);
@@ -140,6 +147,13 @@ void send_consumer(uint16_t data) {
 #endif  // EXTRAKEY_ENABLE
 }
 
+#ifdef VIRTSER_ENABLE
+void virtser_send(const uint8_t byte) { virtser_send_buffer(&byte, 1); }
+
+// Queued in the CDC buffer, which is sent on the next start of frame
+void virtser_send_buffer(const uint8_t *data, uint8_t length) { udi_cdc_write_buf(data, length); }
+#endif  // VIRTSER_ENABLE
+
 void main_subtask_usb_state(void) {
     static uint64_t fsmstate_on_delay = 0;                          // Delay timer to be sure USB is actually operating before bringing up hardware
     uint8_t         fsmstate_now      = USB->DEVICE.FSMSTATUS.reg;  // Current state from hardware register
@@ -217,6 +231,9 @@ void main_subtasks(void) {
 #ifdef RAW_ENABLE
     main_subtask_raw();
 #endif
+#ifdef RGB_MATRIX_ENABLE
+    md_rgb_matrix_send_pending();
+#endif
 }
 
 int main(void) {
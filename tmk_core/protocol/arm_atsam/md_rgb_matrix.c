@@ -19,13 +19,17 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "led.h"
 #include "rgb_matrix.h"
 #include <string.h>
-#include <math.h>
 
 #ifdef USE_MASSDROP_CONFIGURATOR
 __attribute__((weak)) led_instruction_t led_instructions[] = {{.end = 1}};
 static void                             md_rgb_matrix_config_override(int i);
 #endif  // USE_MASSDROP_CONFIGURATOR
 
+// Frame flushed while the I2C queue was busy, sent by md_rgb_matrix_send_pending()
+static RGB     led_pending[ISSI3733_LED_COUNT];
+static uint8_t led_pending_ready;
+static void    md_rgb_matrix_send(const RGB *frame);
+
 void SERCOM1_0_Handler(void) {
     if (SERCOM1->I2CM.INTFLAG.bit.ERROR) {
         SERCOM1->I2CM.INTFLAG.reg = SERCOM_I2CM_INTENCLR_ERROR;
@@ -59,9 +63,9 @@ uint8_t gcr_desired;
 uint8_t gcr_actual;
 uint8_t gcr_actual_last;
 #ifdef USE_MASSDROP_CONFIGURATOR
-uint8_t gcr_breathe;
-float   breathe_mult;
-float   pomod;
+uint8_t  gcr_breathe;
+uint32_t breathe_mult;  // 1/65536
+int32_t  pomod;         // 1/65536 percent
 #endif
 
 #define ACT_GCR_NONE 0
@@ -224,6 +228,10 @@ void init(void) {
     gcr_min_counter = 0;
     v_5v_cat_hit    = 0;
 
+#ifdef USE_MASSDROP_CONFIGURATOR
+    md_pattern_compile();
+#endif
+
     DBGC(DC_LED_MATRIX_INIT_COMPLETE);
 }
 
@@ -238,19 +246,19 @@ void flush(void) {
     }  // Prevent calculations and I2C traffic if LED drivers are not enabled
 #endif
 
-    // Wait for previous transfer to complete
-    while (i2c_led_q_running) {
-    }
-
-    // Copy buffer to live DMA region
-    for (uint8_t i = 0; i < ISSI3733_LED_COUNT; i++) {
-        *led_map[i].rgb.r = led_buffer[i].r;
-        *led_map[i].rgb.g = led_buffer[i].g;
-        *led_map[i].rgb.b = led_buffer[i].b;
+    // Instead of waiting for the previous transfer to complete, keep a copy of
+    // the frame for md_rgb_matrix_send_pending(). It replaces any older frame
+    // still waiting there.
+    if (i2c_led_q_running) {
+        memcpy(led_pending, led_buffer, sizeof(led_pending));
+        led_pending_ready = 1;
+    } else {
+        led_pending_ready = 0;
+        md_rgb_matrix_send(led_buffer);
     }
 
 #ifdef USE_MASSDROP_CONFIGURATOR
-    breathe_mult = 1;
+    breathe_mult = MD_PATTERN_ONE;
 
     if (led_animation_breathing) {
         //+60us 119 LED
@@ -261,21 +269,28 @@ void flush(void) {
         else if (led_animation_breathe_cur <= BREATHE_MIN_STEP)
             breathe_dir = 1;
 
-        // Brightness curve created for 256 steps, 0 - ~98%
-        breathe_mult = 0.000015 * led_animation_breathe_cur * led_animation_breathe_cur;
-        if (breathe_mult > 1)
-            breathe_mult = 1;
-        else if (breathe_mult < 0)
-            breathe_mult = 0;
+        breathe_mult = md_pattern_breathe(led_animation_breathe_cur);
     }
 
     // This should only be performed once per frame
-    pomod = (float)((g_rgb_timer / 10) % (uint32_t)(1000.0f / led_animation_speed)) / 10.0f * led_animation_speed;
-    pomod *= 100.0f;
-    pomod = (uint32_t)pomod % 10000;
-    pomod /= 100.0f;
-
+    pomod = md_pattern_pomod(g_rgb_timer, led_animation_speed);
 #endif  // USE_MASSDROP_CONFIGURATOR
+}
+
+void md_rgb_matrix_send_pending(void) {
+    if (led_pending_ready && !i2c_led_q_running) {
+        led_pending_ready = 0;
+        md_rgb_matrix_send(led_pending);
+    }
+}
+
+static void md_rgb_matrix_send(const RGB *frame) {
+    // Copy frame to live DMA region
+    for (uint8_t i = 0; i < ISSI3733_LED_COUNT; i++) {
+        *led_map[i].rgb.r = frame[i].r;
+        *led_map[i].rgb.g = frame[i].g;
+        *led_map[i].rgb.b = frame[i].b;
+    }
 
     uint8_t drvid;
 
@@ -341,68 +356,10 @@ uint8_t led_enabled               = 1;
 uint8_t led_animation_breathe_cur = BREATHE_MIN_STEP;
 uint8_t breathe_dir               = 1;
 
-static void led_run_pattern(led_setup_t* f, float* ro, float* go, float* bo, float pos) {
-    float po;
-
-    while (f->end != 1) {
-        po = pos;  // Reset po for new frame
-
-        // Add in any moving effects
-        if ((!led_animation_direction && f->ef & EF_SCR_R) || (led_animation_direction && (f->ef & EF_SCR_L))) {
-            po -= pomod;
-
-            if (po > 100)
-                po -= 100;
-            else if (po < 0)
-                po += 100;
-        } else if ((!led_animation_direction && f->ef & EF_SCR_L) || (led_animation_direction && (f->ef & EF_SCR_R))) {
-            po += pomod;
-
-            if (po > 100)
-                po -= 100;
-            else if (po < 0)
-                po += 100;
-        }
-
-        // Check if LED's po is in current frame
-        if (po < f->hs) {
-            f++;
-            continue;
-        }
-        if (po > f->he) {
-            f++;
-            continue;
-        }
-        // note: < 0 or > 100 continue
-
-        // Calculate the po within the start-stop percentage for color blending
-        po = (po - f->hs) / (f->he - f->hs);
-
-        // Add in any color effects
-        if (f->ef & EF_OVER) {
-            *ro = (po * (f->re - f->rs)) + f->rs;  // + 0.5;
-            *go = (po * (f->ge - f->gs)) + f->gs;  // + 0.5;
-            *bo = (po * (f->be - f->bs)) + f->bs;  // + 0.5;
-        } else if (f->ef & EF_SUBTRACT) {
-            *ro -= (po * (f->re - f->rs)) + f->rs;  // + 0.5;
-            *go -= (po * (f->ge - f->gs)) + f->gs;  // + 0.5;
-            *bo -= (po * (f->be - f->bs)) + f->bs;  // + 0.5;
-        } else {
-            *ro += (po * (f->re - f->rs)) + f->rs;  // + 0.5;
-            *go += (po * (f->ge - f->gs)) + f->gs;  // + 0.5;
-            *bo += (po * (f->be - f->bs)) + f->bs;  // + 0.5;
-        }
-
-        f++;
-    }
-}
-
 static void md_rgb_matrix_config_override(int i) {
-    float ro = 0;
-    float go = 0;
-    float bo = 0;
+    int32_t rgb[3] = {0, 0, 0};  // 1/65536
 
-    float po = (led_animation_orientation) ? (float)g_led_config.point[i].y / 64.f * 100 : (float)g_led_config.point[i].x / 224.f * 100;
+    int32_t po = (led_animation_orientation) ? md_pattern_position(g_led_config.point[i].y, 64) : md_pattern_position(g_led_config.point[i].x, 224);
 
     uint8_t highest_active_layer = biton32(layer_state);
 
@@ -431,42 +388,25 @@ static void md_rgb_matrix_config_override(int i) {
             }
 
             if (led_cur_instruction->flags & LED_FLAG_USE_RGB) {
-                ro = led_cur_instruction->r;
-                go = led_cur_instruction->g;
-                bo = led_cur_instruction->b;
+                rgb[0] = led_cur_instruction->r * MD_PATTERN_ONE;
+                rgb[1] = led_cur_instruction->g * MD_PATTERN_ONE;
+                rgb[2] = led_cur_instruction->b * MD_PATTERN_ONE;
             } else if (led_cur_instruction->flags & LED_FLAG_USE_PATTERN) {
-                led_run_pattern(led_setups[led_cur_instruction->pattern_id], &ro, &go, &bo, po);
+                md_pattern_run(md_pattern_get(led_cur_instruction->pattern_id), rgb, po, pomod, led_animation_direction);
             } else if (led_cur_instruction->flags & LED_FLAG_USE_ROTATE_PATTERN) {
-                led_run_pattern(led_setups[led_animation_id], &ro, &go, &bo, po);
+                md_pattern_run(md_pattern_get(led_animation_id), rgb, po, pomod, led_animation_direction);
             }
 
         next_iter:
             led_cur_instruction++;
         }
-
-        if (ro > 255)
-            ro = 255;
-        else if (ro < 0)
-            ro = 0;
-        if (go > 255)
-            go = 255;
-        else if (go < 0)
-            go = 0;
-        if (bo > 255)
-            bo = 255;
-        else if (bo < 0)
-            bo = 0;
-
-        if (led_animation_breathing) {
-            ro *= breathe_mult;
-            go *= breathe_mult;
-            bo *= breathe_mult;
-        }
     }
 
-    led_buffer[i].r = (uint8_t)ro;
-    led_buffer[i].g = (uint8_t)go;
-    led_buffer[i].b = (uint8_t)bo;
+    uint32_t breathe = led_animation_breathing ? breathe_mult : MD_PATTERN_ONE;
+
+    led_buffer[i].r = md_pattern_output(rgb[0], breathe);
+    led_buffer[i].g = md_pattern_output(rgb[1], breathe);
+    led_buffer[i].b = md_pattern_output(rgb[2], breathe);
 }
 
 #endif  // USE_MASSDROP_CONFIGURATOR
@@ -0,0 +1,138 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Fixed point renderer for the Massdrop configurator patterns.
+ *
+ * The bands of led_setups are given in float percent. They are converted
+ * once, at init, to 1/65536 percent along with the color slope of each band,
+ * so that rendering a band for an LED takes one multiply per color instead
+ * of a float division and three float multiplies. Only the per frame values
+ * (scroll offset and breathing) touch float.
+ */
+
+#ifdef USE_MASSDROP_CONFIGURATOR
+
+#    include "md_rgb_matrix_pattern.h"
+
+static md_pattern_segment_t md_pattern_segments[MD_PATTERN_SEGMENT_COUNT];
+static md_pattern_t         md_patterns[MD_PATTERN_COUNT];
+
+static int32_t md_pattern_fixed(float value) { return (int32_t)(value * MD_PATTERN_ONE + (value < 0 ? -0.5f : 0.5f)); }
+
+static void md_pattern_compile_band(const led_setup_t *f, md_pattern_segment_t *segment) {
+    const uint8_t start[3] = {f->rs, f->gs, f->bs};
+    const uint8_t end[3]   = {f->re, f->ge, f->be};
+
+    segment->hs = md_pattern_fixed(f->hs);
+    segment->he = md_pattern_fixed(f->he);
+    segment->ef = f->ef;
+
+    int32_t width = segment->he - segment->hs;
+    for (uint8_t c = 0; c < 3; c++) {
+        segment->start[c] = (int32_t)start[c] * MD_PATTERN_ONE;
+        // (end - start) / width, with width in 1/65536 percent. Bands narrower
+        // than about 1/128 percent do not fit, their slope is clamped.
+        int64_t slope     = width > 0 ? ((int64_t)(end[c] - start[c]) << 32) / width : 0;
+        segment->slope[c] = slope > INT32_MAX ? INT32_MAX : slope < INT32_MIN ? INT32_MIN : (int32_t)slope;
+    }
+}
+
+uint8_t md_pattern_compile_setup(const led_setup_t *setup, md_pattern_segment_t *segments, uint8_t max) {
+    uint8_t count = 0;
+    for (const led_setup_t *f = setup; f->end != 1 && count < max; f++) {
+        md_pattern_compile_band(f, &segments[count++]);
+    }
+    return count;
+}
+
+void md_pattern_compile(void) {
+    uint8_t used = 0;
+    for (uint8_t id = 0; id < MD_PATTERN_COUNT; id++) {
+        md_patterns[id].first = used;
+        md_patterns[id].count = 0;
+        if (id < led_setups_count) {
+            md_patterns[id].count = md_pattern_compile_setup(led_setups[id], &md_pattern_segments[used], MD_PATTERN_SEGMENT_COUNT - used);
+            used += md_patterns[id].count;
+        }
+    }
+}
+
+const md_pattern_t *md_pattern_get(uint8_t id) { return &md_patterns[id < MD_PATTERN_COUNT ? id : 0]; }
+
+void md_pattern_run_segments(const md_pattern_segment_t *f, uint8_t count, int32_t rgb[3], int32_t pos, int32_t pomod, uint8_t direction) {
+    for (; count; count--, f++) {
+        int32_t po = pos;
+
+        // Add in any moving effects
+        if ((!direction && f->ef & EF_SCR_R) || (direction && (f->ef & EF_SCR_L))) {
+            po -= pomod;
+        } else if ((!direction && f->ef & EF_SCR_L) || (direction && (f->ef & EF_SCR_R))) {
+            po += pomod;
+        }
+        if (po != pos) {
+            if (po > MD_PATTERN_PERCENT(100))
+                po -= MD_PATTERN_PERCENT(100);
+            else if (po < 0)
+                po += MD_PATTERN_PERCENT(100);
+        }
+
+        // Check if LED's po is in current frame
+        if (po < f->hs || po > f->he) {
+            continue;
+        }
+
+        int32_t offset = po - f->hs;
+        for (uint8_t c = 0; c < 3; c++) {
+            int32_t value = f->start[c] + (int32_t)(((int64_t)offset * f->slope[c]) >> 16);
+
+            // Add in any color effects
+            if (f->ef & EF_OVER) {
+                rgb[c] = value;
+            } else if (f->ef & EF_SUBTRACT) {
+                rgb[c] -= value;
+            } else {
+                rgb[c] += value;
+            }
+        }
+    }
+}
+
+void md_pattern_run(const md_pattern_t *pattern, int32_t rgb[3], int32_t pos, int32_t pomod, uint8_t direction) { md_pattern_run_segments(&md_pattern_segments[pattern->first], pattern->count, rgb, pos, pomod, direction); }
+
+int32_t md_pattern_position(uint8_t coord, uint8_t range) { return (int32_t)(((int64_t)coord * MD_PATTERN_PERCENT(100)) / range); }
+
+int32_t md_pattern_pomod(uint32_t timer, float speed) {
+    // Same steps as the configurator: a position in 1/100 percent
+    uint32_t hundredths = (uint32_t)((float)((timer / 10) % (uint32_t)(1000.0f / speed)) / 10.0f * speed * 100.0f) % 10000;
+    return (int32_t)(((int64_t)hundredths * MD_PATTERN_ONE) / 100);
+}
+
+uint32_t md_pattern_breathe(uint8_t step) {
+    // Brightness curve created for 256 steps, 0 - ~98%: 0.000015 * step^2
+    uint32_t breathe = ((uint64_t)step * step * 15 * MD_PATTERN_ONE) / 1000000;
+    return breathe > MD_PATTERN_ONE ? MD_PATTERN_ONE : breathe;
+}
+
+uint8_t md_pattern_output(int32_t value, uint32_t breathe) {
+    if (value > 255 * MD_PATTERN_ONE)
+        value = 255 * MD_PATTERN_ONE;
+    else if (value < 0)
+        value = 0;
+
+    return ((int64_t)value * breathe) >> 32;
+}
+
+#endif  // USE_MASSDROP_CONFIGURATOR
@@ -0,0 +1,102 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define EF_NONE 0x00000000      // No effect
+#define EF_OVER 0x00000001      // Overwrite any previous color information with new
+#define EF_SCR_L 0x00000002     // Scroll left
+#define EF_SCR_R 0x00000004     // Scroll right
+#define EF_SUBTRACT 0x00000008  // Subtract color values
+
+typedef struct led_setup_s {
+    float    hs;   // Band begin at percent
+    float    he;   // Band end at percent
+    uint8_t  rs;   // Red start value
+    uint8_t  re;   // Red end value
+    uint8_t  gs;   // Green start value
+    uint8_t  ge;   // Green end value
+    uint8_t  bs;   // Blue start value
+    uint8_t  be;   // Blue end value
+    uint32_t ef;   // Animation and color effects
+    uint8_t  end;  // Set to signal end of the setup
+} led_setup_t;
+
+extern const uint8_t led_setups_count;
+extern void *        led_setups[];
+
+/* Room for the patterns in led_setups and for the bands of all of them
+ * together, md_rgb_matrix_programs.c checks that they fit */
+#ifndef MD_PATTERN_COUNT
+#    define MD_PATTERN_COUNT 32
+#endif
+#ifndef MD_PATTERN_SEGMENT_COUNT
+#    define MD_PATTERN_SEGMENT_COUNT 128
+#endif
+
+/* Positions and colors are kept in 1/65536 */
+#define MD_PATTERN_ONE 65536L
+#define MD_PATTERN_PERCENT(p) ((int32_t)(p)*MD_PATTERN_ONE)
+
+typedef struct {
+    int32_t  hs;        // Band begin, in 1/65536 percent
+    int32_t  he;        // Band end, in 1/65536 percent
+    int32_t  start[3];  // Red, green and blue at hs, in 1/65536
+    int32_t  slope[3];  // Change of red, green and blue per percent, in 1/65536
+    uint32_t ef;        // Animation and color effects
+} md_pattern_segment_t;
+
+typedef struct {
+    uint8_t first;  // First band in the segment pool
+    uint8_t count;  // Number of bands
+} md_pattern_t;
+
+/* Compiles led_setups to fixed point, with the slope of every band worked
+ * out up front */
+void md_pattern_compile(void);
+
+/* Compiled pattern led_setups[id] */
+const md_pattern_t *md_pattern_get(uint8_t id);
+
+/* Fixed point version of compiling and rendering a single led_setup_t array,
+ * for patterns that are not in led_setups */
+uint8_t md_pattern_compile_setup(const led_setup_t *setup, md_pattern_segment_t *segments, uint8_t max);
+void    md_pattern_run_segments(const md_pattern_segment_t *segments, uint8_t count, int32_t rgb[3], int32_t pos, int32_t pomod, uint8_t direction);
+
+/* Adds the bands of pattern covering pos, in 1/65536 percent, to rgb */
+void md_pattern_run(const md_pattern_t *pattern, int32_t rgb[3], int32_t pos, int32_t pomod, uint8_t direction);
+
+/* Position of an LED along the pattern, coord out of range (224 for x, 64 for y) */
+int32_t md_pattern_position(uint8_t coord, uint8_t range);
+
+/* Scroll offset for this frame, in 1/65536 percent */
+int32_t md_pattern_pomod(uint32_t timer, float speed);
+
+/* Breathing brightness at the given step, in 1/65536 */
+uint32_t md_pattern_breathe(uint8_t step);
+
+/* Clamps a color to 0-255 and applies breathing, in 1/65536 */
+uint8_t md_pattern_output(int32_t value, uint32_t breathe);
+
+#ifdef __cplusplus
+}
+#endif
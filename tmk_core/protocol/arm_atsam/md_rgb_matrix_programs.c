@@ -17,7 +17,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #ifdef USE_MASSDROP_CONFIGURATOR
 
-#    include "md_rgb_matrix.h"
+#    include "md_rgb_matrix_pattern.h"
 
 // Teal <-> Salmon
 led_setup_t leds_teal_salmon[] = {
@@ -90,10 +90,16 @@ led_setup_t leds_rainbow_s[] = {
 
 // Add new LED animations here using one from above as example
 // The last entry must be { .end = 1 }
-// Add the new animation name to the list below following its format
+// Add the new animation name to the list below following its format, and to
+// the band count checked below it
 
 void *led_setups[] = {leds_rainbow_s, leds_rainbow_ns, leds_teal_salmon, leds_yellow, leds_red, leds_green, leds_blue, leds_white, leds_white_with_red_stripe, leds_black_with_red_stripe, leds_off};
 
 const uint8_t led_setups_count = sizeof(led_setups) / sizeof(led_setups[0]);
 
+// Every pattern has to fit into the fixed point tables, list new ones here too
+#    define LED_SETUP_BANDS(setup) (sizeof(setup) / sizeof(led_setup_t) - 1)
+_Static_assert(sizeof(led_setups) / sizeof(led_setups[0]) <= MD_PATTERN_COUNT, "led_setups has more patterns than MD_PATTERN_COUNT");
+_Static_assert(LED_SETUP_BANDS(leds_rainbow_s) + LED_SETUP_BANDS(leds_rainbow_ns) + LED_SETUP_BANDS(leds_teal_salmon) + LED_SETUP_BANDS(leds_yellow) + LED_SETUP_BANDS(leds_red) + LED_SETUP_BANDS(leds_green) + LED_SETUP_BANDS(leds_blue) + LED_SETUP_BANDS(leds_white) + LED_SETUP_BANDS(leds_white_with_red_stripe) + LED_SETUP_BANDS(leds_black_with_red_stripe) + LED_SETUP_BANDS(leds_off) <= MD_PATTERN_SEGMENT_COUNT, "led_setups has more bands than MD_PATTERN_SEGMENT_COUNT");
+
 #endif
@@ -0,0 +1,261 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "gtest/gtest.h"
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+
+extern "C" {
+#include "md_rgb_matrix_pattern.h"
+}
+
+/* The float renderer md_rgb_matrix.c used before the fixed point one */
+namespace reference {
+
+void run_pattern(const led_setup_t* f, float* ro, float* go, float* bo, float pos, float pomod, uint8_t direction) {
+    float po;
+
+    while (f->end != 1) {
+        po = pos;
+
+        if ((!direction && f->ef & EF_SCR_R) || (direction && (f->ef & EF_SCR_L))) {
+            po -= pomod;
+
+            if (po > 100)
+                po -= 100;
+            else if (po < 0)
+                po += 100;
+        } else if ((!direction && f->ef & EF_SCR_L) || (direction && (f->ef & EF_SCR_R))) {
+            po += pomod;
+
+            if (po > 100)
+                po -= 100;
+            else if (po < 0)
+                po += 100;
+        }
+
+        if (po < f->hs || po > f->he) {
+            f++;
+            continue;
+        }
+
+        po = (po - f->hs) / (f->he - f->hs);
+
+        if (f->ef & EF_OVER) {
+            *ro = (po * (f->re - f->rs)) + f->rs;
+            *go = (po * (f->ge - f->gs)) + f->gs;
+            *bo = (po * (f->be - f->bs)) + f->bs;
+        } else if (f->ef & EF_SUBTRACT) {
+            *ro -= (po * (f->re - f->rs)) + f->rs;
+            *go -= (po * (f->ge - f->gs)) + f->gs;
+            *bo -= (po * (f->be - f->bs)) + f->bs;
+        } else {
+            *ro += (po * (f->re - f->rs)) + f->rs;
+            *go += (po * (f->ge - f->gs)) + f->gs;
+            *bo += (po * (f->be - f->bs)) + f->bs;
+        }
+
+        f++;
+    }
+}
+
+float pomod(uint32_t timer, float speed) {
+    float pomod = (float)((timer / 10) % (uint32_t)(1000.0f / speed)) / 10.0f * speed;
+    pomod *= 100.0f;
+    pomod = (uint32_t)pomod % 10000;
+    pomod /= 100.0f;
+    return pomod;
+}
+
+float breathe(uint8_t step) {
+    float breathe_mult = 0.000015 * step * step;
+    if (breathe_mult > 1)
+        breathe_mult = 1;
+    else if (breathe_mult < 0)
+        breathe_mult = 0;
+    return breathe_mult;
+}
+
+uint8_t output(float value, bool breathing, float breathe_mult) {
+    if (value > 255)
+        value = 255;
+    else if (value < 0)
+        value = 0;
+    if (breathing) {
+        value *= breathe_mult;
+    }
+    return (uint8_t)value;
+}
+
+}  // namespace reference
+
+class MdRgbMatrixPattern : public ::testing::Test {
+   protected:
+    // Positions this close to a band edge, in percent, may land on either
+    // side depending on the rounding of the float renderer itself
+    static constexpr float EDGE = 0.001f;
+
+    static bool near_edge(const led_setup_t* f, float pos, float pomod) {
+        const float offsets[] = {0, -pomod, pomod};
+        for (; f->end != 1; f++) {
+            for (float offset : offsets) {
+                float po = pos + offset;
+                for (float wrapped : {po, po - 100, po + 100}) {
+                    if (std::fabs(wrapped - f->hs) < EDGE || std::fabs(wrapped - f->he) < EDGE) {
+                        return true;
+                    }
+                }
+            }
+        }
+        return false;
+    }
+
+    struct Result {
+        unsigned positions = 0;
+        unsigned edges     = 0;  // Band edges the renderers put on different sides
+        int      worst     = 0;
+    };
+
+    /* Renders setup for every LED position and frame parameter with both
+     * renderers */
+    static void compare(const led_setup_t* setup, Result& result) {
+        md_pattern_segment_t segments[MD_PATTERN_SEGMENT_COUNT];
+        uint8_t              count = md_pattern_compile_setup(setup, segments, MD_PATTERN_SEGMENT_COUNT);
+
+        const uint32_t timers[]   = {0, 1234, 5000, 9990, 123457};
+        const float    speeds[]   = {4.0f, 1.5f, 0.25f};
+        const int      breathes[] = {-1, 0, 20, 100, 180, 255};
+
+        for (uint32_t timer : timers) {
+            for (float speed : speeds) {
+                float   pomod_float = reference::pomod(timer, speed);
+                int32_t pomod_fixed = md_pattern_pomod(timer, speed);
+
+                for (uint8_t direction = 0; direction < 2; direction++) {
+                    for (uint8_t range : {224, 64}) {
+                        for (unsigned coord = 0; coord <= range; coord++) {
+                            float pos_float = (float)coord / (float)range * 100;
+                            bool  edge      = near_edge(setup, pos_float, pomod_float);
+                            result.positions++;
+
+                            float ro = 0, go = 0, bo = 0;
+                            reference::run_pattern(setup, &ro, &go, &bo, pos_float, pomod_float, direction);
+
+                            int32_t rgb[3] = {0, 0, 0};
+                            md_pattern_run_segments(segments, count, rgb, md_pattern_position(coord, range), pomod_fixed, direction);
+
+                            bool disagree = false;
+                            for (int step : breathes) {
+                                bool     breathing     = step >= 0;
+                                float    breathe_float = breathing ? reference::breathe(step) : 1;
+                                uint32_t breathe_fixed = breathing ? md_pattern_breathe(step) : MD_PATTERN_ONE;
+
+                                const float expected[3] = {ro, go, bo};
+                                for (int c = 0; c < 3; c++) {
+                                    int diff = std::abs((int)md_pattern_output(rgb[c], breathe_fixed) - (int)reference::output(expected[c], breathing, breathe_float));
+                                    if (diff > 1 && edge) {
+                                        disagree = true;
+                                    } else if (diff > result.worst) {
+                                        result.worst = diff;
+                                        EXPECT_LE(diff, 1) << "coord " << coord << "/" << (int)range << " timer " << timer << " speed " << speed << " direction " << (int)direction << " breathe " << step << " color " << c;
+                                    }
+                                }
+                            }
+                            result.edges += disagree;
+                        }
+                    }
+                }
+            }
+        }
+    }
+};
+
+TEST_F(MdRgbMatrixPattern, LedSetupsMatchFloatRenderer) {
+    Result result;
+    for (uint8_t id = 0; id < led_setups_count; id++) {
+        compare((const led_setup_t*)led_setups[id], result);
+    }
+
+    EXPECT_LE(result.worst, 1);
+    EXPECT_LT(result.edges * 100, result.positions) << "more than 1% of the positions disagree on a band edge";
+}
+
+TEST_F(MdRgbMatrixPattern, CustomSetupsMatchFloatRenderer) {
+    const led_setup_t scroll_left[] = {
+        {.hs = 0, .he = 40, .rs = 10, .re = 250, .gs = 0, .ge = 128, .bs = 77, .be = 3, .ef = EF_SCR_L},
+        {.hs = 25.5, .he = 80.25, .rs = 200, .re = 0, .gs = 3, .ge = 251, .bs = 90, .be = 90, .ef = EF_SCR_L},
+        {.end = 1},
+    };
+    const led_setup_t subtract[] = {
+        {.hs = 0, .he = 100, .rs = 180, .re = 180, .gs = 255, .ge = 255, .bs = 60, .be = 60, .ef = EF_NONE},
+        {.hs = 10, .he = 45.5, .rs = 0, .re = 255, .gs = 37, .ge = 0, .bs = 200, .be = 0, .ef = EF_SUBTRACT | EF_SCR_R},
+        {.hs = 60, .he = 72.3, .rs = 255, .re = 1, .gs = 200, .ge = 13, .bs = 0, .be = 255, .ef = EF_OVER | EF_SCR_L},
+        {.end = 1},
+    };
+
+    Result result;
+    compare(scroll_left, result);
+    compare(subtract, result);
+
+    EXPECT_LE(result.worst, 1);
+    EXPECT_LT(result.edges * 100, result.positions) << "more than 1% of the positions disagree on a band edge";
+}
+
+TEST_F(MdRgbMatrixPattern, ScrollOffsetMatchesFloat) {
+    for (float speed : {4.0f, 2.0f, 1.5f, 0.5f, 0.25f}) {
+        for (uint32_t timer = 0; timer < 100000; timer += 37) {
+            EXPECT_NEAR((double)md_pattern_pomod(timer, speed) / MD_PATTERN_ONE, reference::pomod(timer, speed), 0.0001) << "timer " << timer << " speed " << speed;
+        }
+    }
+}
+
+TEST_F(MdRgbMatrixPattern, CompilesAllLedSetups) {
+    md_pattern_compile();
+
+    uint8_t first = 0;
+    for (uint8_t id = 0; id < led_setups_count; id++) {
+        const led_setup_t*  setup   = (const led_setup_t*)led_setups[id];
+        const md_pattern_t* pattern = md_pattern_get(id);
+
+        uint8_t bands = 0;
+        while (setup[bands].end != 1) {
+            bands++;
+        }
+        EXPECT_EQ(pattern->first, first) << "pattern " << (int)id;
+        EXPECT_EQ(pattern->count, bands) << "pattern " << (int)id;
+        first += bands;
+    }
+}
+
+TEST_F(MdRgbMatrixPattern, NarrowBandDoesNotWrap) {
+    // 1/1000 percent wide, a slope of 255 over it does not fit 32 bits
+    const led_setup_t narrow[] = {
+        {.hs = 50, .he = 50.001, .rs = 0, .re = 255, .gs = 255, .ge = 0, .bs = 0, .be = 0, .ef = EF_NONE},
+        {.end = 1},
+    };
+    md_pattern_segment_t segments[1];
+    ASSERT_EQ(md_pattern_compile_setup(narrow, segments, 1), 1);
+    EXPECT_GT(segments[0].slope[0], 0);
+    EXPECT_LT(segments[0].slope[1], 0);
+
+    for (int32_t pos = segments[0].hs; pos <= segments[0].he; pos++) {
+        int32_t rgb[3] = {0, 0, 0};
+        md_pattern_run_segments(segments, 1, rgb, pos, 0, 0);
+        EXPECT_GE(rgb[0], 0) << "pos " << pos;
+        EXPECT_LE(rgb[1], 255 * MD_PATTERN_ONE) << "pos " << pos;
+    }
+}
@@ -0,0 +1 @@
+TEST_LIST += md_rgb_matrix_pattern
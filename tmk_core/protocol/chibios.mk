@@ -18,3 +18,8 @@ OPT_DEFS += -DFIXED_NUM_CONFIGURATIONS=1
 ifeq ($(strip $(MIDI_ENABLE)), yes)
   include $(TMK_PATH)/protocol/midi.mk
 endif
+
+ifeq ($(strip $(EFFECTS_THREAD_ENABLE)), yes)
+  SRC += $(CHIBIOS_DIR)/effects_thread.c
+  OPT_DEFS += -DEFFECTS_THREAD_ENABLE
+endif
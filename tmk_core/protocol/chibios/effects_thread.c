@@ -0,0 +1,220 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Effects worker thread.
+ *
+ * Lighting and display work runs here, on a thread below the main thread's
+ * priority, so it only gets CPU time while the main thread (matrix scan, debounce,
+ * action processing and HID reports) is sleeping. This thread owns the lighting
+ * state. The main thread never waits for it: key events, calls posted with
+ * effects_post() and the rgblight state received by a split slave are handed over
+ * through a lock-free SPSC queue, where the main thread is the only producer and
+ * this thread the only consumer. The other way round, the rgblight state a split
+ * master sends is published here as a snapshot, and USB suspend is picked up from
+ * the driver state rather than from the suspend hooks, which run on the main
+ * thread or in the USB interrupt.
+ */
+
+#include <ch.h>
+#include <hal.h>
+
+#include "effects_thread.h"
+#include "keyboard.h"
+#include "usb_main.h"
+#include "spsc_queue.h"
+#include "debug.h"
+#ifdef RGB_MATRIX_ENABLE
+#    include "rgb_matrix.h"
+#endif
+#ifdef RGBLIGHT_ENABLE
+#    include "rgblight.h"
+#endif
+#if defined(RGBLIGHT_ENABLE) || defined(RGB_MATRIX_ENABLE)
+#    include "quantum_keycodes.h"
+#    include "process_rgb.h"
+#endif
+
+enum effects_message_type {
+    EFFECTS_KEY,
+    EFFECTS_CALL,
+#if defined(RGBLIGHT_ENABLE) && defined(RGBLIGHT_SPLIT)
+    EFFECTS_RGBLIGHT_SYNC,
+#endif
+};
+
+typedef struct {
+    uint8_t type;
+    union {
+        struct {
+            uint16_t   keycode;
+            keyevent_t event;
+        } key;
+        void (*call)(void);
+#if defined(RGBLIGHT_ENABLE) && defined(RGBLIGHT_SPLIT)
+        rgblight_syncinfo_t rgblight_sync;
+#endif
+    };
+} effects_message_t;
+
+SPSC_QUEUE_DECLARE(effects_queue, effects_message_t, EFFECTS_QUEUE_SIZE)
+
+static effects_queue_t effects_queue;
+static uint16_t        dropped = 0;
+
+__attribute__((weak)) void effects_task_user(void) {}
+
+__attribute__((weak)) void effects_task_kb(void) { effects_task_user(); }
+
+static bool effects_push(const effects_message_t *message) {
+    if (!effects_queue_push(&effects_queue, message)) {
+        dropped++;
+        dprintf("effects: queue full, dropped %u\n", dropped);
+        return false;
+    }
+    return true;
+}
+
+bool process_effects_thread(uint16_t keycode, keyrecord_t *record) {
+    effects_message_t message = {.type = EFFECTS_KEY, .key = {.keycode = keycode, .event = record->event}};
+    effects_push(&message);
+
+#if defined(RGBLIGHT_ENABLE) || defined(RGB_MATRIX_ENABLE)
+    // RGB keycodes are handled entirely on the effects thread
+    if (keycode >= RGB_TOG && keycode <= RGB_MODE_RGBTEST) {
+        return false;
+    }
+#endif
+    return true;
+}
+
+bool effects_post(void (*func)(void)) {
+    effects_message_t message = {.type = EFFECTS_CALL, .call = func};
+    return effects_push(&message);
+}
+
+uint16_t effects_thread_dropped(void) { return dropped; }
+
+#if defined(RGBLIGHT_ENABLE) && defined(RGBLIGHT_SPLIT)
+static rgblight_syncinfo_t rgblight_sync;               // Last state published by this thread
+static volatile uint8_t    rgblight_sync_published = 0;  // Written by this thread only
+static volatile uint8_t    rgblight_sync_sent      = 0;  // Written by the main thread only
+static uint8_t             rgblight_sync_reading;
+
+/* Publishes the rgblight state for the split transport whenever it changed.
+ * Change flags the master has not sent yet are carried over, so a change is
+ * never lost to a newer snapshot. */
+static void effects_rgblight_publish(void) {
+    if (!rgblight_get_change_flags()) {
+        return;
+    }
+
+    rgblight_syncinfo_t syncinfo;
+    rgblight_get_syncinfo(&syncinfo);
+    rgblight_clear_change_flags();
+
+    chSysLock();
+    if (rgblight_sync_sent != rgblight_sync_published) {
+        syncinfo.status.change_flags |= rgblight_sync.status.change_flags;
+    }
+    rgblight_sync = syncinfo;
+    rgblight_sync_published++;
+    chSysUnlock();
+}
+
+bool effects_rgblight_get_sync(rgblight_syncinfo_t *syncinfo) {
+    bool pending;
+
+    chSysLock();
+    pending = rgblight_sync_published != rgblight_sync_sent;
+    if (pending) {
+        *syncinfo             = rgblight_sync;
+        rgblight_sync_reading = rgblight_sync_published;
+    }
+    chSysUnlock();
+    return pending;
+}
+
+void effects_rgblight_sync_sent(void) { rgblight_sync_sent = rgblight_sync_reading; }
+
+bool effects_rgblight_update_sync(const rgblight_syncinfo_t *syncinfo) {
+    effects_message_t message = {.type = EFFECTS_RGBLIGHT_SYNC, .rgblight_sync = *syncinfo};
+    return effects_push(&message);
+}
+#endif
+
+static void effects_process_messages(void) {
+    effects_message_t message;
+    while (effects_queue_pop(&effects_queue, &message)) {
+        switch (message.type) {
+            case EFFECTS_KEY: {
+                keyrecord_t record = {.event = message.key.event};
+#ifdef RGB_MATRIX_ENABLE
+                process_rgb_matrix(message.key.keycode, &record);
+#endif
+#if defined(RGBLIGHT_ENABLE) || defined(RGB_MATRIX_ENABLE)
+                process_rgb(message.key.keycode, &record);
+#endif
+                (void)record;
+                break;
+            }
+            case EFFECTS_CALL:
+                message.call();
+                break;
+#if defined(RGBLIGHT_ENABLE) && defined(RGBLIGHT_SPLIT)
+            case EFFECTS_RGBLIGHT_SYNC:
+                rgblight_update_sync(&message.rgblight_sync, false);
+                break;
+#endif
+        }
+    }
+}
+
+/* Follows USB suspend from the driver state, in place of the lighting calls
+ * suspend_power_down() and suspend_wakeup_init() make without this thread */
+static void effects_suspend_task(void) {
+    static bool suspended = false;
+
+    if ((USB_DRIVER.state == USB_SUSPENDED) == suspended) {
+        return;
+    }
+    suspended = !suspended;
+#if defined(RGBLIGHT_SLEEP) && defined(RGBLIGHT_ENABLE)
+    if (suspended) {
+        rgblight_suspend();
+    } else {
+        rgblight_wakeup();
+    }
+#endif
+}
+
+static THD_WORKING_AREA(waEffectsThread, EFFECTS_THREAD_STACK_SIZE);
+static THD_FUNCTION(EffectsThread, arg) {
+    (void)arg;
+    chRegSetThreadName("effects");
+
+    while (true) {
+        effects_suspend_task();
+        effects_process_messages();
+        keyboard_effects_task();
+        effects_task_kb();
+#if defined(RGBLIGHT_ENABLE) && defined(RGBLIGHT_SPLIT)
+        effects_rgblight_publish();
+#endif
+        chThdSleepMilliseconds(EFFECTS_THREAD_INTERVAL);
+    }
+}
+
+void effects_thread_init(void) { chThdCreateStatic(waEffectsThread, sizeof(waEffectsThread), EFFECTS_THREAD_PRIORITY, EffectsThread, NULL); }
@@ -0,0 +1,69 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "action.h"
+#if defined(RGBLIGHT_ENABLE) && defined(RGBLIGHT_SPLIT)
+#    include "rgblight.h"
+#endif
+
+/* Priority of the effects worker, below the main (scan/report) thread */
+#ifndef EFFECTS_THREAD_PRIORITY
+#    define EFFECTS_THREAD_PRIORITY (NORMALPRIO - 1)
+#endif
+
+#ifndef EFFECTS_THREAD_STACK_SIZE
+#    define EFFECTS_THREAD_STACK_SIZE 1024
+#endif
+
+/* Time the worker sleeps between effect frames, in ms */
+#ifndef EFFECTS_THREAD_INTERVAL
+#    define EFFECTS_THREAD_INTERVAL 1
+#endif
+
+/* Number of key events and calls that can be queued for the worker */
+#ifndef EFFECTS_QUEUE_SIZE
+#    define EFFECTS_QUEUE_SIZE 16
+#endif
+
+void effects_thread_init(void);
+
+/* Hands a key event over to the effects thread, returns false if the keycode is consumed by it */
+bool process_effects_thread(uint16_t keycode, keyrecord_t *record);
+
+/* Has the effects thread run func before its next frame, returns false if the queue is full.
+ * Main thread only, this is how main thread code changes lighting state. */
+bool effects_post(void (*func)(void));
+
+/* Number of key events and calls dropped because the worker fell behind */
+uint16_t effects_thread_dropped(void);
+
+#if defined(RGBLIGHT_ENABLE) && defined(RGBLIGHT_SPLIT)
+/* Split master: copies the rgblight state the effects thread last published,
+ * returns false if it has already been sent */
+bool effects_rgblight_get_sync(rgblight_syncinfo_t *syncinfo);
+/* Split master: the state returned by effects_rgblight_get_sync() reached the other half */
+void effects_rgblight_sync_sent(void);
+/* Split slave: applies the state received from the master on the effects thread */
+bool effects_rgblight_update_sync(const rgblight_syncinfo_t *syncinfo);
+#endif
+
+/* Run on the effects thread once per frame */
+void effects_task_kb(void);
+void effects_task_user(void);
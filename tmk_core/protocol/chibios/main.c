@@ -57,6 +57,9 @@
 #ifdef EEPROM_DRIVER
 #    include "eeprom_driver.h"
 #endif
+#ifdef EFFECTS_THREAD_ENABLE
+#    include "effects_thread.h"
+#endif
 #include "suspend.h"
 #include "wait.h"
 
@@ -217,6 +220,10 @@ int main(void) {
     sleep_led_init();
 #endif
 
+#ifdef EFFECTS_THREAD_ENABLE
+    effects_thread_init();
+#endif
+
     print("Keyboard start.\n");
 
     /* Main loop */
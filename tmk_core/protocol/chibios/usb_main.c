@@ -33,11 +33,13 @@
 #include "host.h"
 #include "debug.h"
 #include "suspend.h"
+#include "eeconfig.h"
 #ifdef SLEEP_LED_ENABLE
 #    include "sleep_led.h"
 #    include "led.h"
 #endif
 #include "wait.h"
+#include "timer.h"
 #include "usb_descriptor.h"
 #include "usb_driver.h"
 
@@ -409,6 +411,8 @@ static void usb_event_cb(USBDriver *usbp, usbevent_t event) {
         case USB_EVENT_UNCONFIGURED:
             /* Falls into.*/
         case USB_EVENT_RESET:
+            /* Commit settings before power may go away */
+            eeconfig_request_flush();
             for (int i = 0; i < NUM_USB_DRIVERS; i++) {
                 chSysLockFromISR();
                 /* Disconnection event on suspend.*/
@@ -854,6 +858,88 @@ void send_consumer(uint16_t data) {
 #endif
 }
 
+/* ---------------------------------------------------------
+ *            Console and virtual serial TX buffers
+ * ---------------------------------------------------------
+ */
+
+/* Output is queued byte by byte in a ring and handed to the USB driver in
+ * as few writes as possible from the stream's task, once per main loop
+ * iteration. The driver packs it into endpoint sized packets and its SOF
+ * hook sends incomplete ones, so nothing is held back for long.
+ *
+ * Output comes from more than one thread (main loop, effects thread,
+ * visualizer, ...), so every access holds the buffer's mutex. A blocking
+ * flush keeps holding it, so other writers wait their turn rather than
+ * interleave. */
+#if defined(CONSOLE_ENABLE) || defined(VIRTSER_ENABLE)
+typedef struct {
+    mutex_t        lock;
+    uint8_t *      buffer;
+    uint16_t       size;
+    uint16_t       head;  // oldest byte not yet handed to the driver
+    uint16_t       count;
+    uint16_t       since;  // when the buffer last went from empty to not empty
+    uint8_t        policy;
+    usb_tx_stats_t stats;
+} usb_tx_buffer_t;
+
+/* Writes out as much of the buffer as the driver accepts within timeout, with the lock held */
+static void usb_tx_flush_locked(usb_tx_buffer_t *tx, QMKUSBDriver *driver, sysinterval_t timeout) {
+    while (tx->count) {
+        uint16_t chunk = tx->size - tx->head;
+        if (chunk > tx->count) {
+            chunk = tx->count;
+        }
+        size_t written = chnWriteTimeout(driver, &tx->buffer[tx->head], chunk, timeout);
+        if (written == 0) {
+            return;
+        }
+
+        tx->stats.flushes++;
+        uint16_t latency = timer_elapsed(tx->since);
+        if (latency > tx->stats.max_latency) {
+            tx->stats.max_latency = latency;
+        }
+
+        tx->head = (tx->head + written) % tx->size;
+        tx->count -= written;
+        if (written < chunk) {
+            return;
+        }
+    }
+}
+
+static void usb_tx_flush(usb_tx_buffer_t *tx, QMKUSBDriver *driver, sysinterval_t timeout) {
+    chMtxLock(&tx->lock);
+    usb_tx_flush_locked(tx, driver, timeout);
+    chMtxUnlock(&tx->lock);
+}
+
+static bool usb_tx_push(usb_tx_buffer_t *tx, QMKUSBDriver *driver, const uint8_t *data, uint16_t length) {
+    chMtxLock(&tx->lock);
+    for (uint16_t i = 0; i < length; i++) {
+        if (tx->count == tx->size && tx->policy == USB_TX_BLOCK) {
+            usb_tx_flush_locked(tx, driver, TIME_INFINITE);
+        }
+        if (tx->count == tx->size) {
+            tx->stats.dropped += length - i;
+            chMtxUnlock(&tx->lock);
+            return false;
+        }
+
+        if (tx->count == 0) {
+            tx->since = timer_read();
+        }
+        tx->buffer[(tx->head + tx->count) % tx->size] = data[i];
+        tx->count++;
+        tx->stats.bytes++;
+    }
+    chMtxUnlock(&tx->lock);
+    return true;
+}
+#endif
+
 /* ---------------------------------------------------------
  *                   Console functions
  * ---------------------------------------------------------
@@ -861,11 +947,14 @@ void send_consumer(uint16_t data) {
 
 #ifdef CONSOLE_ENABLE
 
-int8_t sendchar(uint8_t c) {
-    // The previous implmentation had timeouts, but I think it's better to just slow down
-    // and make sure that everything is transferred, rather than dropping stuff
-    return chnWrite(&drivers.console_driver.driver, &c, 1);
-}
+static uint8_t         console_tx_data[CONSOLE_TX_BUFFER_SIZE];
+static usb_tx_buffer_t console_tx = {.lock = _MUTEX_DATA(console_tx.lock), .buffer = console_tx_data, .size = sizeof(console_tx_data), .policy = CONSOLE_TX_OVERFLOW};
+
+int8_t sendchar(uint8_t c) { return usb_tx_push(&console_tx, &drivers.console_driver.driver, &c, 1) ? 1 : 0; }
+
+void console_flush_output(void) { usb_tx_flush(&console_tx, &drivers.console_driver.driver, TIME_INFINITE); }
+
+const usb_tx_stats_t *console_tx_stats(void) { return &console_tx.stats; }
 
 // Just a dummy function for now, this could be exposed as a weak function
 // Or connected to the actual QMK console
@@ -875,6 +964,8 @@ static void console_receive(uint8_t *data, uint8_t length) {
 }
 
 void console_task(void) {
+    usb_tx_flush(&console_tx, &drivers.console_driver.driver, TIME_IMMEDIATE);
+
     uint8_t buffer[CONSOLE_EPSIZE];
     size_t  size = 0;
     do {
@@ -945,13 +1036,22 @@ void midi_ep_task(void) {
 
 #ifdef VIRTSER_ENABLE
 
-void virtser_send(const uint8_t byte) { chnWrite(&drivers.serial_driver.driver, &byte, 1); }
+static uint8_t         virtser_tx_data[VIRTSER_TX_BUFFER_SIZE];
+static usb_tx_buffer_t virtser_tx = {.lock = _MUTEX_DATA(virtser_tx.lock), .buffer = virtser_tx_data, .size = sizeof(virtser_tx_data), .policy = VIRTSER_TX_OVERFLOW};
+
+void virtser_send(const uint8_t byte) { usb_tx_push(&virtser_tx, &drivers.serial_driver.driver, &byte, 1); }
+
+void virtser_send_buffer(const uint8_t *data, uint8_t length) { usb_tx_push(&virtser_tx, &drivers.serial_driver.driver, data, length); }
+
+const usb_tx_stats_t *virtser_tx_stats(void) { return &virtser_tx.stats; }
 
 __attribute__((weak)) void virtser_recv(uint8_t c) {
     // Ignore by default
 }
 
 void virtser_task(void) {
+    usb_tx_flush(&virtser_tx, &drivers.serial_driver.driver, TIME_IMMEDIATE);
+
     uint8_t numBytesReceived = 0;
     uint8_t buffer[16];
     do {
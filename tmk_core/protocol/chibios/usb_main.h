@@ -74,6 +74,36 @@ void mouse_in_cb(USBDriver *usbp, usbep_t ep);
 /* shared IN request callback handler */
 void shared_in_cb(USBDriver *usbp, usbep_t ep);
 
+/* ---------------------------------------
+ * Console and virtual serial TX buffering
+ * ---------------------------------------
+ */
+
+/* What to do with output that does not fit the TX buffer */
+#define USB_TX_DROP 0   // discard it, the writer never waits on the host
+#define USB_TX_BLOCK 1  // wait until the host has read enough of the buffer
+
+#ifndef CONSOLE_TX_BUFFER_SIZE
+#    define CONSOLE_TX_BUFFER_SIZE 256
+#endif
+#ifndef CONSOLE_TX_OVERFLOW
+#    define CONSOLE_TX_OVERFLOW USB_TX_BLOCK
+#endif
+
+#ifndef VIRTSER_TX_BUFFER_SIZE
+#    define VIRTSER_TX_BUFFER_SIZE 64
+#endif
+#ifndef VIRTSER_TX_OVERFLOW
+#    define VIRTSER_TX_OVERFLOW USB_TX_BLOCK
+#endif
+
+typedef struct {
+    uint32_t bytes;        // bytes accepted into the buffer
+    uint16_t dropped;      // bytes lost to a full buffer
+    uint16_t flushes;      // writes handed to the USB driver
+    uint16_t max_latency;  // longest time (ms) output waited in the buffer
+} usb_tx_stats_t;
+
 /* --------------
  * Console header
  * --------------
@@ -87,4 +117,10 @@ int8_t sendchar(uint8_t c);
 /* Flush output (send everything immediately) */
 void console_flush_output(void);
 
+const usb_tx_stats_t *console_tx_stats(void);
+
 #endif /* CONSOLE_ENABLE */
+
+#ifdef VIRTSER_ENABLE
+const usb_tx_stats_t *virtser_tx_stats(void);
+#endif
@@ -71,6 +71,9 @@ extern keymap_config_t keymap_config;
 #    else
 #        include "../serial.h"
 #    endif
+#    ifdef MOUSE_EXTENDED_REPORT
+#        error "MOUSE_EXTENDED_REPORT is not supported with Bluetooth, the modules only take 8-bit motion"
+#    endif
 #endif
 
 #ifdef VIRTSER_ENABLE
@@ -401,6 +404,8 @@ void EVENT_USB_Device_Connect(void) {
  */
 void EVENT_USB_Device_Disconnect(void) {
     print("[D]");
+    /* Commit settings before power goes away */
+    eeconfig_request_flush();
     /* For battery powered device */
     USB_IsInitialized = false;
     /* TODO: This doesn't work. After several plug in/outs can not be enumerated.
@@ -968,7 +973,13 @@ void virtser_task(void) {
  *
  * FIXME: Needs doc
  */
-void virtser_send(const uint8_t byte) {
+void virtser_send(const uint8_t byte) { virtser_send_buffer(&byte, 1); }
+
+/** \brief Virtual Serial Send Buffer
+ *
+ * Writes all bytes to the IN endpoint and flushes once, instead of once per byte.
+ */
+void virtser_send_buffer(const uint8_t *data, uint8_t length) {
     uint8_t timeout = 255;
     uint8_t ep      = Endpoint_GetCurrentEndpoint();
 
@@ -983,7 +994,10 @@ void virtser_send(const uint8_t byte) {
 
         while (timeout-- && !Endpoint_IsReadWriteAllowed()) _delay_us(40);
 
-        Endpoint_Write_8(byte);
+        // Meant for short packets that fit a single bank of CDC_EPSIZE bytes
+        for (uint8_t i = 0; i < length; i++) {
+            Endpoint_Write_8(data[i]);
+        }
         CDC_Device_Flush(&cdc_device);
 
         if (Endpoint_IsINReady()) {
@@ -20,6 +20,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <util/delay.h>
 #include "ps2_mouse.h"
 #include "host.h"
+#include "pointer.h"
 #include "timer.h"
 #include "print.h"
 #include "report.h"
@@ -79,8 +80,8 @@ void ps2_mouse_task(void) {
     rcv = ps2_host_send(PS2_MOUSE_READ_DATA);
     if (rcv == PS2_ACK) {
         mouse_report.buttons = ps2_host_recv_response() | tp_buttons;
-        mouse_report.x       = ps2_host_recv_response() * PS2_MOUSE_X_MULTIPLIER;
-        mouse_report.y       = ps2_host_recv_response() * PS2_MOUSE_Y_MULTIPLIER;
+        mouse_report.x       = ps2_host_recv_response();
+        mouse_report.y       = ps2_host_recv_response();
 #ifdef PS2_MOUSE_ENABLE_SCROLLING
         mouse_report.v = -(ps2_host_recv_response() & PS2_MOUSE_SCROLL_MASK) * PS2_MOUSE_V_MULTIPLIER;
 #endif
@@ -107,7 +108,7 @@ void ps2_mouse_task(void) {
         // Used to debug the bytes sent to the host
         ps2_mouse_print_report(&mouse_report);
 #endif
-        host_mouse_send(&mouse_report);
+        pointer_update(POINTER_SOURCE_PS2, &mouse_report);
     }
 
     ps2_mouse_clear_report(&mouse_report);
@@ -141,16 +142,22 @@ void ps2_mouse_set_sample_rate(ps2_mouse_sample_rate_t sample_rate) { PS2_MOUSE_
 #define Y_IS_NEG (mouse_report->buttons & (1 << PS2_MOUSE_Y_SIGN))
 #define X_IS_OVF (mouse_report->buttons & (1 << PS2_MOUSE_X_OVFLW))
 #define Y_IS_OVF (mouse_report->buttons & (1 << PS2_MOUSE_Y_OVFLW))
-static inline void ps2_mouse_convert_report_to_hid(report_mouse_t *mouse_report) {
+static inline mouse_xy_report_t ps2_mouse_convert_axis(uint8_t value, bool negative, bool overflow, int16_t multiplier) {
     // PS/2 mouse data is '9-bit integer'(-256 to 255) which is comprised of sign-bit and 8-bit value.
     // bit: 8    7 ... 0
     //      sign \8-bit/
     //
-    // Meanwhile USB HID mouse indicates 8bit data(-127 to 127), note that -128 is not used.
-    //
-    // This converts PS/2 data into HID value. Use only -127-127 out of PS/2 9-bit.
-    mouse_report->x = X_IS_NEG ? ((!X_IS_OVF && -127 <= mouse_report->x && mouse_report->x <= -1) ? mouse_report->x : -127) : ((!X_IS_OVF && 0 <= mouse_report->x && mouse_report->x <= 127) ? mouse_report->x : 127);
-    mouse_report->y = Y_IS_NEG ? ((!Y_IS_OVF && -127 <= mouse_report->y && mouse_report->y <= -1) ? mouse_report->y : -127) : ((!Y_IS_OVF && 0 <= mouse_report->y && mouse_report->y <= 127) ? mouse_report->y : 127);
+    // Meanwhile USB HID mouse indicates 8bit data(-127 to 127), or 16bit data with MOUSE_EXTENDED_REPORT.
+    int32_t motion = negative ? (overflow ? -256 : (int16_t)value - 256) : (overflow ? 255 : value);
+
+    motion *= multiplier;
+    return motion > MOUSE_XY_REPORT_MAX ? MOUSE_XY_REPORT_MAX : (motion < -MOUSE_XY_REPORT_MAX ? -MOUSE_XY_REPORT_MAX : motion);
+}
+
+static inline void ps2_mouse_convert_report_to_hid(report_mouse_t *mouse_report) {
+    // The task stores the raw 8-bit values, the sign bits come with the buttons
+    mouse_report->x = ps2_mouse_convert_axis((uint8_t)mouse_report->x, X_IS_NEG, X_IS_OVF, PS2_MOUSE_X_MULTIPLIER);
+    mouse_report->y = ps2_mouse_convert_axis((uint8_t)mouse_report->y, Y_IS_NEG, Y_IS_OVF, PS2_MOUSE_Y_MULTIPLIER);
 
     // remove sign and overflow flags
     mouse_report->buttons &= PS2_MOUSE_BTN_MASK;
@@ -164,8 +171,8 @@ static inline void ps2_mouse_convert_report_to_hid(report_mouse_t *mouse_report)
 #endif
 
 #ifdef PS2_MOUSE_ROTATE
-    int8_t x = mouse_report->x;
-    int8_t y = mouse_report->y;
+    mouse_xy_report_t x = mouse_report->x;
+    mouse_xy_report_t y = mouse_report->y;
 #    if PS2_MOUSE_ROTATE == 90
     mouse_report->x = y;
     mouse_report->y = -x;
@@ -251,7 +258,8 @@ static inline void ps2_mouse_scroll_button_task(report_mouse_t *mouse_report) {
 #if PS2_MOUSE_SCROLL_BTN_SEND
         if (scroll_state == SCROLL_BTN && timer_elapsed(scroll_button_time) < PS2_MOUSE_SCROLL_BTN_SEND) {
             PRESS_SCROLL_BUTTONS;
-            host_mouse_send(mouse_report);
+            pointer_update(POINTER_SOURCE_PS2, mouse_report);
+            pointer_flush();
             _delay_ms(100);
             RELEASE_SCROLL_BUTTONS;
         }
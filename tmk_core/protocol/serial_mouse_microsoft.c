@@ -23,6 +23,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "serial_mouse.h"
 #include "report.h"
 #include "host.h"
+#include "pointer.h"
 #include "timer.h"
 #include "print.h"
 #include "debug.h"
@@ -66,7 +67,7 @@ void serial_mouse_task(void) {
         report.x = report.y = 0;
 
         print_usb_data(&report);
-        host_mouse_send(&report);
+        pointer_update(POINTER_SOURCE_SERIAL, &report);
         return;
     }
 
@@ -85,8 +86,8 @@ void serial_mouse_task(void) {
     if (buffer[0] & (1 << 5)) report.buttons |= MOUSE_BTN1;
     if (buffer[0] & (1 << 4)) report.buttons |= MOUSE_BTN2;
 
-    report.x = (buffer[0] << 6) | buffer[1];
-    report.y = ((buffer[0] << 4) & 0xC0) | buffer[2];
+    report.x = (int8_t)((buffer[0] << 6) | buffer[1]);
+    report.y = (int8_t)(((buffer[0] << 4) & 0xC0) | buffer[2]);
 
     /* USB HID uses values from -127 to 127 only */
     report.x = MAX(report.x, -127);
@@ -103,7 +104,7 @@ void serial_mouse_task(void) {
 #endif
 
     print_usb_data(&report);
-    host_mouse_send(&report);
+    pointer_update(POINTER_SOURCE_SERIAL, &report);
 }
 
 static void print_usb_data(const report_mouse_t *report) {
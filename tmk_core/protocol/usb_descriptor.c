@@ -130,14 +130,22 @@ const USB_Descriptor_HIDReport_Datatype_t PROGMEM SharedReport[] = {
             HID_RI_REPORT_SIZE(8, 0x03),
             HID_RI_INPUT(8, HID_IOF_CONSTANT),
 
-            // X/Y position (2 bytes)
             HID_RI_USAGE_PAGE(8, 0x01),    // Generic Desktop
             HID_RI_USAGE(8, 0x30),         // X
             HID_RI_USAGE(8, 0x31),         // Y
+#    ifdef MOUSE_EXTENDED_REPORT
+            // X/Y position (4 bytes)
+            HID_RI_LOGICAL_MINIMUM(16, -32767),
+            HID_RI_LOGICAL_MAXIMUM(16, 32767),
+            HID_RI_REPORT_COUNT(8, 0x02),
+            HID_RI_REPORT_SIZE(8, 0x10),
+#    else
+            // X/Y position (2 bytes)
             HID_RI_LOGICAL_MINIMUM(8, -127),
             HID_RI_LOGICAL_MAXIMUM(8, 127),
             HID_RI_REPORT_COUNT(8, 0x02),
             HID_RI_REPORT_SIZE(8, 0x08),
+#    endif
             HID_RI_INPUT(8, HID_IOF_DATA | HID_IOF_VARIABLE | HID_IOF_RELATIVE),
 
             // Vertical wheel (1 byte)
@@ -386,10 +394,6 @@ const USB_Descriptor_Device_t PROGMEM DeviceDescriptor = {
 #    define USB_MAX_POWER_CONSUMPTION 500
 #endif
 
-#ifndef USB_POLLING_INTERVAL_MS
-#    define USB_POLLING_INTERVAL_MS 10
-#endif
-
 /*
  * Configuration descriptors
  */
@@ -509,8 +513,14 @@ const USB_Descriptor_Configuration_t PROGMEM ConfigurationDescriptor = {
         .AlternateSetting       = 0x00,
         .TotalEndpoints         = 1,
         .Class                  = HID_CSCP_HIDClass,
+#    ifdef MOUSE_EXTENDED_REPORT
+        // The boot protocol only has 8-bit motion
+        .SubClass               = HID_CSCP_NonBootSubclass,
+        .Protocol               = HID_CSCP_NonBootProtocol,
+#    else
         .SubClass               = HID_CSCP_BootSubclass,
         .Protocol               = HID_CSCP_MouseBootProtocol,
+#    endif
         .InterfaceStrIndex      = NO_DESCRIPTOR
     },
     .Mouse_HID = {
@@ -49,6 +49,11 @@
 #    include <hal.h>
 #endif
 
+/* bInterval of the HID endpoints, also used to pace the mouse reports */
+#ifndef USB_POLLING_INTERVAL_MS
+#    define USB_POLLING_INTERVAL_MS 10
+#endif
+
 /*
  * USB descriptor structure
  */
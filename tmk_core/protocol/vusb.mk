@@ -14,3 +14,8 @@ VPATH += $(TMK_PATH)/$(VUSB_DIR)
 VPATH += $(VUSB_PATH)
 
 OPT_DEFS += -DPROTOCOL_VUSB
+
+# Low-speed devices have no bulk endpoints, so there is no virtual serial port
+ifeq ($(strip $(VIRTSER_ENABLE)), yes)
+    $(error VIRTSER_ENABLE is not supported on V-USB, set VIRTSER_ENABLE = no)
+endif
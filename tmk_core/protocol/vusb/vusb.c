@@ -458,14 +458,22 @@ const PROGMEM uchar shared_hid_report[] = {
     0x75, 0x03,  //     Report Size (3)
     0x81, 0x03,  //     Input (Constant)
 
-    // X/Y position (2 bytes)
     0x05, 0x01,  //     Usage Page (Generic Desktop)
     0x09, 0x30,  //     Usage (X)
     0x09, 0x31,  //     Usage (Y)
+#    ifdef MOUSE_EXTENDED_REPORT
+    // X/Y position (4 bytes)
+    0x16, 0x01, 0x80,  //     Logical Minimum (-32767)
+    0x26, 0xFF, 0x7F,  //     Logical Maximum (32767)
+    0x95, 0x02,        //     Report Count (2)
+    0x75, 0x10,        //     Report Size (16)
+#    else
+    // X/Y position (2 bytes)
     0x15, 0x81,  //     Logical Minimum (-127)
     0x25, 0x7F,  //     Logical Maximum (127)
     0x95, 0x02,  //     Report Count (2)
     0x75, 0x08,  //     Report Size (8)
+#    endif
     0x81, 0x06,  //     Input (Data, Variable, Relative)
 
     // Vertical wheel (1 byte)
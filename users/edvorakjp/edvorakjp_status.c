@@ -18,11 +18,11 @@ static edvorakjp_state_t edvorakjp_state;
  * private methods
  */
 uint8_t eeconfig_read_edvorakjp(void) {
-  return eeprom_read_byte(EECONFIG_EDVORAK);
+  return eeconfig_read_byte(EECONFIG_EDVORAK);
 }
 
 void eeconfig_update_edvorakjp(uint8_t val) {
-  eeprom_update_byte(EECONFIG_EDVORAK, val);
+  eeconfig_update_byte(EECONFIG_EDVORAK, val);
 }
 
 /*